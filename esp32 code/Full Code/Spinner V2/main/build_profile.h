@@ -0,0 +1,62 @@
+// build_profile.h
+// Which modules are compiled in. A module that is off is left out of the registry (modules.h)
+// and its module_*.cpp compiles to nothing, so none of its code, fonts or tags reach the binary.
+//
+// Pick a profile by editing SPINNER_PROFILE below (or -DSPINNER_PROFILE=... from a build
+// system), or override single modules with -DSPINNER_WITH_<NAME>=0/1.
+#pragma once
+
+#define SPINNER_PROFILE_FULL 0    // every module
+#define SPINNER_PROFILE_PEOPLE 1  // friend / family / cousins / afamily wheels
+#define SPINNER_PROFILE_PHOTOS 2  // album + timeline
+
+#ifndef SPINNER_PROFILE
+  #define SPINNER_PROFILE SPINNER_PROFILE_FULL
+#endif
+
+#if SPINNER_PROFILE == SPINNER_PROFILE_FULL
+  #define SPINNER_PROFILE_DEFAULT_PEOPLE 1
+  #define SPINNER_PROFILE_DEFAULT_CALENDAR 1
+  #define SPINNER_PROFILE_DEFAULT_PHOTOS 1
+#elif SPINNER_PROFILE == SPINNER_PROFILE_PEOPLE
+  #define SPINNER_PROFILE_DEFAULT_PEOPLE 1
+  #define SPINNER_PROFILE_DEFAULT_CALENDAR 0
+  #define SPINNER_PROFILE_DEFAULT_PHOTOS 0
+#elif SPINNER_PROFILE == SPINNER_PROFILE_PHOTOS
+  #define SPINNER_PROFILE_DEFAULT_PEOPLE 0
+  #define SPINNER_PROFILE_DEFAULT_CALENDAR 0
+  #define SPINNER_PROFILE_DEFAULT_PHOTOS 1
+#else
+  #error "unknown SPINNER_PROFILE"
+#endif
+
+#ifndef SPINNER_WITH_FRIEND
+  #define SPINNER_WITH_FRIEND SPINNER_PROFILE_DEFAULT_PEOPLE
+#endif
+#ifndef SPINNER_WITH_FAMILY
+  #define SPINNER_WITH_FAMILY SPINNER_PROFILE_DEFAULT_PEOPLE
+#endif
+#ifndef SPINNER_WITH_COUSINS
+  #define SPINNER_WITH_COUSINS SPINNER_PROFILE_DEFAULT_PEOPLE
+#endif
+#ifndef SPINNER_WITH_AFAMILY
+  #define SPINNER_WITH_AFAMILY SPINNER_PROFILE_DEFAULT_PEOPLE
+#endif
+#ifndef SPINNER_WITH_DATE
+  #define SPINNER_WITH_DATE SPINNER_PROFILE_DEFAULT_CALENDAR
+#endif
+#ifndef SPINNER_WITH_DAYS
+  #define SPINNER_WITH_DAYS SPINNER_PROFILE_DEFAULT_CALENDAR
+#endif
+#ifndef SPINNER_WITH_DISTANCE
+  #define SPINNER_WITH_DISTANCE SPINNER_PROFILE_DEFAULT_CALENDAR
+#endif
+#ifndef SPINNER_WITH_THEMES
+  #define SPINNER_WITH_THEMES SPINNER_PROFILE_DEFAULT_CALENDAR
+#endif
+#ifndef SPINNER_WITH_TIMELINE
+  #define SPINNER_WITH_TIMELINE SPINNER_PROFILE_DEFAULT_PHOTOS
+#endif
+#ifndef SPINNER_WITH_ALBUM
+  #define SPINNER_WITH_ALBUM SPINNER_PROFILE_DEFAULT_PHOTOS
+#endif
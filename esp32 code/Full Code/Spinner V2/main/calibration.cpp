@@ -0,0 +1,141 @@
+// calibration.cpp
+// NVS-backed module calibration and its MQTT command (see calibration.h).
+#include "calibration.h"
+#include "shared.h"
+#include "tasks.h"
+#include "net.h"
+#include "mqtt_router.h"
+
+#define LOGGER_TAG "calib"
+#define LOGGER_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <ArduinoJson.h>
+
+namespace {
+
+// ===== CONFIG =====
+const char* NVS_NAMESPACE = "calib";
+const char* NVS_KEY = "table";
+const uint8_t TABLE_VERSION = 1;  // bump when ModuleCalibration changes layout
+
+// Subscription owner for the command topic. Owner bits above the ModuleIds are never
+// released by module switches.
+const uint8_t CALIB_OWNER = MOD_COUNT;
+
+const UBaseType_t COMMAND_QUEUE_LEN = 4;
+
+struct __attribute__((packed)) CalibTable {
+  uint8_t version;
+  uint32_t stored;  // bit per ModuleId: record was set at runtime and is persisted
+  ModuleCalibration modules[MOD_COUNT];
+};
+
+// ===== STATE =====
+CalibTable table = {};
+uint32_t known = 0;  // bit per ModuleId: calib_load() was called
+bool dirty = false;
+unsigned long changedMs = 0;
+char topic[TASK_TOPIC_MAX];
+QueueHandle_t commands = nullptr;
+
+static int16_t intField(JsonVariantConst v) {
+  return v.is<int>() ? int16_t(v.as<int>()) : int16_t(-1);
+}
+
+// spinner/<device>/calib. Runs on the net task: parse and hand over to the render task.
+static void onCommand(const MqttMessage& msg, void*) {
+  StaticJsonDocument<192> doc;
+  DeserializationError err = deserializeJson(doc, (const char*)msg.payload, msg.length);
+  if (err) {
+    LOGW("JSON error: %s", err.c_str());
+    return;
+  }
+  CalibCommand cmd = {};
+  const char* module = doc["module"] | "";
+  strncpy(cmd.module, module, sizeof(cmd.module) - 1);
+  cmd.here = doc["here"] | false;
+  JsonVariantConst offset = doc["offset"];
+  cmd.offset = offset.is<int>() ? offset.as<int>() : -1;
+  cmd.home = intField(doc["home"]);
+  cmd.extra = intField(doc["extra"]);
+  if (xQueueSend(commands, &cmd, 0) != pdTRUE) LOGW("command dropped (queue full)");
+}
+
+} // namespace
+
+void calib_begin(bool subscribe) {
+  Preferences prefs;
+  if (prefs.begin(NVS_NAMESPACE, true)) {
+    CalibTable stored;
+    size_t n = prefs.getBytes(NVS_KEY, &stored, sizeof(stored));
+    if (n == sizeof(stored) && stored.version == TABLE_VERSION) {
+      table = stored;
+    } else if (n) {
+      LOGW("stored table ignored (size %u, version %u)", unsigned(n), unsigned(stored.version));
+    }
+    prefs.end();
+  }
+  table.version = TABLE_VERSION;
+  table.stored &= (1UL << MOD_COUNT) - 1;
+
+  if (!commands) commands = xQueueCreate(COMMAND_QUEUE_LEN, sizeof(CalibCommand));
+  if (subscribe) {
+    mqtt_route("spinner/+/calib", onCommand);
+    snprintf(topic, sizeof(topic), "spinner/%s/calib", net_deviceId());
+    mqttSubscribe(CALIB_OWNER, topic);
+  }
+}
+
+ModuleCalibration calib_load(ModuleId id, const ModuleCalibration& defaults) {
+  known |= 1UL << id;
+  if (!(table.stored & (1UL << id))) table.modules[id] = defaults;
+  return table.modules[id];
+}
+
+bool calib_get(ModuleId id, ModuleCalibration& out) {
+  if (id >= MOD_COUNT || !(known & (1UL << id))) return false;
+  out = table.modules[id];
+  return true;
+}
+
+void calib_set(ModuleId id, const ModuleCalibration& c) {
+  if (id >= MOD_COUNT) return;
+  ModuleCalibration& cur = table.modules[id];
+  if ((table.stored & (1UL << id)) && memcmp(&cur, &c, sizeof(c)) == 0) return;
+  cur = c;
+  table.stored |= 1UL << id;
+  dirty = true;
+  changedMs = millis();
+  LOGI("module %u: offset=%u home=%u extra=%u (saving)", unsigned(id), unsigned(c.rawOffset),
+       unsigned(c.homeSlice), unsigned(c.extra));
+}
+
+void calib_flush(unsigned long nowMs) {
+  if (!dirty || nowMs - changedMs < CALIB_WRITE_DELAY_MS) return;
+  dirty = false;
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false) || prefs.putBytes(NVS_KEY, &table, sizeof(table)) != sizeof(table)) {
+    LOGE("NVS write failed");
+  } else {
+    LOGI("saved");
+  }
+  prefs.end();
+}
+
+bool calib_nextCommand(CalibCommand& out) {
+  return commands && xQueueReceive(commands, &out, 0) == pdTRUE;
+}
+
+bool calib_apply(ModuleId id, const CalibCommand& cmd, uint16_t raw) {
+  ModuleCalibration c;
+  if (!calib_get(id, c)) return false;
+  if (cmd.here) c.rawOffset = raw;
+  else if (cmd.offset >= 0) c.rawOffset = uint16_t(cmd.offset & 0x0FFF);
+  if (cmd.home >= 0) c.homeSlice = uint8_t(cmd.home);
+  if (cmd.extra >= 0) c.extra = uint8_t(cmd.extra);
+  calib_set(id, c);
+  return true;
+}
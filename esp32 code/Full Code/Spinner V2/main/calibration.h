@@ -0,0 +1,55 @@
+// calibration.h
+// Per-module wheel calibration kept in NVS, so a wheel can be recalibrated without a reflash.
+//
+// Every record lives in one packed blob that calib_begin() loads once at boot. Modules seed
+// their compiled-in defaults with calib_load() in setup() and read the record again in
+// activate(). A change (serial 'c', the calibration tag, an MQTT command) takes effect at once
+// in RAM; calib_flush() writes the blob only after CALIB_WRITE_DELAY_MS without further
+// changes, so several tries in a row cost one flash write.
+//
+// MQTT, on spinner/<device>/calib:
+//   {"module":"date","offset":2071,"home":0,"extra":6}  set fields (any subset)
+//   {"module":"date","here":true}                       offset = current wheel angle
+// Without "module" the command applies to the active module.
+//
+// Everything except the MQTT handler runs on the render task.
+#pragma once
+
+#include <Arduino.h>
+#include "tags.h"
+
+struct __attribute__((packed)) ModuleCalibration {
+  uint16_t rawOffset;  // raw angle where slice 0 starts
+  uint8_t homeSlice;   // slice that shows item 0
+  uint8_t extra;       // module specific (days: slice index for Monday)
+};
+
+const unsigned long CALIB_WRITE_DELAY_MS = 5000;
+const uint8_t CALIB_SUBSCRIPTIONS = 1;  // spinner/<device>/calib
+const uint8_t CALIB_ROUTES = 1;
+
+// setup(), after tasks_init() and before the modules' setup(). `subscribe` = listen for MQTT
+// commands (builds with networking).
+void calib_begin(bool subscribe);
+
+// Module setup(): the stored record, or `defaults` when none was saved yet.
+ModuleCalibration calib_load(ModuleId id, const ModuleCalibration& defaults);
+// False for modules that never called calib_load() (nothing to calibrate).
+bool calib_get(ModuleId id, ModuleCalibration& out);
+void calib_set(ModuleId id, const ModuleCalibration& c);
+
+// Render task, every frame: writes pending changes once they have settled.
+void calib_flush(unsigned long nowMs);
+
+// An MQTT command, queued for the render task to resolve and apply.
+struct CalibCommand {
+  char module[12];  // "" = the active module
+  bool here;        // offset = current wheel angle
+  int32_t offset;   // -1 = keep
+  int16_t home;
+  int16_t extra;
+};
+bool calib_nextCommand(CalibCommand& out);
+// Apply `cmd` to the record of `id`; `raw` is the current angle (for "here"). False when the
+// module has no calibration.
+bool calib_apply(ModuleId id, const CalibCommand& cmd, uint16_t raw);
@@ -0,0 +1,155 @@
+// encoder.cpp
+// Unwrapping, the motion estimator and the snapshot handoff for the encoder service (see
+// encoder.h).
+//
+// The estimator is an alpha-beta filter in integer math (positions in counts * 256, velocity in
+// counts/s * 256, per-sample dt in microseconds, gains in Q16):
+//   predict  x' = x + v * dt
+//   correct  r = z - x';  x = x' + alpha * r;  v = v + beta * r / dt
+// with beta = alpha^2 / (2 - alpha) (critically damped). Confidence comes from a running mean of
+// |r|: residuals stay under a count while the wheel moves as predicted and grow on a jerk.
+//
+// One writer (the sense task) publishes through a sequence lock: the sequence is odd while the
+// state is being updated, and readers retry until they copy it between two equal even values.
+// The history ring is filled slot by slot and published by advancing `head`; readers validate
+// what they copied against `head` afterwards, since the writer never waits for them.
+#include "encoder.h"
+
+#include <atomic>
+
+namespace {
+
+// ===== CONFIG =====
+const int64_t ALPHA_Q16 = 13107;   // 0.2
+const int64_t BETA_Q16 = 1456;     // 0.2^2 / 1.8
+const int64_t ACCEL_TAU_US = 50000;
+const uint64_t MAX_DT_US = 100000;  // a longer gap (stalled task) restarts the estimator
+
+// mean |residual| (counts * 256) for full / zero confidence
+const int64_t CONF_FULL_RES = 1 * ENCODER_POS_ONE;
+const int64_t CONF_ZERO_RES = 16 * ENCODER_POS_ONE;
+const int RES_MEAN_SHIFT = 4;  // running mean over ~16 samples
+
+// ===== STATE =====
+EncoderState state = {};
+std::atomic<uint32_t> seq{0};
+uint64_t lastUs = 0;
+int64_t velQ8 = 0;      // counts/s * 256; state.velocity is this rounded
+int64_t resMean = 0;    // counts * 256
+
+EncoderSample ring[ENCODER_RING];
+std::atomic<uint32_t> head{0};  // samples ever pushed; the next one goes to head % ENCODER_RING
+
+static void restart(EncoderState& s) {
+  s.position = s.count * ENCODER_POS_ONE;
+  s.velocity = 0;
+  s.accel = 0;
+  velQ8 = 0;
+  resMean = CONF_ZERO_RES;  // confidence builds back up over the next samples
+}
+
+static uint8_t confidenceFor(int64_t res, uint8_t status) {
+  if (!(status & ENCODER_MAGNET_DETECTED)) return 0;
+  if (res <= CONF_FULL_RES) return 255;
+  if (res >= CONF_ZERO_RES) return 0;
+  return uint8_t((CONF_ZERO_RES - res) * 255 / (CONF_ZERO_RES - CONF_FULL_RES));
+}
+
+static void estimate(EncoderState& s, int64_t dtUs) {
+  int64_t predicted = s.position + velQ8 * dtUs / 1000000;
+  int64_t r = s.count * ENCODER_POS_ONE - predicted;
+  s.position = predicted + r * ALPHA_Q16 / 65536;
+  int64_t dv = r * BETA_Q16 * 1000000 / (dtUs * 65536);
+  velQ8 += dv;
+  s.velocity = int32_t(velQ8 / ENCODER_POS_ONE);
+
+  int64_t accelNow = dv * 1000000 / (dtUs * ENCODER_POS_ONE);
+  s.accel += int32_t((accelNow - s.accel) * dtUs / (ACCEL_TAU_US + dtUs));
+
+  int64_t absR = r < 0 ? -r : r;
+  resMean += (absR - resMean) / (1 << RES_MEAN_SHIFT);
+}
+
+static void publish(const EncoderState& next) {
+  seq.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  state = next;
+  seq.fetch_add(1, std::memory_order_release);
+
+  uint32_t h = head.load(std::memory_order_relaxed);
+  ring[h % ENCODER_RING] = EncoderSample{ next.count, next.sampleUs, next.raw, next.status };
+  head.store(h + 1, std::memory_order_release);
+}
+
+} // namespace
+
+void encoder_begin(uint16_t raw, uint8_t status, uint64_t nowUs) {
+  lastUs = nowUs;
+  EncoderState first = {};
+  first.raw = raw;
+  first.sampleUs = uint32_t(nowUs);
+  first.samples = 1;
+  first.status = status;
+  restart(first);
+  first.confidence = confidenceFor(resMean, status);
+  publish(first);
+}
+
+void encoder_sample(uint16_t raw, uint8_t status, uint64_t nowUs) {
+  EncoderState next = state;  // single writer: reading our own copy needs no lock
+  int32_t delta = encoderDelta(next.raw, raw);
+  uint64_t dtUs = nowUs - lastUs;
+  lastUs = nowUs;
+
+  next.raw = raw;
+  next.count += delta;
+  next.sampleUs = uint32_t(nowUs);
+  next.status = status;
+  ++next.samples;
+  if (dtUs == 0 || dtUs > MAX_DT_US) restart(next);
+  else estimate(next, int64_t(dtUs));
+  next.confidence = confidenceFor(resMean, status);
+
+  publish(next);
+}
+
+EncoderState encoder_read() {
+  EncoderState out;
+  uint32_t before, after;
+  do {
+    before = seq.load(std::memory_order_acquire);
+    out = state;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = seq.load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+  return out;
+}
+
+uint32_t encoder_cursor() {
+  return head.load(std::memory_order_acquire);
+}
+
+size_t encoder_samples(uint32_t& cursor, EncoderSample* out, size_t max) {
+  uint32_t h = head.load(std::memory_order_acquire);
+  if (h - cursor > ENCODER_RING) cursor = h - ENCODER_RING;
+  size_t n = h - cursor;
+  if (n > max) n = max;
+  for (size_t i = 0; i < n; ++i) out[i] = ring[(cursor + i) % ENCODER_RING];
+
+  // Slots the writer reached while we copied (including the one it may be writing now) are
+  // torn; drop them from the front.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  uint32_t oldestIntact = head.load(std::memory_order_relaxed) + 1 - ENCODER_RING;
+  int32_t torn = int32_t(oldestIntact - cursor);
+  if (torn >= int32_t(n)) {
+    cursor = oldestIntact;
+    return 0;
+  }
+  if (torn > 0) {
+    memmove(out, out + torn, (n - torn) * sizeof(EncoderSample));
+    cursor += n;
+    return n - torn;
+  }
+  cursor += n;
+  return n;
+}
@@ -0,0 +1,80 @@
+// encoder.h
+// Shared AS5600 encoder service. The sense task feeds one sample per tick (encoder_sample());
+// modules read a consistent snapshot with encoder_read() instead of talking to the sensor.
+//
+// Besides the raw angle the snapshot carries a 64-bit unwrapped multi-turn count (4096 counts
+// per turn, in the sensor's direction). Unwrapping assumes less than half a turn between
+// samples: ~500 rev/s at the 1 kHz sense rate.
+//
+// A fixed-point alpha-beta estimator runs on the timestamped samples and provides smoothed
+// position and velocity, plus a confidence value: how well recent samples fit the estimate.
+// It drops on sudden changes of speed, after a sampling gap, and to 0 without a magnet.
+// Gesture thresholds should check velocity *and* confidence rather than raw deltas.
+//
+// The last ENCODER_RING samples are also kept in order, for readers that must not miss a step
+// between two frames (encoder_samples()).
+#pragma once
+
+#include <Arduino.h>
+
+const uint16_t ENCODER_COUNTS = 4096;  // per revolution
+const uint16_t ENCODER_HALF = ENCODER_COUNTS / 2;
+
+// AS5600 STATUS register bits
+const uint8_t ENCODER_MAGNET_HIGH = 0x08;      // MH: magnet too strong
+const uint8_t ENCODER_MAGNET_LOW = 0x10;       // ML: magnet too weak
+const uint8_t ENCODER_MAGNET_DETECTED = 0x20;  // MD
+
+const int32_t ENCODER_POS_ONE = 256;  // fixed-point scale of EncoderState::position
+
+struct EncoderState {
+  uint16_t raw;        // latest angle, 0..4095
+  int64_t count;       // unwrapped position since boot (measured)
+  int64_t position;    // estimated position, counts * ENCODER_POS_ONE
+  int32_t velocity;    // estimated counts/s
+  int32_t accel;       // counts/s^2, low-passed derivative of `velocity`
+  uint8_t confidence;  // 0..255
+  uint32_t sampleUs;   // when `raw` was read (micros)
+  uint32_t samples;    // samples taken so far
+  uint8_t status;      // AS5600 STATUS of the latest sample
+};
+
+struct EncoderSample {
+  int64_t count;
+  uint32_t us;
+  uint16_t raw;
+  uint8_t status;
+};
+
+const uint32_t ENCODER_RING = 128;  // ~128 ms of history at 1 kHz
+
+// Prime the service with a first reading (tasks_init(), before anything reads it).
+void encoder_begin(uint16_t raw, uint8_t status, uint64_t nowUs);
+// Sense task only: fold in one reading.
+void encoder_sample(uint16_t raw, uint8_t status, uint64_t nowUs);
+// Any task: snapshot of the latest sample (never torn).
+EncoderState encoder_read();
+
+// Sample history. Start a reader with `cursor = encoder_cursor()`; each encoder_samples() call
+// copies up to `max` samples taken since then, oldest first, and advances the cursor. A reader
+// more than ENCODER_RING samples behind loses the oldest ones (its cursor skips ahead).
+uint32_t encoder_cursor();
+size_t encoder_samples(uint32_t& cursor, EncoderSample* out, size_t max);
+
+// shortest signed distance from `prev` to `now` (-2048..+2048)
+inline int32_t encoderDelta(uint16_t prev, uint16_t now) {
+  int32_t d = int32_t(now) - int32_t(prev);
+  if (d > ENCODER_HALF) d -= ENCODER_COUNTS;
+  else if (d < -int32_t(ENCODER_HALF)) d += ENCODER_COUNTS;
+  return d;
+}
+
+// angle relative to a calibrated home position (0..4095)
+inline uint16_t encoderPhase(uint16_t raw, uint16_t offset) {
+  return uint16_t((int32_t(raw) - int32_t(offset)) & (ENCODER_COUNTS - 1));
+}
+
+// which of `slices` equal sectors the wheel points at, counted from `offset`
+inline uint8_t encoderSlice(uint16_t raw, uint16_t offset, uint8_t slices) {
+  return uint8_t(uint32_t(encoderPhase(raw, offset)) * slices / ENCODER_COUNTS);
+}
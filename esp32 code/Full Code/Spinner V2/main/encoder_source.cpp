@@ -0,0 +1,195 @@
+// encoder_source.cpp
+// I2C burst and PWM-capture AS5600 sources (see encoder_source.h).
+#include "encoder_source.h"
+#include "encoder.h"
+
+#define LOGGER_TAG "enc"
+#define LOGGER_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+#include <Arduino.h>
+#include <Wire.h>
+#if SPINNER_ENCODER_SOURCE == ENCODER_SOURCE_PWM
+  #include <driver/mcpwm_cap.h>
+#endif
+
+namespace {
+
+// ===== CONFIG =====
+// AS5600 register map: STATUS (0x0B) is followed by RAW ANGLE hi/lo (0x0C/0x0D)
+const uint8_t AS5600_ADDR = 0x36;
+const uint8_t AS5600_REG_CONF_HI = 0x07;
+const uint8_t AS5600_REG_CONF_LO = 0x08;
+const uint8_t AS5600_REG_STATUS = 0x0B;
+
+// CONF low byte: OUTS (bits 5:4) = 10 -> PWM, PWMF (bits 7:6) = 11 -> 920 Hz
+const uint8_t CONF_OUTS_MASK = 0x30;
+const uint8_t CONF_OUTS_PWM = 0x20;
+const uint8_t CONF_PWMF_MASK = 0xC0;
+const uint8_t CONF_PWMF_920HZ = 0xC0;
+
+// CONF high byte: WD (bit 5), FTH fast filter threshold (bits 4:2), SF slow filter (bits 1:0).
+// The profiles own all three, WD included: with WD set the chip drops itself into LPM3 after a
+// minute within 4 LSB, so only IDLE sets it. Bits 7:6 are reserved and kept.
+const uint8_t CONF_HI_MASK = 0x3F;
+const uint8_t CONF_WD_ON = 0x01 << 5;
+const uint8_t CONF_SF_16X = 0x00;
+const uint8_t CONF_SF_2X = 0x03;
+const uint8_t CONF_FTH_6LSB = 0x01 << 2;
+// CONF low byte, besides OUTS/PWMF: HYST (bits 3:2), PM power mode (bits 1:0)
+const uint8_t CONF_LO_PROFILE_MASK = 0x0F;
+const uint8_t CONF_HYST_2LSB = 0x02 << 2;
+const uint8_t CONF_PM_LPM3 = 0x03;
+
+struct ProfileConf {
+  uint8_t hi;  // WD | FTH | SF
+  uint8_t lo;  // HYST | PM; OUTS/PWMF are left as they are
+};
+const ProfileConf PROFILES[] = {
+  { CONF_SF_16X | CONF_FTH_6LSB, CONF_HYST_2LSB },  // ENCODER_PROFILE_LOW_NOISE
+  { CONF_SF_2X | CONF_FTH_6LSB, 0 },                // ENCODER_PROFILE_FAST
+  { CONF_WD_ON | CONF_SF_16X, CONF_PM_LPM3 },       // ENCODER_PROFILE_IDLE
+};
+
+const uint32_t PWM_FIRST_FRAME_MS = 10;  // begin() waits this long for the first frame
+
+// ===== STATE =====
+int profileSet = -1;  // EncoderProfile last programmed, -1 = chip defaults
+
+static bool readRegs(uint8_t reg, uint8_t* out, uint8_t n) {
+  Wire.beginTransmission(AS5600_ADDR);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0) return false;
+  if (Wire.requestFrom(AS5600_ADDR, n) != n) return false;
+  for (uint8_t i = 0; i < n; ++i) out[i] = Wire.read();
+  return true;
+}
+
+#if SPINNER_ENCODER_SOURCE == ENCODER_SOURCE_PWM
+
+portMUX_TYPE capMux = portMUX_INITIALIZER_UNLOCKED;
+uint32_t riseTick = 0;     // ISR only
+uint32_t pendingHigh = 0;  // ISR only: high time of the frame in progress
+uint32_t frameHigh = 0;    // last complete frame, under capMux
+uint32_t framePeriod = 0;
+volatile uint32_t frames = 0;
+uint32_t framesSeen = 0;   // sense task only
+
+// Both edges are latched by the capture timer, so ISR latency doesn't affect the lengths.
+static bool IRAM_ATTR onEdge(mcpwm_cap_channel_handle_t, const mcpwm_capture_event_data_t* e, void*) {
+  if (e->cap_edge == MCPWM_CAP_EDGE_NEG) {
+    pendingHigh = e->cap_value - riseTick;
+    return false;
+  }
+  uint32_t period = e->cap_value - riseTick;
+  riseTick = e->cap_value;
+  portENTER_CRITICAL_ISR(&capMux);
+  frameHigh = pendingHigh;
+  framePeriod = period;
+  ++frames;
+  portEXIT_CRITICAL_ISR(&capMux);
+  return false;
+}
+
+static bool beginCapture(int pin) {
+  mcpwm_cap_timer_handle_t timer = nullptr;
+  mcpwm_capture_timer_config_t tc = {};
+  tc.group_id = 0;
+  tc.clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT;
+  if (mcpwm_new_capture_timer(&tc, &timer) != ESP_OK) return false;
+
+  mcpwm_cap_channel_handle_t chan = nullptr;
+  mcpwm_capture_channel_config_t cc = {};
+  cc.gpio_num = pin;
+  cc.prescale = 1;
+  cc.flags.pos_edge = true;
+  cc.flags.neg_edge = true;
+  if (mcpwm_new_capture_channel(timer, &cc, &chan) != ESP_OK) return false;
+
+  mcpwm_capture_event_callbacks_t cbs = {};
+  cbs.on_cap = onEdge;
+  if (mcpwm_capture_channel_register_event_callbacks(chan, &cbs, nullptr) != ESP_OK) return false;
+  return mcpwm_capture_channel_enable(chan) == ESP_OK && mcpwm_capture_timer_enable(timer) == ESP_OK &&
+         mcpwm_capture_timer_start(timer) == ESP_OK;
+}
+
+#endif
+
+} // namespace
+
+bool encoder_sourceBegin(int pwmPin) {
+#if SPINNER_ENCODER_SOURCE == ENCODER_SOURCE_PWM
+  // switch OUT to PWM (volatile CONF, redone every boot; nothing is burned)
+  uint8_t conf = 0;
+  if (!readRegs(AS5600_REG_CONF_LO, &conf, 1)) {
+    LOGE("AS5600 CONF read failed");
+    return false;
+  }
+  conf = (conf & ~(CONF_OUTS_MASK | CONF_PWMF_MASK)) | CONF_OUTS_PWM | CONF_PWMF_920HZ;
+  Wire.beginTransmission(AS5600_ADDR);
+  Wire.write(AS5600_REG_CONF_LO);
+  Wire.write(conf);
+  if (Wire.endTransmission() != 0) {
+    LOGE("AS5600 CONF write failed");
+    return false;
+  }
+  if (pwmPin < 0 || !beginCapture(pwmPin)) {
+    LOGE("PWM capture on GPIO%d failed", pwmPin);
+    return false;
+  }
+  unsigned long start = millis();
+  while (frames < 2 && millis() - start < PWM_FIRST_FRAME_MS) delay(1);
+  LOGI("PWM source on GPIO%d (%s)", pwmPin, frames >= 2 ? "ok" : "no signal");
+  return frames >= 2;
+#else
+  (void)pwmPin;
+  uint8_t status = 0;
+  return readRegs(AS5600_REG_STATUS, &status, 1);
+#endif
+}
+
+bool encoder_sourceSetProfile(EncoderProfile profile) {
+  if (int(profile) == profileSet) return true;
+  if (profile >= sizeof(PROFILES) / sizeof(PROFILES[0])) return false;
+  uint8_t conf[2];
+  if (!readRegs(AS5600_REG_CONF_HI, conf, 2)) {
+    LOGW("AS5600 CONF read failed");
+    return false;
+  }
+  const ProfileConf& p = PROFILES[profile];
+  conf[0] = (conf[0] & ~CONF_HI_MASK) | p.hi;
+  conf[1] = (conf[1] & ~CONF_LO_PROFILE_MASK) | p.lo;
+  Wire.beginTransmission(AS5600_ADDR);
+  Wire.write(AS5600_REG_CONF_HI);
+  Wire.write(conf[0]);
+  Wire.write(conf[1]);
+  if (Wire.endTransmission() != 0) {
+    LOGW("AS5600 CONF write failed");
+    return false;
+  }
+  profileSet = profile;
+  LOGD("profile %d (CONF %02x %02x)", int(profile), conf[0], conf[1]);
+  return true;
+}
+
+bool encoder_sourceRead(uint16_t& raw, uint8_t& status) {
+#if SPINNER_ENCODER_SOURCE == ENCODER_SOURCE_PWM
+  portENTER_CRITICAL(&capMux);
+  uint32_t high = frameHigh;
+  uint32_t period = framePeriod;
+  uint32_t n = frames;
+  portEXIT_CRITICAL(&capMux);
+  if (n == framesSeen || period == 0) return false;
+  framesSeen = n;
+  raw = encoderPwmDecode(high, period);
+  status = ENCODER_MAGNET_DETECTED;  // STATUS isn't available over PWM
+  return true;
+#else
+  // STATUS + RAW ANGLE in one 3-byte burst (the library reads them in separate transactions)
+  uint8_t b[3];
+  if (!readRegs(AS5600_REG_STATUS, b, 3)) return false;
+  status = b[0];
+  raw = (uint16_t(b[1] & 0x0F) << 8) | b[2];
+  return true;
+#endif
+}
@@ -0,0 +1,62 @@
+// encoder_source.h
+// Where the sense task gets AS5600 angles from, picked at build time:
+//
+//   ENCODER_SOURCE_I2C  (default) STATUS + RAW ANGLE burst read over the shared Wire bus; a
+//                       display flush holding the bus delays or skips samples
+//   ENCODER_SOURCE_PWM  OUT pin switched to PWM (920 Hz) and timed by the MCPWM capture unit;
+//                       uses no bus time, one fresh angle per PWM frame
+//
+// Build with -DSPINNER_ENCODER_SOURCE=ENCODER_SOURCE_PWM and wire OUT to the pin passed to
+// encoder_sourceBegin(). Either way samples feed the same encoder service (encoder.h).
+#pragma once
+
+#include <Arduino.h>
+
+#define ENCODER_SOURCE_I2C 0
+#define ENCODER_SOURCE_PWM 1
+
+#ifndef SPINNER_ENCODER_SOURCE
+  #define SPINNER_ENCODER_SOURCE ENCODER_SOURCE_I2C
+#endif
+
+// reads go over the shared bus: the caller must hold i2cLock()
+const bool ENCODER_SOURCE_USES_I2C = SPINNER_ENCODER_SOURCE == ENCODER_SOURCE_I2C;
+
+// setup(), after Wire and the AS5600 are up. `pwmPin` is only used by the PWM source.
+bool encoder_sourceBegin(int pwmPin);
+
+// Latest angle + AS5600 STATUS bits. False when there is nothing new (no PWM frame since the
+// last call) or the read failed.
+bool encoder_sourceRead(uint16_t& raw, uint8_t& status);
+
+// On-chip filtering / power mode (AS5600 CONF), picked per module (descriptor ENCODER field):
+//   LOW_NOISE  slow filter 16x, fast filter above 6 LSB steps: steady slices, still follows a
+//              quick turn
+//   FAST       slow filter 2x, fast filter above 6 LSB: least lag, for scrubbing / spinning
+//   IDLE       low-power mode 3 (chip polls every 100 ms) and the watchdog on, while no module
+//              is active. The other profiles turn the watchdog off, so a resting wheel is never
+//              polled at 100 ms behind a module's back.
+// Output hysteresis (2 LSB in LOW_NOISE) only applies to ANGLE / the PWM output, not to the
+// RAW ANGLE the I2C source reads.
+enum EncoderProfile : uint8_t {
+  ENCODER_PROFILE_LOW_NOISE,
+  ENCODER_PROFILE_FAST,
+  ENCODER_PROFILE_IDLE,
+};
+
+// Reprogram CONF (volatile, nothing is burned); a no-op when `profile` is already set. Goes
+// over the bus: the caller must hold i2cLock(). False if the chip didn't answer.
+bool encoder_sourceSetProfile(EncoderProfile profile);
+
+// PWM frame: 128 clocks high, 4095 data clocks, 128 clocks low (AS5600 datasheet, PWM output).
+const uint32_t AS5600_PWM_FRAME = 4351;
+const uint32_t AS5600_PWM_LEAD = 128;
+
+// angle from one captured frame, both lengths in the same timer ticks
+inline uint16_t encoderPwmDecode(uint32_t highTicks, uint32_t periodTicks) {
+  if (periodTicks == 0) return 0;
+  uint32_t clocks = uint32_t((uint64_t(highTicks) * AS5600_PWM_FRAME + periodTicks / 2) / periodTicks);
+  if (clocks <= AS5600_PWM_LEAD) return 0;
+  clocks -= AS5600_PWM_LEAD;
+  return clocks > 4095 ? 4095 : uint16_t(clocks);
+}
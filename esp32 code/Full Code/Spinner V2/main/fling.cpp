@@ -0,0 +1,56 @@
+// fling.cpp
+// Momentum navigation (see fling.h). Integer math: travel in counts * 256, gains in Q8.
+#include "fling.h"
+
+namespace {
+
+// amplification at `speed`, Q8 (256 = 1:1): proportional to speed above boostVelocity
+static int64_t gainQ8(const FlingConfig& c, int32_t speed) {
+  if (speed <= c.boostVelocity) return 256;
+  int64_t g = int64_t(speed) * 256 / c.boostVelocity;
+  int64_t cap = int64_t(c.maxGain) * 256;
+  return g > cap ? cap : g;
+}
+
+} // namespace
+
+int32_t fling_update(Fling& f, int32_t delta, int32_t velocity, uint8_t confidence, uint32_t dtMs) {
+  const FlingConfig& c = f.cfg;
+  bool trusted = confidence >= c.minConfidence;
+  int32_t speed = abs(velocity);
+
+  // momentum decays, is cancelled by a reverse turn, and is taken over by a faster flick.
+  // An untrusted estimate (e.g. right after the wheel is stopped dead) changes nothing.
+  if (f.momentum) {
+    f.momentum -= int32_t(int64_t(f.momentum) * dtMs / (c.decayMs + dtMs));
+    if (abs(f.momentum) < c.stopVelocity) f.momentum = 0;
+  }
+  if (trusted) {
+    bool reversed = f.momentum && speed >= c.stopVelocity && (velocity > 0) != (f.momentum > 0);
+    if (reversed) f.momentum = 0;
+    else if (speed >= c.coastVelocity && speed > abs(f.momentum)) f.momentum = velocity;
+  }
+
+  // the wheel's own motion, amplified by its speed
+  int64_t travel = int64_t(delta) * (trusted ? gainQ8(c, speed) : 256);
+
+  // coasting: whatever part of the momentum the wheel no longer covers itself
+  if (f.momentum) {
+    int32_t extra = abs(f.momentum) - speed;
+    if (extra > 0) {
+      int64_t coast = int64_t(extra) * dtMs * gainQ8(c, abs(f.momentum)) / 1000;
+      travel += f.momentum > 0 ? coast : -coast;
+    }
+  }
+
+  f.travelQ8 += travel;
+  int64_t stepQ8 = int64_t(c.countsPerStep) * 256;
+  int32_t steps = int32_t(f.travelQ8 / stepQ8);
+  f.travelQ8 -= int64_t(steps) * stepQ8;
+  return steps;
+}
+
+void fling_reset(Fling& f) {
+  f.travelQ8 = 0;
+  f.momentum = 0;
+}
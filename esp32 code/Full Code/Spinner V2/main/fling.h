@@ -0,0 +1,46 @@
+// fling.h
+// Momentum navigation: turns wheel motion into item steps the way a touch list scrolls.
+//
+//  - slow motion maps 1:1, `countsPerStep` counts per item, so single steps stay precise
+//  - above `boostVelocity` the motion is amplified in proportion to speed (up to `maxGain`)
+//  - a flick (estimated speed reaching `coastVelocity`) leaves momentum behind: whenever the
+//    wheel runs slower than the momentum - it was let go, or stopped dead - the difference keeps
+//    moving the list, decaying with time constant `decayMs` until it drops below `stopVelocity`
+//  - turning the other way cancels the momentum; an untrusted estimate (low confidence) is
+//    neither boosted nor allowed to start or cancel it
+//
+// Velocities are counts/s from the encoder service's estimator (encoder.h).
+#pragma once
+
+#include <Arduino.h>
+
+struct FlingConfig {
+  int32_t countsPerStep;
+  int32_t boostVelocity;
+  int32_t maxGain;
+  int32_t coastVelocity;
+  int32_t stopVelocity;
+  uint16_t decayMs;
+  uint8_t minConfidence;  // below it the estimate is ignored (no boost, no momentum)
+};
+
+struct Fling {
+  FlingConfig cfg;
+  int64_t travelQ8;   // amplified motion not yet turned into whole steps, counts * 256
+  int32_t momentum;   // counts/s, signed; 0 = not coasting
+};
+
+constexpr Fling makeFling(const FlingConfig& cfg) {
+  return Fling{ cfg, 0, 0 };
+}
+
+// One frame: `delta` counts the wheel moved since the last call, the encoder's velocity and
+// confidence at the end of it, and the frame length. Returns whole steps to move (signed).
+int32_t fling_update(Fling& f, int32_t delta, int32_t velocity, uint8_t confidence, uint32_t dtMs);
+
+// Drop momentum and any partial step.
+void fling_reset(Fling& f);
+
+inline bool fling_isCoasting(const Fling& f) {
+  return f.momentum != 0;
+}
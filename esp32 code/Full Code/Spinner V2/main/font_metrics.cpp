@@ -0,0 +1,44 @@
+// font_metrics.cpp
+// GFXfont table lookups (see font_metrics.h).
+#include "font_metrics.h"
+
+uint16_t font_charWidth(const GFXfont* f, char c) {
+  const char s[2] = { c, '\0' };
+  return font_textBounds(f, s).w;
+}
+
+uint16_t font_textAdvance(const GFXfont* f, const char* s) {
+  uint16_t adv = 0;
+  if (!s) return 0;
+  for (; *s; ++s) adv += font_charAdvance(f, *s);
+  return adv;
+}
+
+// Adafruit_GFX::charBounds() for a single line: union of the glyph boxes along the baseline.
+TextBounds font_textBounds(const GFXfont* f, const char* s) {
+  TextBounds b = { 0, 0, 0, 0 };
+  if (!s) return b;
+  // same seeds as the library (the -1 maxima included), so results match to the pixel
+  int16_t minX = 0x7FFF, minY = 0x7FFF, maxX = -1, maxY = -1;
+  int16_t x = 0;
+  for (; *s; ++s) {
+    const GFXglyph* g = font_glyph(f, *s);
+    if (!g) continue;
+    int16_t x1 = x + g->xOffset, y1 = g->yOffset;
+    int16_t x2 = x1 + g->width - 1, y2 = y1 + g->height - 1;
+    if (x1 < minX) minX = x1;
+    if (y1 < minY) minY = y1;
+    if (x2 > maxX) maxX = x2;
+    if (y2 > maxY) maxY = y2;
+    x += g->xAdvance;
+  }
+  if (maxX >= minX) {
+    b.x = minX;
+    b.w = uint16_t(maxX - minX + 1);
+  }
+  if (maxY >= minY) {
+    b.y = minY;
+    b.h = uint16_t(maxY - minY + 1);
+  }
+  return b;
+}
@@ -0,0 +1,38 @@
+// font_metrics.h
+// Text measurement straight from a GFXfont's glyph table. No display.setFont() and no
+// getTextBounds() walk through Adafruit_GFX state, so a width query is a table lookup per
+// character. The numbers are those of display.getTextBounds(s, 0, 0, ...) for one line at text
+// size 1 with wrapping off. Characters outside the font are skipped, as the library does; so is
+// '\n' (single line only).
+//
+// The font headers declare their tables `const`, not `constexpr`, so the lookups happen at run
+// time. On the ESP32, PROGMEM is memory mapped and read directly.
+#pragma once
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+struct TextBounds {
+  int16_t x, y;  // top-left of the ink, relative to the cursor (baseline origin)
+  uint16_t w, h; // 0 x 0 for a lone blank; a run of blanks spans them, as the library does
+};
+
+inline const GFXglyph* font_glyph(const GFXfont* f, char c) {
+  uint8_t u = uint8_t(c);
+  if (!f || u < f->first || u > f->last) return nullptr;
+  return f->glyph + (u - f->first);
+}
+
+// ink width of one character (getTextBounds of it alone)
+uint16_t font_charWidth(const GFXfont* f, char c);
+
+// how far the cursor moves after printing `c`
+inline uint8_t font_charAdvance(const GFXfont* f, char c) {
+  const GFXglyph* g = font_glyph(f, c);
+  return g ? g->xAdvance : 0;
+}
+
+// cursor advance of a whole string (kerning-free, as the library prints it)
+uint16_t font_textAdvance(const GFXfont* f, const char* s);
+
+TextBounds font_textBounds(const GFXfont* f, const char* s);
@@ -0,0 +1,264 @@
+// logger.cpp
+// Lock-free log ring + drain task (see logger.h).
+//
+// Producers (any task, either core) claim space with a CAS on `reservePos`, fill the record
+// and publish it by setting the commit bit in its header word. The single consumer (the drain
+// task) walks records in order, stops at the first uncommitted one, and zeroes what it consumed
+// so an unwritten header always reads as "not committed".
+#include "logger.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <atomic>
+
+namespace {
+
+// ===== CONFIG =====
+const size_t RING_SIZE = 4096;  // power of two
+const size_t LOG_LINE_MAX = 192;
+
+const BaseType_t DRAIN_CORE = 0;
+const UBaseType_t DRAIN_PRIO = 1;  // below rfid/net, above idle
+const uint32_t DRAIN_STACK = 4096;
+const TickType_t DRAIN_PERIOD = pdMS_TO_TICKS(20);
+
+// mirror every line to a UDP listener (e.g. `nc -ul 5140`) while WiFi is up
+const bool LOG_UDP = false;
+const char* LOG_UDP_HOST = "192.168.68.80";
+const uint16_t LOG_UDP_PORT = 5140;
+
+const uint32_t HDR_COMMITTED = 1;
+const uint32_t HDR_PAD = 2;  // filler up to the end of the ring, skipped by the drain
+
+struct RecordHeader {
+  uint32_t word;  // size | flags, written last
+  uint32_t ms;
+  const char* tag;
+  const char* fmt;
+  uint8_t level;
+  uint8_t nargs;
+  uint16_t argBytes;
+};
+
+// ===== STATE =====
+alignas(4) uint8_t ring[RING_SIZE];
+std::atomic<uint32_t> reservePos{0};
+std::atomic<uint32_t> readPos{0};
+std::atomic<uint32_t> written{0};
+std::atomic<uint32_t> dropped{0};
+uint32_t droppedReported = 0;
+
+TaskHandle_t drainTask = nullptr;
+WiFiUDP udp;
+
+static uint32_t align4(size_t n) {
+  return uint32_t((n + 3) & ~size_t(3));
+}
+
+static std::atomic<uint32_t>& headerWord(uint32_t offset) {
+  return *reinterpret_cast<std::atomic<uint32_t>*>(&ring[offset]);
+}
+
+static char levelChar(uint8_t level) {
+  switch (level) {
+    case LOG_LEVEL_ERROR: return 'E';
+    case LOG_LEVEL_WARN: return 'W';
+    case LOG_LEVEL_INFO: return 'I';
+    default: return 'D';
+  }
+}
+
+static size_t appendRaw(char* out, size_t len, size_t n, int wrote) {
+  if (wrote < 0) return n;
+  size_t room = len - 1 - n;
+  return n + (size_t(wrote) < room ? size_t(wrote) : room);
+}
+
+// The deferred half of printf: walk `fmt`, take each argument from the record.
+static size_t formatArgs(char* out, size_t len, size_t n, const char* f, const uint8_t* a, uint8_t left) {
+  while (*f && n < len - 1) {
+    if (*f != '%') { out[n++] = *f++; continue; }
+    if (f[1] == '%') { out[n++] = '%'; f += 2; continue; }
+
+    char spec[20];
+    size_t k = 0;
+    spec[k++] = *f++;
+    while (*f && strchr("-+ #0", *f) && k < 6) spec[k++] = *f++;
+    while (*f >= '0' && *f <= '9' && k < 9) spec[k++] = *f++;
+    if (*f == '.') {
+      spec[k++] = *f++;
+      while (*f >= '0' && *f <= '9' && k < 12) spec[k++] = *f++;
+    }
+    while (*f && strchr("hlzjtL", *f)) ++f;  // the stored argument type decides the width
+    char conv = *f;
+    if (!conv) break;
+    ++f;
+    if (!left) {
+      n = appendRaw(out, len, n, snprintf(out + n, len - n, "<?>"));
+      continue;
+    }
+    --left;
+
+    LogArgType type = LogArgType(*a++);
+    bool intConv = strchr("diuxXoc", conv) != nullptr;
+    bool floatConv = strchr("feEgG", conv) != nullptr;
+    int wrote = -1;
+    switch (type) {
+      case LOG_ARG_I32:
+      case LOG_ARG_U32: {
+        uint32_t v;
+        memcpy(&v, a, 4);
+        a += 4;
+        spec[k++] = conv;
+        spec[k] = '\0';
+        if (intConv) wrote = snprintf(out + n, len - n, spec, type == LOG_ARG_I32 ? int(int32_t(v)) : int(v));
+        else if (floatConv) wrote = snprintf(out + n, len - n, spec, type == LOG_ARG_I32 ? double(int32_t(v)) : double(v));
+        break;
+      }
+      case LOG_ARG_I64:
+      case LOG_ARG_U64: {
+        uint64_t v;
+        memcpy(&v, a, 8);
+        a += 8;
+        spec[k++] = 'l';
+        spec[k++] = 'l';
+        spec[k++] = conv;
+        spec[k] = '\0';
+        if (intConv && conv != 'c') wrote = snprintf(out + n, len - n, spec, (long long)v);
+        break;
+      }
+      case LOG_ARG_F64: {
+        double v;
+        memcpy(&v, a, 8);
+        a += 8;
+        spec[k++] = conv;
+        spec[k] = '\0';
+        if (floatConv) wrote = snprintf(out + n, len - n, spec, v);
+        break;
+      }
+      case LOG_ARG_STR: {
+        uint8_t sl = *a++;
+        char tmp[LOG_STR_MAX + 1];
+        memcpy(tmp, a, sl);
+        tmp[sl] = '\0';
+        a += sl;
+        spec[k++] = 's';
+        spec[k] = '\0';
+        if (conv == 's') wrote = snprintf(out + n, len - n, spec, tmp);
+        break;
+      }
+      case LOG_ARG_PTR: {
+        const void* v;
+        memcpy(&v, a, sizeof(v));
+        a += sizeof(v);
+        if (conv == 'p' || conv == 'x') wrote = snprintf(out + n, len - n, "%p", v);
+        break;
+      }
+      default:
+        left = 0;  // corrupt record: stop decoding
+        break;
+    }
+    if (wrote < 0) wrote = snprintf(out + n, len - n, "<?>");
+    n = appendRaw(out, len, n, wrote);
+  }
+  return n;
+}
+
+static void emit(const char* line, size_t n) {
+  Serial.write(reinterpret_cast<const uint8_t*>(line), n);
+  if (LOG_UDP && WiFi.status() == WL_CONNECTED) {
+    udp.beginPacket(LOG_UDP_HOST, LOG_UDP_PORT);
+    udp.write(reinterpret_cast<const uint8_t*>(line), n);
+    udp.endPacket();
+  }
+}
+
+static void drainOnce() {
+  char line[LOG_LINE_MAX];
+  for (;;) {
+    uint32_t pos = readPos.load(std::memory_order_relaxed);
+    if (pos == reservePos.load(std::memory_order_acquire)) break;
+    uint32_t off = pos & (RING_SIZE - 1);
+    uint32_t word = headerWord(off).load(std::memory_order_acquire);
+    if (!(word & HDR_COMMITTED)) break;  // still being written
+    uint32_t size = word & ~3u;
+
+    if (!(word & HDR_PAD)) {
+      const RecordHeader* h = reinterpret_cast<const RecordHeader*>(&ring[off]);
+      size_t n = appendRaw(line, sizeof(line), 0,
+                           snprintf(line, sizeof(line), "[%lu][%c][%s] ", (unsigned long)h->ms, levelChar(h->level), h->tag));
+      n = formatArgs(line, sizeof(line), n, h->fmt, &ring[off + sizeof(RecordHeader)], h->nargs);
+      line[n++] = '\n';
+      emit(line, n);
+    }
+
+    memset(&ring[off], 0, size);
+    readPos.store(pos + size, std::memory_order_release);
+  }
+
+  uint32_t d = dropped.load(std::memory_order_relaxed);
+  if (d != droppedReported) {
+    int n = snprintf(line, sizeof(line), "[log] %lu line(s) dropped (ring full)\n", (unsigned long)(d - droppedReported));
+    droppedReported = d;
+    emit(line, size_t(n));
+  }
+}
+
+static void drainLoop(void*) {
+  for (;;) {
+    drainOnce();
+    vTaskDelay(DRAIN_PERIOD);
+  }
+}
+
+} // namespace
+
+void logger_begin() {
+  if (drainTask) return;
+  xTaskCreatePinnedToCore(drainLoop, "log", DRAIN_STACK, nullptr, DRAIN_PRIO, &drainTask, DRAIN_CORE);
+}
+
+uint8_t* log_begin(uint8_t level, const char* tag, const char* fmt, uint8_t nargs, size_t argBytes) {
+  uint32_t size = align4(sizeof(RecordHeader) + argBytes);
+  if (size > RING_SIZE / 4) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  uint32_t pos, off, pad, start;
+  pos = reservePos.load(std::memory_order_relaxed);
+  do {
+    off = pos & (RING_SIZE - 1);
+    pad = (off + size > RING_SIZE) ? uint32_t(RING_SIZE - off) : 0;  // records never wrap
+    if (pos + pad + size - readPos.load(std::memory_order_acquire) > RING_SIZE) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+  } while (!reservePos.compare_exchange_weak(pos, pos + pad + size, std::memory_order_acq_rel,
+                                             std::memory_order_relaxed));
+
+  if (pad) headerWord(off).store(pad | HDR_PAD | HDR_COMMITTED, std::memory_order_release);
+  start = pad ? 0 : off;
+
+  RecordHeader* h = reinterpret_cast<RecordHeader*>(&ring[start]);
+  h->ms = millis();
+  h->tag = tag;
+  h->fmt = fmt;
+  h->level = level;
+  h->nargs = nargs;
+  h->argBytes = uint16_t(argBytes);
+  return &ring[start + sizeof(RecordHeader)];
+}
+
+void log_commit(uint8_t* args) {
+  uint8_t* rec = args - sizeof(RecordHeader);
+  const RecordHeader* h = reinterpret_cast<const RecordHeader*>(rec);
+  uint32_t size = align4(sizeof(RecordHeader) + h->argBytes);
+  headerWord(uint32_t(rec - ring)).store(size | HDR_COMMITTED, std::memory_order_release);
+  written.fetch_add(1, std::memory_order_relaxed);
+}
+
+LoggerStats logger_stats() {
+  return LoggerStats{ written.load(), dropped.load() };
+}
@@ -0,0 +1,111 @@
+// logger.h
+// Asynchronous logging. LOGE/LOGW/LOGI/LOGD don't format or touch the UART: they copy the
+// format pointer and the raw arguments (strings by value) into a lock-free ring, and a
+// low-priority drain task formats and writes them to Serial (and optionally a UDP sink).
+// A call costs a few hundred cycles instead of ~87 us per character at 115200 baud.
+//
+// Per file, before including this header:
+//   #define LOGGER_TAG "album"            // prefix on every line
+//   #define LOGGER_LEVEL LOG_LEVEL_DEBUG  // compile-time filter (default LOG_LEVEL_INFO)
+// Calls above the file's level compile to nothing.
+//
+// Format strings must be literals (only the pointer is stored). Supported conversions:
+// d i u x X o c s p f e g (flags/width/precision allowed, length modifiers are ignored -
+// the stored argument type decides). When the ring is full new lines are dropped and counted.
+#pragma once
+
+#include <Arduino.h>
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOGGER_TAG
+  #define LOGGER_TAG "main"
+#endif
+#ifndef LOGGER_LEVEL
+  #define LOGGER_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_AT_(lvl, ...) \
+  do { if (LOGGER_LEVEL >= (lvl)) log_write((lvl), LOGGER_TAG, __VA_ARGS__); } while (0)
+#define LOGE(...) LOG_AT_(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOGW(...) LOG_AT_(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOGI(...) LOG_AT_(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOGD(...) LOG_AT_(LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+// Call first thing in setup(): creates the ring and starts the drain task.
+void logger_begin();
+
+// counters for diagnostics
+struct LoggerStats {
+  uint32_t written;
+  uint32_t dropped;  // ring full
+};
+LoggerStats logger_stats();
+
+// ---- encoding (used by log_write(); not for direct use) ----
+enum LogArgType : uint8_t { LOG_ARG_I32, LOG_ARG_U32, LOG_ARG_I64, LOG_ARG_U64, LOG_ARG_F64, LOG_ARG_STR, LOG_ARG_PTR };
+
+const size_t LOG_STR_MAX = 47;   // longer string arguments are truncated
+const uint8_t LOG_MAX_ARGS = 8;
+
+// Reserve room for a record with `argBytes` of encoded arguments; nullptr when the ring is full.
+uint8_t* log_begin(uint8_t level, const char* tag, const char* fmt, uint8_t nargs, size_t argBytes);
+void log_commit(uint8_t* args);  // the pointer log_begin() returned
+
+inline size_t logArgSize(int) { return 1 + 4; }
+inline size_t logArgSize(unsigned) { return 1 + 4; }
+inline size_t logArgSize(long) { return 1 + sizeof(long); }
+inline size_t logArgSize(unsigned long) { return 1 + sizeof(unsigned long); }
+inline size_t logArgSize(long long) { return 1 + 8; }
+inline size_t logArgSize(unsigned long long) { return 1 + 8; }
+inline size_t logArgSize(double) { return 1 + 8; }
+inline size_t logArgSize(const void*) { return 1 + sizeof(void*); }
+inline size_t logArgSize(const char* s) {
+  size_t n = s ? strnlen(s, LOG_STR_MAX) : 0;
+  return 1 + 1 + n;
+}
+inline size_t logArgSize(const String& s) { return logArgSize(s.c_str()); }
+
+inline void logPut(uint8_t*& p, LogArgType t, const void* v, size_t n) {
+  *p++ = t;
+  memcpy(p, v, n);
+  p += n;
+}
+inline void logArgPut(uint8_t*& p, int v) { int32_t x = v; logPut(p, LOG_ARG_I32, &x, 4); }
+inline void logArgPut(uint8_t*& p, unsigned v) { uint32_t x = v; logPut(p, LOG_ARG_U32, &x, 4); }
+inline void logArgPut(uint8_t*& p, long v) {
+  if (sizeof(long) == 4) { int32_t x = v; logPut(p, LOG_ARG_I32, &x, 4); }
+  else { int64_t x = v; logPut(p, LOG_ARG_I64, &x, 8); }
+}
+inline void logArgPut(uint8_t*& p, unsigned long v) {
+  if (sizeof(long) == 4) { uint32_t x = v; logPut(p, LOG_ARG_U32, &x, 4); }
+  else { uint64_t x = v; logPut(p, LOG_ARG_U64, &x, 8); }
+}
+inline void logArgPut(uint8_t*& p, long long v) { int64_t x = v; logPut(p, LOG_ARG_I64, &x, 8); }
+inline void logArgPut(uint8_t*& p, unsigned long long v) { uint64_t x = v; logPut(p, LOG_ARG_U64, &x, 8); }
+inline void logArgPut(uint8_t*& p, double v) { logPut(p, LOG_ARG_F64, &v, 8); }
+inline void logArgPut(uint8_t*& p, const void* v) { logPut(p, LOG_ARG_PTR, &v, sizeof(v)); }
+inline void logArgPut(uint8_t*& p, const char* s) {
+  uint8_t n = s ? uint8_t(strnlen(s, LOG_STR_MAX)) : 0;
+  *p++ = LOG_ARG_STR;
+  *p++ = n;
+  if (n) memcpy(p, s, n);
+  p += n;
+}
+inline void logArgPut(uint8_t*& p, const String& s) { logArgPut(p, s.c_str()); }
+
+template <typename... Args>
+void log_write(uint8_t level, const char* tag, const char* fmt, const Args&... args) {
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+  size_t bytes = (size_t(0) + ... + logArgSize(args));
+  uint8_t* rec = log_begin(level, tag, fmt, sizeof...(Args), bytes);
+  if (!rec) return;
+  uint8_t* p = rec;
+  (logArgPut(p, args), ...);
+  (void)p;  // no arguments
+  log_commit(rec);
+}
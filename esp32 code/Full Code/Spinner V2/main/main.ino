@@ -1,6 +1,7 @@
 // main.ino
 // Central controller (RFID -> module switching) for Spinner V2
 // Single-file main which assumes module_*.h files provide the module APIs.
+// loop() is the render/control task; sensing, RFID and networking run in tasks.cpp.
 
 #include <Arduino.h>
 #include <SPI.h>
@@ -18,20 +19,23 @@
 #include <MFRC522.h>
 
 #include "shared.h"
-#include "module_friend.h"
-#include "module_family.h"
-#include "module_date.h"
-#include "module_days.h"
-#include "module_distance.h"
-#include "module_timeline.h"
-#include "module_cousins.h"
-#include "module_afamily.h"
-#include "module_themes.h"
-#include "module_album.h"
+#include "tasks.h"
+#include "net.h"
+#include "rfid.h"
+#include "encoder_source.h"
+#include "encoder.h"
+#include "calibration.h"
+#include "oled.h"
+#include "modules.h"
+#include "perf.h"
+#include "logger.h"
 
 // ---- shared configuration values (definitions) ----
 const uint8_t SDA_PIN = 5;
 const uint8_t SCL_PIN = 6;
+// shared bus for AS5600 + SSD1306, both rated for 400 kHz fast mode
+const uint32_t I2C_CLOCK_HZ = 400000UL;
+const uint8_t OLED_ADDR = 0x3D;
 const uint8_t PIXEL_PIN = 2;
 const uint16_t NUM_PIXELS = 1;
 
@@ -48,25 +52,26 @@ const uint16_t MQTT_PORT = 1883;
 // RFID pins (from your working code)
 #define RST_PIN 1  // Use your selected RST pin
 #define SS_PIN 44  // Chip select / SDA pin
+#define RFID_IRQ_PIN -1  // RC522 IRQ line (e.g. 4 = D3); -1 = no IRQ wired, poll at a low rate
 
-// Example UID mapping (replace after first serial run)
-// Note: UIDs must match the format returned by tryReadRfidUid() (uppercase hex concatenated bytes)
-const char* FRIEND_UID = "F16B8949";          // replace with real scanned UID
-const char* FAMILY_UID = "91798949";
-const char* DATE_UID = "A1778949";
-const char* DAYS_UID = "C19D8949";
-const char* DISTANCE_UID = "1D0B1CBB8A0000";
-const char* TIMELINE_UID = "";
-const char* COUSINS_UID = "D19B8949";
-const char* AFAMILY_UID = "E1998949";
-const char* THEMES_UID = "81AD8949";
-const char* ALBUM_UID_TAG_1 = "C1A18949"; // baby
-const char* ALBUM_UID_TAG_2 = "41AF8949"; // toddler
+// AS5600 OUT pin, only used when built with SPINNER_ENCODER_SOURCE=ENCODER_SOURCE_PWM
+#define ENCODER_PWM_PIN 43  // D6
+
+// lifting the active module's tag deactivates it (false keeps the module running until
+// another tag is scanned, as before)
+const bool DEACTIVATE_ON_TAG_REMOVED = false;
+
+// Tag UIDs live with the module descriptors in modules.h (compile-time hashed UID table)
+
+// Scanning this tag stores the current wheel angle as the active module's RAW_OFFSET (hold the
+// wheel at the start of its first item). Written like the module tags; "" = no calibration tag.
+constexpr UidKey CALIBRATION_TAG = uidKeyFromHex("");
 
 // ---- shared object definitions (actual instances) ----
 AS5600 as5600;  // uses Wire
 CRGB* leds = nullptr;
-Adafruit_SSD1306 display(SCREEN_W, SCREEN_H, &Wire, OLED_RESET);
+// keep the bus at I2C_CLOCK_HZ after flushes too (the library drops it to 100 kHz by default)
+Adafruit_SSD1306 display(SCREEN_W, SCREEN_H, &Wire, OLED_RESET, I2C_CLOCK_HZ, I2C_CLOCK_HZ);
 
 WiFiClient wifiClient;
 PubSubClient mqttClient(wifiClient);
@@ -74,197 +79,80 @@ PubSubClient mqttClient(wifiClient);
 // MFRC522 instance
 MFRC522 mfrc522(SS_PIN, RST_PIN);  // SS, RST
 
-// Module function typedefs
-typedef void (*module_fn_t)();
-typedef void (*mqtt_fn_t)(const char* topic, const char* payload);
-
-// ModuleEntry structure - map UID -> module functions
-struct ModuleEntry {
-  const char* uid;   // UID string to match (uppercase hex)
-  const char* name;  // friendly name (for logging)
-  module_fn_t setup;
-  module_fn_t activate;
-  module_fn_t deactivate;
-  module_fn_t loop;
-  mqtt_fn_t onMqtt;  // optional MQTT forwarder for active module (can be nullptr)
-};
-
-// Forward declarations (module headers supply these)
-extern void module_friend_setup();
-extern void module_friend_activate();
-extern void module_friend_deactivate();
-extern void module_friend_loop();
-
-extern void module_family_setup();
-extern void module_family_activate();
-extern void module_family_deactivate();
-extern void module_family_loop();
-
-extern void module_date_setup();
-extern void module_date_activate();
-extern void module_date_deactivate();
-extern void module_date_loop();
-
-extern void module_days_setup();
-extern void module_days_activate();
-extern void module_days_deactivate();
-extern void module_days_loop();
-
-extern void module_timeline_setup();
-extern void module_timeline_activate();
-extern void module_timeline_deactivate();
-extern void module_timeline_loop();
-
-extern void module_distance_setup();
-extern void module_distance_activate();
-extern void module_distance_deactivate();
-extern void module_distance_loop();
-
-extern void module_cousins_setup();
-extern void module_cousins_activate();
-extern void module_cousins_deactivate();
-extern void module_cousins_loop();
-
-extern void module_afamily_setup();
-extern void module_afamily_activate();
-extern void module_afamily_deactivate();
-extern void module_afamily_loop();
-
-extern void module_themes_setup();
-extern void module_themes_activate();
-extern void module_themes_deactivate();
-extern void module_themes_loop();
-
-extern void module_album_setup();
-extern void module_album_activate();
-extern void module_album_deactivate();
-extern void module_album_loop();
-extern void module_album_onMqtt(const char* topic, const char* payload);
-
-// The module table: add more entries when you add modules.
-// If you want a module present but not mapped to a tag, set uid = nullptr.
-ModuleEntry modules[] = {
-  { FRIEND_UID, "friend", module_friend_setup, module_friend_activate, module_friend_deactivate, module_friend_loop, nullptr },
-  { FAMILY_UID, "family", module_family_setup, module_family_activate, module_family_deactivate, module_family_loop, nullptr },
-  { DATE_UID, "date", module_date_setup, module_date_activate, module_date_deactivate, module_date_loop, nullptr },
-  { DAYS_UID, "days", module_days_setup, module_days_activate, module_days_deactivate, module_days_loop, nullptr },
-  { DISTANCE_UID, "distance", module_distance_setup, module_distance_activate, module_distance_deactivate, module_distance_loop, nullptr },
-  { TIMELINE_UID, "timeline", module_timeline_setup, module_timeline_activate, module_timeline_deactivate, module_timeline_loop, nullptr },
-  { COUSINS_UID, "cousins", module_cousins_setup, module_cousins_activate, module_cousins_deactivate, module_cousins_loop, nullptr },
-  { AFAMILY_UID, "afamily", module_afamily_setup, module_afamily_activate, module_afamily_deactivate, module_afamily_loop, nullptr },
-  { THEMES_UID, "themes", module_themes_setup, module_themes_activate, module_themes_deactivate, module_themes_loop, nullptr },
-  { ALBUM_UID_TAG_1, "album", module_album_setup, module_album_activate, module_album_deactivate, module_album_loop, module_album_onMqtt },
-  { ALBUM_UID_TAG_2, "album", module_album_setup, module_album_activate, module_album_deactivate, module_album_loop, module_album_onMqtt },
-  { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr }  // sentinel
-};
-
-// ---- MQTT/Module state (MUST be before mqttDispatch) ----
-int activeModuleIndex = -1;    // index into modules[], -1 = none
-String currentActiveUid = "";  // active UID string (empty = none)
+// false when no module in this build uses the network: WiFi and the net task are skipped
+const bool WITH_NET = (Modules::NEEDS & NEED_NET) != 0;
+
+// ---- module state ----
+int activeModuleIndex = -1;    // registry index (Modules), -1 = none
+Uid currentActiveUid = {};     // active tag (len 0 = none)
 
 unsigned long lastTagProcessedMs = 0;
 const unsigned long TAG_DEBOUNCE_MS = 600;  // ignore re-reads within this window
 
-// Forward-declare mqttDispatch so setCallback can reference it if needed
-void mqttDispatch(char* topic, byte* payload, unsigned int length);
-
-void mqttDispatch(char* topic, byte* payload, unsigned int length) {
-  Serial.println(">>>>>>> CALLBACK TRIGGERED <<<<<<<");
-
-  static const size_t BUF_SZ = 8192;
-  static char buf[BUF_SZ];
-  unsigned int n = (length < BUF_SZ - 1) ? length : (BUF_SZ - 1);
-  if (n > 0 && payload != nullptr) memcpy(buf, payload, n);
-  buf[n] = '\0';
-
-  Serial.print("MQTT IN -> ");
-  Serial.println(topic);
-  Serial.print("Payload len: ");
-  Serial.println(length);
-  Serial.print("Payload: ");
-  Serial.println(buf);
-
-  // forward to active module if it has a handler
-  if (activeModuleIndex >= 0) {
-    mqtt_fn_t handler = modules[activeModuleIndex].onMqtt;
-    if (handler) {
-      handler(topic, buf);
-    } else {
-      Serial.print("No onMqtt handler for active module: ");
-      Serial.println(modules[activeModuleIndex].name);
-    }
-  } else {
-    Serial.println("No active module to handle MQTT");
-  }
+// ---- helpers: lookup, activate, deactivate ----
+const TagEntry* tagLookup(const UidKey& key) {
+  int i = TAG_HASH.find(key);
+  if (i < 0 || TAGS[i].key != key) return nullptr;
+  return &TAGS[i];
 }
 
-// ---- MQTT reconnect helper ----
-void reconnectMQTT() {
-  if (mqttClient.connected()) return;
-
-  while (!mqttClient.connected()) {
-    Serial.print("Attempting MQTT connection...");
-    String clientId = "esp32-";
-    clientId += String((uint32_t)ESP.getEfuseMac(), HEX);
-    if (mqttClient.connect(clientId.c_str())) {
-      Serial.println("connected");
-
-      mqttClient.setCallback(mqttDispatch);
-
-      // After reconnect, re-run activate() for the currently active module so it can re-subscribe
-      if (activeModuleIndex >= 0) {
-        Serial.print("Restoring active module subscriptions for: ");
-        Serial.println(modules[activeModuleIndex].name);
-        if (modules[activeModuleIndex].activate) {
-          // modules' activate() expects currentActiveUid to be already set
-          modules[activeModuleIndex].activate();
-        }
-      }
-    } else {
-      Serial.print("failed, rc=");
-      Serial.print(mqttClient.state());
-      Serial.println(" try again in 2s");
-      delay(2000);
-    }
-  }
+int findModuleIndexByUid(const Uid& uid) {
+  const TagEntry* tag = tagLookup(uid.key());
+  return tag ? Modules::indexOf(tag->module) : -1;
 }
 
-// ---- helpers: lookup, activate, deactivate ----
-int findModuleIndexByUid(const String& uid) {
-  for (int i = 0; modules[i].uid != nullptr; ++i) {
-    if (uid == String(modules[i].uid)) return i;
-  }
-  return -1;
+// AS5600 filter / power profile, over the shared bus
+void setEncoderProfile(EncoderProfile profile) {
+  i2cLock();
+  if (!encoder_sourceSetProfile(profile)) LOGW("Encoder profile %d not set", int(profile));
+  i2cUnlock();
 }
 
-void activateModuleByIndex(int idx, const String& uid) {
+void activateModuleByIndex(int idx, const Uid& uid) {
   if (idx < 0) return;
 
-  // deactivate previous (if different)
-  if (activeModuleIndex >= 0 && activeModuleIndex != idx) {
-    if (modules[activeModuleIndex].deactivate) modules[activeModuleIndex].deactivate();
-    Serial.print("Deactivated module: ");
-    Serial.println(modules[activeModuleIndex].name);
+  // deactivate previous (also when the same module is re-selected by a different tag,
+  // e.g. a second album, so it drops the old tag's state and subscriptions)
+  if (activeModuleIndex >= 0) {
+    Modules::deactivate(activeModuleIndex);
+    mqttReleaseAll(Modules::id(activeModuleIndex));  // anything the module forgot to unsubscribe
+    LOGI("Deactivated module: %s", Modules::name(activeModuleIndex));
   }
 
-  // set the active index/uid BEFORE calling activate so incoming MQTT during activation
-  // will be forwarded to the new module's onMqtt handler.
+  // set the active index/uid BEFORE calling activate; modules read the tag during activate()
   activeModuleIndex = idx;
   currentActiveUid = uid;
 
   // call module activate
-  if (modules[idx].activate) modules[idx].activate();
-  Serial.print("Activated module: ");
-  Serial.println(modules[idx].name);
+  setEncoderProfile(Modules::encoderProfile(idx));
+  Modules::activate(idx);
+  LOGI("Activated module: %s", Modules::name(idx));
+}
+
+int findModuleIndexByName(const char* name) {
+  for (int i = 0; i < Modules::COUNT; ++i) {
+    if (strcmp(Modules::name(i), name) == 0) return i;
+  }
+  return -1;
+}
+
+// Store a calibration change for module `idx`; an active module re-reads it by re-activating.
+void applyCalibration(int idx, const CalibCommand& cmd) {
+  if (idx < 0 || !calib_apply(Modules::id(idx), cmd, encoder_read().raw)) {
+    LOGW("Calibration ignored: %s has none", idx < 0 ? "no module" : Modules::name(idx));
+    return;
+  }
+  if (idx == activeModuleIndex) Modules::activate(idx);
 }
 
 void deactivateActiveModule() {
   if (activeModuleIndex >= 0) {
-    if (modules[activeModuleIndex].deactivate) modules[activeModuleIndex].deactivate();
-    Serial.print("Deactivated module: ");
-    Serial.println(modules[activeModuleIndex].name);
+    Modules::deactivate(activeModuleIndex);
+    mqttReleaseAll(Modules::id(activeModuleIndex));
+    LOGI("Deactivated module: %s", Modules::name(activeModuleIndex));
     activeModuleIndex = -1;
-    currentActiveUid = "";
+    currentActiveUid.clear();
+    setEncoderProfile(ENCODER_PROFILE_IDLE);
   }
 }
 
@@ -272,6 +160,8 @@ void deactivateActiveModule() {
 void setup() {
   Serial.begin(115200);
   while (!Serial);
+  // runtime messages go through the async logger; boot messages below stay synchronous
+  logger_begin();
 
   Serial.println("Booting — central init (with MFRC522)");
 
@@ -284,12 +174,14 @@ void setup() {
 
   // --- I2C + sensor init (centralised) ---
   Wire.begin(SDA_PIN, SCL_PIN);
-  Wire.setClock(100000UL);
+  Wire.setClock(I2C_CLOCK_HZ);
   if (!as5600.begin()) {
     Serial.println("AS5600 not found! (check wiring)");
   } else {
     Serial.println("AS5600 OK");
   }
+  if (!encoder_sourceBegin(ENCODER_PWM_PIN)) Serial.println("Encoder source not responding");
+  encoder_sourceSetProfile(ENCODER_PROFILE_IDLE);  // until a module is activated
 
   // --- NeoPixel init ---
   FastLED.addLeds<WS2812B, PIXEL_PIN, GRB>(leds, NUM_PIXELS);
@@ -298,27 +190,22 @@ void setup() {
   FastLED.show();
 
   // --- OLED init ---
-  if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3D)) {
+  if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR)) {
     Serial.println("SSD1306 init failed!");
   } else {
     display.clearDisplay();
     display.display();
   }
+  oled_begin(display, Wire, OLED_ADDR);  // first displayFlush() is a full one
 
-  // --- Wi-Fi & MQTT init ---
-  Serial.print("Connecting to WiFi ");
-  Serial.print(WIFI_SSID);
-  WiFi.begin(WIFI_SSID, WIFI_PWD);
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    Serial.print(".");
-  }
-  Serial.println(" connected");
+  // --- queues + I2C bus lock (modules' setup() below already goes through them) ---
+  tasks_init();
 
-  mqttClient.setServer(MQTT_SERVER, MQTT_PORT);
+  // --- Wi-Fi & MQTT init (non-blocking; the net task brings the link up) ---
+  if (WITH_NET) net_begin(WIFI_SSID, WIFI_PWD, MQTT_SERVER, MQTT_PORT);
 
-  // Register the single callback we use for all inbound messages
-  mqttClient.setCallback(mqttDispatch);
+  // --- stored calibration (before module setup(), which reads it) ---
+  calib_begin(WITH_NET);
 
   // --- MFRC522 init (your proven config) ---
   SPI.begin(7, 9, 8);  // SCK, MISO, MOSI — keep your proven wiring
@@ -331,71 +218,94 @@ void setup() {
   } else {
     Serial.println("MFRC522 ready. Scan a tag to activate a module.");
   }
+  rfid_begin(RFID_IRQ_PIN);
 
   // --- initialise all modules (optional: modules can defer heavy init to activate) ---
-  for (int i = 0; modules[i].uid != nullptr; ++i) {
-    if (modules[i].setup) modules[i].setup();
+  for (int i = 0; i < Modules::COUNT; ++i) {
+    Modules::setup(i);
     Serial.print("Module initialised: ");
-    Serial.println(modules[i].name);
+    Serial.println(Modules::name(i));
   }
 
-  Serial.println("Setup complete");
-}
+  // --- hand sensing + networking to their own tasks ---
+  tasks_start(WITH_NET);
 
-// ---- read RFID helper (non-blocking, returns empty if no new tag) ----
-String tryReadRfidUid() {
-  if (!mfrc522.PICC_IsNewCardPresent()) return String("");
-  if (!mfrc522.PICC_ReadCardSerial()) return String("");
-
-  String uidStr = "";
-  for (byte i = 0; i < mfrc522.uid.size; i++) {
-    if (mfrc522.uid.uidByte[i] < 0x10) uidStr += "0";
-    uidStr += String(mfrc522.uid.uidByte[i], HEX);
-  }
-  uidStr.toUpperCase();
-
-  mfrc522.PICC_HaltA();
-  return uidStr;
+  Serial.println("Setup complete");
 }
 
-// ---- main loop ----
-void loop() {
-  // keep MQTT alive (non-blocking reconnect routine)
-  if (!mqttClient.connected()) reconnectMQTT();
-  mqttClient.loop();
+// ---- render/control frame ----
+// tag events queued by the rfid task
+void handleTagEvents() {
+  PERF_SCOPE(PERF_TAGS);
+  RfidEvent tag;
+  while (tasks_nextTag(tag)) {
+    const Uid& uid = tag.uid;
+    char hex[UID_HEX_LEN];
+
+    if (tag.type == RFID_TAG_REMOVED) {
+      LOGI("Card removed: %s", uidFormat(uid, hex, sizeof(hex)));
+      if (DEACTIVATE_ON_TAG_REMOVED && uid == currentActiveUid) deactivateActiveModule();
+      continue;
+    }
 
-  // Poll RFID (fast non-blocking)
-  String uid = tryReadRfidUid();
-  if (uid.length()) {
     unsigned long now = millis();
     if (now - lastTagProcessedMs < TAG_DEBOUNCE_MS) {
-      Serial.println("RFID read ignored (debounce)");
-    } else {
-      lastTagProcessedMs = now;
-      Serial.print("Card UID: ");
-      Serial.println(uid);
+      LOGD("RFID read ignored (debounce)");
+      continue;
+    }
+    lastTagProcessedMs = now;
+    LOGI("Card UID: %s", uidFormat(uid, hex, sizeof(hex)));
+
+    if (CALIBRATION_TAG.len && uid.key() == CALIBRATION_TAG) {
+      CalibCommand here = {};
+      here.here = true;
+      here.offset = here.home = here.extra = -1;
+      applyCalibration(activeModuleIndex, here);
+      continue;
+    }
 
-      // If same as currently active UID, ignore (per your request)
-      if (currentActiveUid.length() && uid == currentActiveUid) {
-        Serial.println("Same tag as current active module — no change.");
+    // If same as currently active UID, ignore (per your request)
+    if (!currentActiveUid.empty() && uid == currentActiveUid) {
+      LOGI("Same tag as current active module — no change.");
+    } else {
+      int idx = findModuleIndexByUid(uid);
+      if (idx >= 0) {
+        // found a module for this tag
+        activateModuleByIndex(idx, uid);
       } else {
-        int idx = findModuleIndexByUid(uid);
-        if (idx >= 0) {
-          // found a module for this tag
-          activateModuleByIndex(idx, uid);
-        } else {
-          // unknown tag — deactivate current module
-          Serial.println("Unknown UID — no module mapped.");
-          deactivateActiveModule();
-        }
+        // unknown tag — deactivate current module
+        LOGI("Unknown UID — no module mapped.");
+        deactivateActiveModule();
       }
     }
   }
+}
+
+// calibration commands queued by the MQTT handler; pending changes go to NVS once settled
+void handleCalibration() {
+  CalibCommand cmd;
+  while (calib_nextCommand(cmd)) {
+    applyCalibration(cmd.module[0] ? findModuleIndexByName(cmd.module) : activeModuleIndex, cmd);
+  }
+  calib_flush(millis());
+}
+
+// one render/control frame (timed as a whole for perf)
+void runFrame() {
+  PERF_SCOPE(PERF_FRAME);
+
+  handleTagEvents();
+  handleCalibration();
 
   // run active module loop if any
   if (activeModuleIndex >= 0) {
-    if (modules[activeModuleIndex].loop) modules[activeModuleIndex].loop();
+    PERF_SCOPE(perfModuleSlot(Modules::id(activeModuleIndex)));
+    Modules::loop(activeModuleIndex);
   }
+}
 
-  delay(1);
+// ---- main loop (render/control task) ----
+void loop() {
+  runFrame();
+  tasks_endFrame();
 }
\ No newline at end of file
@@ -2,8 +2,18 @@
 // Simple spinner module for a 4-person family ("Mum","Dad","Maddison","Maddie")
 // Mirrors the style of your module_friend implementation.
 
+#include "build_profile.h"
+#if SPINNER_WITH_AFAMILY
+
 #include "module_afamily.h"
 #include "shared.h"
+#include "encoder.h"
+#include "slice_quantizer.h"
+#include "calibration.h"
+
+#define LOGGER_TAG "afamily"
+#define LOGGER_LEVEL LOG_LEVEL_INFO  // LOG_LEVEL_DEBUG for per-publish traces
+#include "logger.h"
 
 // Fonts used by the display — if you don't have these swap to fonts you do have
 #include <Fonts/Rabito_font34pt7b.h>
@@ -14,8 +24,8 @@ namespace {
 
 // Debug & calibration
 const bool DEBUG_RAW = false;
-const uint16_t RAW_OFFSET = 2019;  // calibrate to your home marker (adjust as needed)
-const uint8_t HOME_SLICE = 0;      // which slice corresponds to index 0 (adjust to wheel position)
+uint16_t RAW_OFFSET = 2019;  // home marker default; a stored calibration overrides it
+uint8_t HOME_SLICE = 0;      // which slice corresponds to index 0 (adjust to wheel position)
 
 // family names & mapping
 const char* family[] = { "Mum", "Dad", "Maddison", "Maddie" };
@@ -43,10 +53,21 @@ const char* pubTopic = "spinner/afamily";
 
 // state
 int lastIdx = -1;
+SliceQuantizer slicer = sliceQuantizer(SLICE_COUNT, RAW_OFFSET);
 bool enabled = true;
 
 } // namespace
 
+// stored calibration (calibration.h) over the defaults above
+static void applyCalibration() {
+  ModuleCalibration c;
+  if (!calib_get(MOD_AFAMILY, c)) return;
+  RAW_OFFSET = c.rawOffset;
+  HOME_SLICE = c.homeSlice % SLICE_COUNT;
+  slicer.offset = RAW_OFFSET;
+  slice_reset(slicer);
+}
+
 
 // helper: draw centered name
 static void updateDisplay(int idx) {
@@ -63,7 +84,7 @@ static void updateDisplay(int idx) {
   int16_t cy = (SCREEN_H - (int)h) / 2 - y1;
   display.setCursor(cx, cy);
   display.print(name);
-  display.display();
+  displayFlush();
 }
 
 
@@ -78,22 +99,25 @@ bool module_afamily_isEnabled() {
 
 void module_afamily_setup() {
   lastIdx = -1;
+  calib_load(MOD_AFAMILY, { RAW_OFFSET, HOME_SLICE, 0 });
+  applyCalibration();
   // ensure LED safe state
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   // clear display
   display.clearDisplay();
-  display.display();
+  displayFlush();
   Serial.println("module_afamily: setup done");
 }
 
 void module_afamily_activate() {
   lastIdx = -1; // force a redraw on first loop
+  applyCalibration();  // picks up runtime recalibration
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   Serial.println("module_afamily: activated");
 }
@@ -101,7 +125,7 @@ void module_afamily_activate() {
 void module_afamily_deactivate() {
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   Serial.println("module_afamily: deactivated");
 }
@@ -109,19 +133,14 @@ void module_afamily_deactivate() {
 void module_afamily_loop() {
   if (!enabled) return;
 
-  // keep MQTT alive
-  mqttClient.loop();
-
   // 1) read raw angle
-  uint16_t raw = as5600.readAngle();
+  uint16_t raw = encoder_read().raw;
 
   // 2) apply calibration offset & wrap
-  int32_t shifted = int32_t(raw) - RAW_OFFSET;
-  if (shifted < 0) shifted += 4096;
-  else if (shifted >= 4096) shifted -= 4096;
+  int32_t shifted = encoderPhase(raw, RAW_OFFSET);
 
   // 3) compute slice 0 … SLICE_COUNT-1
-  uint8_t slice = (shifted * SLICE_COUNT) / 4096;
+  uint8_t slice = slice_update(slicer, raw, millis());
 
   // 4) map slice -> family index (accounting for HOME_SLICE)
   uint8_t idx = (slice + SLICE_COUNT - HOME_SLICE) % SLICE_COUNT;
@@ -137,7 +156,7 @@ void module_afamily_loop() {
     // update LED
     if (leds && NUM_PIXELS > 0) {
       leds[0] = familyColors[idx];
-      FastLED.show();
+      ledShow();
     }
 
     // update display
@@ -146,14 +165,13 @@ void module_afamily_loop() {
     // publish JSON payload
     char payload[64];
     snprintf(payload, sizeof(payload), "{\"name\":\"%s\"}", family[idx]);
-    if (mqttClient.connected()) {
-      mqttClient.publish(pubTopic, payload);
-      Serial.print("MQTT ▶ ");
-      Serial.println(payload);
+    if (mqttIsConnected()) {
+      publishJson(pubTopic, payload);
+      LOGD("published name=%s", family[idx]);
     } else {
-      if (DEBUG_RAW) Serial.println("MQTT publish skipped — not connected");
+      LOGD("mqtt not connected; publish skipped");
     }
   }
+}
 
-  delay(20); // small sleep to avoid hammering CPU
-}
\ No newline at end of file
+#endif // SPINNER_WITH_AFAMILY
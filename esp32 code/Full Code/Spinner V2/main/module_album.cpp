@@ -1,101 +1,169 @@
 // module_album.cpp - Fixed increment version with rainbow LED
+#include "build_profile.h"
+#if SPINNER_WITH_ALBUM
+
 #include "module_album.h"
 #include "shared.h"
+#include "encoder.h"
+#include "fling.h"
+#include "tags.h"
+#include "mqtt_router.h"
+
+#define LOGGER_TAG "album"
+#define LOGGER_LEVEL LOG_LEVEL_INFO  // LOG_LEVEL_DEBUG for per-photo / per-step traces
+#include "logger.h"
 
 #include <Arduino.h>
 #include <AS5600.h>
 #include <FastLED.h>
 #include <Adafruit_SSD1306.h>
 #include <ArduinoJson.h>
+#include <atomic>
 
 // Fonts for display
 #include <Fonts/FreeSansBold12pt7b.h>
 #include <Fonts/FreeSans9pt7b.h>
 
-extern String currentActiveUid;
-extern PubSubClient mqttClient;
+extern Uid currentActiveUid;
 extern AS5600 as5600;
 extern CRGB* leds;
 extern Adafruit_SSD1306 display;
 
 namespace {
 
-static const bool DEBUG = true;
 const char* DEFAULT_ALBUM = "at3k2ggmwen1awna";
 
-struct TagToAlbum { const char* tagUid; const char* albumId; };
-
-TagToAlbum tagToAlbumMap[] = {
-  { "C1A18949", "at3k2ggmwen1awna" },
-  { "41AF8949", "at3k2guo8gcj8w5m" },
-  { "F16B8949", "otheralbum" },
-};
-const int TAG_TO_ALBUM_COUNT = sizeof(tagToAlbumMap)/sizeof(tagToAlbumMap[0]);
-
-uint16_t RAW_OFFSET = 0;
 const unsigned long PUBLISH_DEBOUNCE_MS = 200;
 
-// Fixed rotation approach: every N encoder positions = 1 photo change
+// Send the absolute index the wheel has reached ({"cmd":"goto"}) instead of relative
+// next/prev steps. A successful publishJson() only means the command was queued; the net
+// task can still drop it (connection lost before it drains, client write failed). A goto
+// carries the whole position, so the next one repairs a dropped one; with next/prev the
+// dropped steps are gone. Relative steps are used until the server has reported an index.
+const bool NAV_USE_GOTO = true;
+// the server's index is adopted only when no nav command went out for this long (a reply to an
+// older command must not pull the target back)
+const unsigned long NAV_SETTLE_MS = 1000;
+
+// Scrub mode: the wheel's unwrapped position maps straight to an album index, anchored on the
+// photo shown when the album came up. One revolution covers SCRUB_REV_PERCENT of the album
+// (never less than SCRUB_MIN_COUNTS counts per photo). Only the latest index is sent, at most
+// every SCRUB_PUBLISH_MS, so a lost message is repaired by the next one. Replaces momentum.
+const bool SCRUB_MODE = false;
+const int32_t SCRUB_REV_PERCENT = 25;
+const int32_t SCRUB_MIN_COUNTS = 64;
+const unsigned long SCRUB_PUBLISH_MS = 100;
+
+// Slow turns: every N encoder positions = 1 photo change. Faster turns go further and a flick
+// keeps coasting (fling.h).
 const int POSITIONS_PER_PHOTO = 600;
+const FlingConfig FLING = {
+  POSITIONS_PER_PHOTO,
+  2048,  // boostVelocity (counts/s, 0.5 rev/s): 1:1 below, proportional gain above
+  8,     // maxGain
+  4096,  // coastVelocity (1 rev/s): a flick at least this fast leaves momentum
+  512,   // stopVelocity: coasting ends below this
+  400,   // decayMs: momentum time constant
+  128,   // minConfidence of the encoder estimate
+};
 
 // Rainbow cycle for LED
 uint8_t rainbowHue = 0;  // 0-255, cycles through full spectrum
-
-bool active = false;
-int lastRawPosition = -1;
-int accumulatedDelta = 0;
+const unsigned long LED_DIM_MS = 100;  // dim pulse on each new photo
+unsigned long ledDimUntilMs = 0;       // 0 = LED at steady brightness
+
+std::atomic<bool> active{false};  // written by the render task, read by onPhoto() on the net task
+bool haveBaseline = false;  // lastCount is valid
+int64_t lastCount = 0;
+unsigned long lastFrameMs = 0;
+Fling fling = makeFling(FLING);
 int totalPhotos = 0;
 String activeAlbumId;
 String navTopic;
 String photoTopic;
 unsigned long lastPublishMs = 0;
+int pendingSteps = 0;       // moved but not yet published (coalesced over the debounce window)
+bool haveIndex = false;     // targetIndex is known
+int32_t targetIndex = 0;    // photo the wheel points at, as far as the device knows
+uint32_t seenSession = 0;  // broker session our last GET went out on
+
+// scrub mode (SCRUB_MODE)
+bool scrubAnchored = false;
+int64_t scrubAnchorCount = 0;   // encoder count that maps to scrubAnchorIndex
+int32_t scrubAnchorIndex = 0;
+int32_t scrubCountsPerPhoto = 0;
+int32_t scrubSent = -1;         // last index published, -1 = resend
+
+// Photo info parsed on the net task, picked up by loop(). One slot, latest wins.
+struct PhotoUpdate {
+  char albumId[24];
+  int index;
+  int photosCount;
+  char date[32];
+  char age[32];
+};
+QueueHandle_t photoBox = nullptr;
 
-const char* albumForTag(const String &tagUid) {
-  if (!tagUid.length()) return DEFAULT_ALBUM;
-  for (int i = 0; i < TAG_TO_ALBUM_COUNT; ++i) {
-    if (tagUid.equalsIgnoreCase(String(tagToAlbumMap[i].tagUid))) {
-      return tagToAlbumMap[i].albumId;
-    }
-  }
-  return DEFAULT_ALBUM;
+// album ids live next to the tag UIDs in tags.h
+const char* albumForTag(const Uid &tagUid) {
+  const TagEntry* tag = tagLookup(tagUid.key());
+  return (tag && tag->album) ? tag->album : DEFAULT_ALBUM;
 }
 
 static void buildTopicsForAlbum(const char* albumId) {
   navTopic = String("spinner/album/") + String(albumId) + "/nav";
   photoTopic = String("spinner/album/") + String(albumId) + "/photo";
-  
-  if (DEBUG) {
-    Serial.print("module_album: navTopic -> "); Serial.println(navTopic);
-    Serial.print("module_album: photoTopic -> "); Serial.println(photoTopic);
-  }
+  LOGD("navTopic -> %s", navTopic);
+  LOGD("photoTopic -> %s", photoTopic);
 }
 
 static void publishGet() {
-  if (!mqttClient.connected()) {
-    if (DEBUG) Serial.println("module_album: mqtt not connected");
+  if (!mqttIsConnected()) {
+    LOGD("mqtt not connected");
     return;
   }
   const char* payload = "{\"cmd\":\"get\"}";
-  mqttClient.publish(navTopic.c_str(), payload);
-  if (DEBUG) Serial.println("module_album: published GET");
+  publishJson(navTopic.c_str(), payload);
+  LOGD("published GET");
 }
 
-static void publishNavDelta(int delta) {
-  if (!mqttClient.connected()) {
-    if (DEBUG) Serial.println("module_album: mqtt not connected");
-    return;
+static int32_t wrapIndex(int64_t index) {
+  if (totalPhotos <= 0) return int32_t(index);
+  return int32_t(((index % totalPhotos) + totalPhotos) % totalPhotos);
+}
+
+static bool publishGoto(int32_t index) {
+  if (!mqttIsConnected()) {
+    LOGD("mqtt not connected");
+    return false;
+  }
+  char payload[64];
+  snprintf(payload, sizeof(payload), "{\"cmd\":\"goto\",\"index\":%ld}", (long)index);
+  if (!publishJson(navTopic.c_str(), payload)) return false;
+  LOGD("published goto %ld", (long)index);
+  return true;
+}
+
+// Publish `delta` photos of movement; false (keep it pending) when offline or the queue is full.
+static bool publishNav(int delta) {
+  if (NAV_USE_GOTO && haveIndex) {
+    int32_t index = wrapIndex(int64_t(targetIndex) + delta);
+    if (!publishGoto(index)) return false;
+    targetIndex = index;
+    return true;
   }
+  if (!mqttIsConnected()) {
+    LOGD("mqtt not connected");
+    return false;
+  }
+  char payload[128];
   const char* cmd = delta > 0 ? "next" : "prev";
   int steps = abs(delta);
-  char payload[128];
   snprintf(payload, sizeof(payload), "{\"cmd\":\"%s\",\"steps\":%d}", cmd, steps);
-  mqttClient.publish(navTopic.c_str(), payload);
-  if (DEBUG) {
-    Serial.print("module_album: published ");
-    Serial.print(cmd);
-    Serial.print(" steps=");
-    Serial.println(steps);
-  }
+  if (!publishJson(navTopic.c_str(), payload)) return false;
+  targetIndex += delta;
+  LOGD("published %s steps=%d", cmd, steps);
+  return true;
 }
 
 static void updateDisplay(const char* age, const char* date) {
@@ -125,196 +193,222 @@ static void updateDisplay(const char* age, const char* date) {
     display.print(date);
   }
 
-  display.display();
-  
-  if (DEBUG) {
-    Serial.print("Display updated: age=");
-    Serial.print(ageText);
-    Serial.print(" date=");
-    Serial.println(date);
+  displayFlush();
+  LOGD("display updated: age=%s date=%s", ageText, date);
+}
+
+static void copyField(char* dst, size_t dstLen, const char* src) {
+  strncpy(dst, src, dstLen - 1);
+  dst[dstLen - 1] = '\0';
+}
+
+// spinner/album/+/photo. Runs on the net task: parse straight out of the MQTT buffer and
+// post the result; drawing happens in loop().
+static void onPhoto(const MqttMessage& msg, void*) {
+  if (!active) return;
+
+  size_t idLen = 0;
+  const char* id = mqtt_topicLevel(msg.topic, 2, &idLen);
+  if (!id || idLen >= sizeof(PhotoUpdate::albumId)) return;
+
+  StaticJsonDocument<512> doc;
+  DeserializationError err = deserializeJson(doc, (const char*)msg.payload, msg.length);
+  if (err) {
+    LOGW("JSON error: %s", err.c_str());
+    return;
+  }
+  if (!doc.containsKey("index")) return;
+
+  PhotoUpdate u;
+  memcpy(u.albumId, id, idLen);
+  u.albumId[idLen] = '\0';
+  u.index = doc["index"] | 0;
+  u.photosCount = doc["photosCount"] | 0;
+  copyField(u.date, sizeof(u.date), doc["date"] | "");
+  copyField(u.age, sizeof(u.age), doc["age"] | "");
+  xQueueOverwrite(photoBox, &u);
+}
+
+static void showPhoto(const PhotoUpdate& u) {
+  if (SCRUB_MODE) {
+    // a new album size changes the mapping: re-anchor on this photo
+    if (u.photosCount != totalPhotos) scrubAnchored = false;
+    // the server shows something else than we last asked for (lost or stale goto): ask again
+    else if (scrubAnchored && u.index != scrubSent) scrubSent = -1;
+  }
+  totalPhotos = u.photosCount;
+  if (pendingSteps == 0 && millis() - lastPublishMs >= NAV_SETTLE_MS) {
+    targetIndex = u.index;
+    haveIndex = true;
+  }
+
+  if (totalPhotos > 0) LOGD("album has %d photos", totalPhotos);
+
+  updateDisplay(u.age, u.date);
+
+  // Advance to next rainbow color and show with subtle dim effect
+  if (leds && NUM_PIXELS > 0) {
+    rainbowHue += 8;  // Move 8 steps through color wheel per photo
+
+    leds[0] = CHSV(rainbowHue, 255, 80);  // Dim briefly (loop() restores it)
+    ledShow();
+    ledDimUntilMs = millis() + LED_DIM_MS;
+  }
+}
+
+// Scrub mode, every frame: wheel position -> index, latest index out at most every
+// SCRUB_PUBLISH_MS.
+static void scrubLoop(int64_t count, unsigned long now) {
+  if (!haveIndex || totalPhotos <= 0) return;  // nothing to anchor on yet
+  if (!scrubAnchored) {
+    int32_t perRev = int32_t(int64_t(totalPhotos) * SCRUB_REV_PERCENT / 100);
+    scrubCountsPerPhoto = perRev > 0 ? 4096 / perRev : 4096;
+    if (scrubCountsPerPhoto < SCRUB_MIN_COUNTS) scrubCountsPerPhoto = SCRUB_MIN_COUNTS;
+    scrubAnchorCount = count;
+    scrubAnchorIndex = targetIndex;
+    scrubSent = targetIndex;
+    scrubAnchored = true;
+    LOGD("scrub anchor: index %ld, %ld counts/photo", (long)scrubAnchorIndex, (long)scrubCountsPerPhoto);
+  }
+
+  // floor division, so the photo boundaries sit at the same wheel positions in both directions
+  int64_t moved = count - scrubAnchorCount;
+  int64_t photos = moved >= 0 ? moved / scrubCountsPerPhoto : -((-moved + scrubCountsPerPhoto - 1) / scrubCountsPerPhoto);
+  int32_t index = wrapIndex(scrubAnchorIndex + photos);
+  if (index == scrubSent || now - lastPublishMs < SCRUB_PUBLISH_MS) return;
+  if (publishGoto(index)) {
+    scrubSent = index;
+    targetIndex = index;
+    lastPublishMs = now;
   }
 }
 
 } // namespace
 
 void module_album_setup() {
-  lastRawPosition = -1;
-  accumulatedDelta = 0;
+  haveBaseline = false;
+  fling_reset(fling);
   active = false;
   totalPhotos = 0;
   rainbowHue = 0;
   activeAlbumId = String(DEFAULT_ALBUM);
   buildTopicsForAlbum(activeAlbumId.c_str());
-  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; FastLED.show(); }
-  display.clearDisplay(); display.display();
-  if (DEBUG) Serial.println("module_album: setup complete");
+  if (!photoBox) photoBox = xQueueCreate(1, sizeof(PhotoUpdate));
+  mqtt_route("spinner/album/+/photo", onPhoto);
+  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; ledShow(); }
+  display.clearDisplay(); displayFlush();
+  LOGD("setup complete");
 }
 
 void module_album_activate() {
-  extern void mqttDispatch(char* topic, byte* payload, unsigned int length);
-  mqttClient.setCallback(mqttDispatch);
-  
   const char* chosen = albumForTag(currentActiveUid);
   activeAlbumId = String(chosen);
   buildTopicsForAlbum(chosen);
 
-  lastRawPosition = -1;
-  accumulatedDelta = 0;
+  haveBaseline = false;
+  fling_reset(fling);
+  // a reply that slipped past onPhoto()'s check before the last deactivate() may still have
+  // landed in the box: start empty, then let the net task post again
+  xQueueReset(photoBox);
   active = true;
   lastPublishMs = 0;
+  pendingSteps = 0;
+  haveIndex = false;
+  scrubAnchored = false;
   totalPhotos = 0;
   rainbowHue = 0;  // Start rainbow from red
+  ledDimUntilMs = 0;
 
-  if (mqttClient.connected()) {
-    bool ok = mqttClient.subscribe(photoTopic.c_str(), 0);
-    if (DEBUG) {
-      Serial.print("module_album: subscribe photo ");
-      Serial.println(ok ? "OK" : "FAIL");
-    }
-  }
+  // the connection manager keeps this subscription across reconnects
+  bool ok = mqttSubscribe(MOD_ALBUM, photoTopic.c_str());
+  if (!ok) LOGW("subscribe %s failed", photoTopic);
 
-  if (DEBUG) Serial.println("module_album: sending GET...");
+  LOGD("sending GET...");
+  seenSession = mqttSession();
   publishGet();
 
   // Set LED to initial rainbow color (red)
   if (leds && NUM_PIXELS > 0) { 
     leds[0] = CHSV(rainbowHue, 255, 150);
-    FastLED.show(); 
-  }
-  
-  if (DEBUG) {
-    Serial.print("module_album: activated album=");
-    Serial.println(activeAlbumId);
+    ledShow(); 
   }
+  LOGI("activated album=%s", activeAlbumId);
 }
 
 void module_album_deactivate() {
-  if (mqttClient.connected()) {
-    mqttClient.unsubscribe(photoTopic.c_str());
-    if (DEBUG) Serial.println("module_album: unsubscribed");
-  }
+  mqttUnsubscribe(MOD_ALBUM, photoTopic.c_str());
+  LOGD("unsubscribed");
   active = false;
+  xQueueReset(photoBox);
   totalPhotos = 0;
-  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; FastLED.show(); }
+  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; ledShow(); }
   display.clearDisplay();
-  display.display();
-  if (DEBUG) Serial.println("module_album: deactivated");
+  displayFlush();
+  LOGD("deactivated");
 }
 
-void module_album_onMqtt(const char* topic, const char* payload) {
+void module_album_loop() {
   if (!active) return;
 
-  if (DEBUG) {
-    Serial.print("module_album: MQTT -> ");
-    Serial.println(topic);
+  // new broker session (subscriptions already restored): ask for the current photo again
+  if (mqttIsConnected() && mqttSession() != seenSession) {
+    seenSession = mqttSession();
+    publishGet();
   }
 
-  StaticJsonDocument<512> doc;
-  DeserializationError err = deserializeJson(doc, payload);
-  if (err) {
-    if (DEBUG) {
-      Serial.print("module_album: JSON error: ");
-      Serial.println(err.f_str());
-    }
-    return;
-  }
-
-  if (doc.containsKey("index")) {
-    int idx = doc["index"] | 0;
-    int photosCount = doc["photosCount"] | 0;
-    const char* date = doc["date"] | "";
-    const char* age = doc["age"] | "";
-    
-    totalPhotos = photosCount;
-    
-    if (DEBUG && totalPhotos > 0) {
-      Serial.print("module_album: album has ");
-      Serial.print(totalPhotos);
-      Serial.println(" photos");
-    }
-    
-    updateDisplay(age, date);
-    
-    // Advance to next rainbow color and show with subtle dim effect
+  // end of the new-photo dim pulse
+  if (ledDimUntilMs && (long)(millis() - ledDimUntilMs) >= 0) {
+    ledDimUntilMs = 0;
     if (leds && NUM_PIXELS > 0) {
-      rainbowHue += 8;  // Move 8 steps through color wheel per photo
-      
-      leds[0] = CHSV(rainbowHue, 255, 80);  // Dim briefly
-      FastLED.show();
-      delay(100);
-      
       leds[0] = CHSV(rainbowHue, 255, 150);  // Return to steady brightness
-      FastLED.show();
+      ledShow();
     }
   }
-}
 
-void module_album_loop() {
-  if (!active) return;
+  // latest photo from the broker (a late reply for the previous album is dropped)
+  PhotoUpdate update;
+  if (xQueueReceive(photoBox, &update, 0) == pdTRUE && activeAlbumId == update.albumId) {
+    LOGD("photo for %s", update.albumId);
+    showPhoto(update);
+  }
 
-  // Read raw encoder position (0-4095)
-  uint16_t raw = as5600.readAngle();
-  int32_t shifted = int32_t(raw) - int32_t(RAW_OFFSET);
-  if (shifted < 0) shifted += 4096;
-  else if (shifted >= 4096) shifted -= 4096;
+  // Unwrapped encoder position (multi-turn, no wrap handling needed) + motion estimate
+  EncoderState enc = encoder_read();
+  unsigned long now = millis();
 
   // First read - establish baseline
-  if (lastRawPosition == -1) {
-    lastRawPosition = shifted;
-    if (DEBUG) {
-      Serial.print("module_album: encoder baseline: ");
-      Serial.println(shifted);
-    }
+  if (!haveBaseline) {
+    haveBaseline = true;
+    lastCount = enc.count;
+    lastFrameMs = now;
+    LOGD("encoder baseline: %lld", (long long)enc.count);
     return;
   }
 
-  // Calculate how much the encoder has moved
-  int rawDelta = shifted - lastRawPosition;
-  
-  // Handle wraparound (going from 4095 to 0 or vice versa)
-  if (rawDelta > 2048) rawDelta -= 4096;
-  else if (rawDelta < -2048) rawDelta += 4096;
-
-  // If encoder hasn't moved, nothing to do
-  if (rawDelta == 0) {
-    delay(10);
+  if (SCRUB_MODE) {
+    scrubLoop(enc.count, now);
     return;
   }
 
-  // Accumulate the movement
-  accumulatedDelta += rawDelta;
-  lastRawPosition = shifted;
-
-  // Check if we've accumulated enough movement for a photo change
-  int photosToMove = 0;
-  
-  if (accumulatedDelta >= POSITIONS_PER_PHOTO) {
-    photosToMove = accumulatedDelta / POSITIONS_PER_PHOTO;
-    accumulatedDelta = accumulatedDelta % POSITIONS_PER_PHOTO;
-  } else if (accumulatedDelta <= -POSITIONS_PER_PHOTO) {
-    photosToMove = accumulatedDelta / POSITIONS_PER_PHOTO;
-    accumulatedDelta = accumulatedDelta % POSITIONS_PER_PHOTO;
+  // Movement since the last frame; with momentum the list can keep moving while the wheel
+  // stands still, so this runs every frame
+  int rawDelta = int(enc.count - lastCount);
+  lastCount = enc.count;
+  uint32_t dtMs = now - lastFrameMs;
+  lastFrameMs = now;
+  if (rawDelta != 0 || fling_isCoasting(fling)) {
+    pendingSteps += fling_update(fling, rawDelta, enc.velocity, enc.confidence, dtMs);
   }
 
-  // If we've crossed the threshold, publish the navigation command
-  if (photosToMove != 0) {
-    unsigned long now = millis();
-    if (now - lastPublishMs >= PUBLISH_DEBOUNCE_MS) {
-      if (photosToMove > 0) {
-        publishNavDelta(photosToMove);
-      } else {
-        publishNavDelta(photosToMove);
-      }
-      lastPublishMs = now;
-      
-      if (DEBUG) {
-        Serial.print("module_album: moved ");
-        Serial.print(photosToMove);
-        Serial.print(" photo(s), accumulated remainder: ");
-        Serial.println(accumulatedDelta);
-      }
-    }
+  // Everything moved during the debounce window goes out as one command; it stays pending
+  // while offline or while the outbound queue is full (see NAV_USE_GOTO for what happens
+  // after it is queued).
+  if (pendingSteps != 0 && now - lastPublishMs >= PUBLISH_DEBOUNCE_MS && publishNav(pendingSteps)) {
+    LOGD("moved %d photo(s), vel=%ld%s", pendingSteps, (long)enc.velocity,
+         fling_isCoasting(fling) ? " (coasting)" : "");
+    pendingSteps = 0;
+    lastPublishMs = now;
   }
+}
 
-  delay(10);
-}
\ No newline at end of file
+#endif // SPINNER_WITH_ALBUM
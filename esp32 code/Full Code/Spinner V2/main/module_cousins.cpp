@@ -1,6 +1,16 @@
 // module_cousins.cpp
+#include "build_profile.h"
+#if SPINNER_WITH_COUSINS
+
 #include "module_cousins.h"
 #include "shared.h"
+#include "encoder.h"
+#include "slice_quantizer.h"
+#include "calibration.h"
+
+#define LOGGER_TAG "cousins"
+#define LOGGER_LEVEL LOG_LEVEL_INFO  // LOG_LEVEL_DEBUG for per-publish traces
+#include "logger.h"
 
 // Fonts used by the display — match your friend module's choices
 #include <Fonts/Rabito_font30pt7b.h>  // large
@@ -15,8 +25,9 @@ namespace {
   // Calibrate these to fit your wheel's physical alignment.
   // RAW_OFFSET is the AS5600 raw value that corresponds to your "home" position.
   // HOME_SLICE is the slice index that should map to cousin index 0.
-  const uint16_t RAW_OFFSET = 2019;  // tweak for your wheel
-  const uint8_t HOME_SLICE = 0;
+  // These are defaults: a stored calibration (calibration.h) overrides them.
+  uint16_t RAW_OFFSET = 2019;  // tweak for your wheel
+  uint8_t HOME_SLICE = 0;
 
   // Cousin list (4 cousins). Change names as needed.
   const char* cousins[] = {
@@ -50,6 +61,17 @@ namespace {
 
   // module-local state
   int lastIdx = -1;
+  SliceQuantizer slicer = sliceQuantizer(SLICE_COUNT, RAW_OFFSET);
+}
+
+// stored calibration (calibration.h) over the defaults above
+static void applyCalibration() {
+  ModuleCalibration c;
+  if (!calib_get(MOD_COUSINS, c)) return;
+  RAW_OFFSET = c.rawOffset;
+  HOME_SLICE = c.homeSlice % SLICE_COUNT;
+  slicer.offset = RAW_OFFSET;
+  slice_reset(slicer);
 }
 
 // ----- helper: render centered name for given cousin index -----
@@ -68,22 +90,24 @@ static void updateDisplayForCousin(int idx) {
   int16_t cy = (SCREEN_H - h) / 2 - y1;
   display.setCursor(cx, cy);
   display.print(name);
-  display.display();
+  displayFlush();
 }
 
 // ----- Module API -----
 void module_cousins_setup() {
   lastIdx = -1;
+  calib_load(MOD_COUSINS, { RAW_OFFSET, HOME_SLICE, 0 });
+  applyCalibration();
 
   // set LED safe state
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
 
   // clear display
   display.clearDisplay();
-  display.display();
+  displayFlush();
 
   Serial.println("module_cousins: setup done");
 }
@@ -91,9 +115,10 @@ void module_cousins_setup() {
 void module_cousins_activate() {
   // force a redraw on first loop
   lastIdx = -1;
+  applyCalibration();  // picks up runtime recalibration
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   Serial.println("module_cousins: activated");
 }
@@ -102,25 +127,20 @@ void module_cousins_deactivate() {
   // tidy up hardware state when switching away
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   Serial.println("module_cousins: deactivated");
 }
 
 void module_cousins_loop() {
-  // keep mqtt alive (main loop handles reconnects)
-  mqttClient.loop();
-
   // 1) read raw angle from shared AS5600
-  uint16_t raw = as5600.readAngle();
+  uint16_t raw = encoder_read().raw;
 
   // 2) apply calibration offset & wrap
-  int32_t shifted = int32_t(raw) - RAW_OFFSET;
-  if (shifted < 0) shifted += 4096;
-  else if (shifted >= 4096) shifted -= 4096;
+  int32_t shifted = encoderPhase(raw, RAW_OFFSET);
 
   // 3) compute slice 0…(SLICE_COUNT-1)
-  uint8_t slice = (shifted * SLICE_COUNT) / 4096;
+  uint8_t slice = slice_update(slicer, raw, millis());
 
   // 4) map slice → cousin index (0..numCousins-1)
   uint8_t idx = (slice + SLICE_COUNT - HOME_SLICE) % SLICE_COUNT;
@@ -141,7 +161,7 @@ void module_cousins_loop() {
         leds[0] = cousinColors[idx];
       else
         leds[0] = CRGB::White;
-      FastLED.show();
+      ledShow();
     }
 
     // display
@@ -150,14 +170,13 @@ void module_cousins_loop() {
     // publish JSON payload
     char payload[64];
     snprintf(payload, sizeof(payload), "{\"name\":\"%s\",\"relation\":\"cousin\"}", cousins[idx]);
-    if (mqttClient.connected()) {
-      mqttClient.publish(pubTopic, payload);
-      Serial.print("MQTT ▶ ");
-      Serial.println(payload);
+    if (mqttIsConnected()) {
+      publishJson(pubTopic, payload);
+      LOGD("published name=%s", cousins[idx]);
     } else {
-      if (DEBUG_RAW) Serial.println("module_cousins: mqtt not connected; publish skipped");
+      LOGD("mqtt not connected; publish skipped");
     }
   }
+}
 
-  delay(20); // small delay to avoid busy-loop
-}
\ No newline at end of file
+#endif // SPINNER_WITH_COUSINS
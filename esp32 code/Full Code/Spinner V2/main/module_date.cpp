@@ -6,16 +6,26 @@
 //   AS5600 as5600;
 //   Adafruit_SSD1306 display;
 //   CRGB *leds; (or CRGB leds[] / NUM_PIXELS)
-//   PubSubClient mqttClient;
+//   publishJson() (queued to the net task)
 //   constants: SCREEN_W, SCREEN_H, NUM_PIXELS
 //
 // Serial commands available while module active:
-//   c    -> calibrate RAW_OFFSET to current raw reading
+//   c    -> calibrate RAW_OFFSET to current raw reading (saved to NVS, see calibration.h)
 //   p    -> print diagnostic
 //   (Other future tuning available by changing constants below)
 
+#include "build_profile.h"
+#if SPINNER_WITH_DATE
+
 #include "module_date.h"
 #include "shared.h"
+#include "encoder.h"
+#include "slice_quantizer.h"
+#include "calibration.h"
+
+#define LOGGER_TAG "date"
+#define LOGGER_LEVEL LOG_LEVEL_INFO  // LOG_LEVEL_DEBUG for per-publish traces
+#include "logger.h"
 
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
@@ -33,8 +43,8 @@ namespace {
 bool ENABLE_FUTURE = true;           // runtime toggle via module_date_enable()
 
 const bool DEBUG_RAW = false;         // set true for serial diagnostics
-uint16_t RAW_OFFSET = 2071;           // calibrate with 'c' command if needed
-const uint8_t JAN_SLICE = 0;
+uint16_t RAW_OFFSET = 2071;           // default; calibrate with 'c' command if needed
+uint8_t JAN_SLICE = 0;
 
 const int SLICE_COUNT = 12;
 const int MIN_YEAR = 2018;
@@ -46,13 +56,19 @@ const int FUTURE_STEP_YEARS = 5;
 const int FUTURE_MAX_OFFSET = 20;
 const int FUTURE_MIN_OFFSET = 5;
 const int FUTURE_STEP_COOLDOWN_MS = 300;
-const int FUTURE_SPIN_THRESHOLD = 120;      // raw delta threshold (keep)
-const int FUTURE_SPIN_DT_MAX = 250;         // max ms between samples to consider
 const int FUTURE_MAX_STEPS_PER_SPIN = 2;    // cap steps per spin
 
-// NEW: require a minimum angular *velocity* (ticks per second) as well
-// 1 tick = 360/4096 degrees ≈ 0.088 deg. For example 800 ticks/sec ≈ 70 deg/s.
-const int FUTURE_SPIN_VELOCITY = 1600;       // ticks per second
+// A spin is the encoder's estimated velocity (ticks per second), trusted only with enough
+// estimator confidence, so a jerk or a noisy frame doesn't count as one.
+// 1 tick = 360/4096 degrees ≈ 0.088 deg. 7200 ticks/sec ≈ 1.75 rev/s, each further multiple
+// of it is one more step. Picked from the sweep in test/test_spin_detect.cpp: brisk month
+// browsing (three slices at once) peaks around 6400 ticks/s, flicks of 2 rev/s and up are all
+// caught within ~95 ms. Confidence 64 rejects every single-sample glitch and knock there; 128
+// also rejects the hard ramp of a 5 rev/s flick and costs it ~40 ms.
+// The old rule (>= 120 ticks between two loop passes) depended on the pass time: ~4400
+// ticks/s with the RC522's 25 ms REQA timeout in every pass, which fired on browsing moves.
+const int FUTURE_SPIN_VELOCITY = 7200;       // ticks per second
+const uint8_t FUTURE_MIN_CONFIDENCE = 64;    // 0..255
 
 // colors for months (LED)
 const CRGB monthColors[SLICE_COUNT] = {
@@ -64,9 +80,11 @@ const CRGB monthColors[SLICE_COUNT] = {
 const char* pubTopic = "spinner/date";
 
 // module-local state
-uint16_t lastRaw = 0;
+int64_t lastCount = 0;
 uint32_t lastRawMs = 0;
+uint32_t sampleCursor = 0;  // encoder history already replayed for month tracking
 uint8_t lastMonth = 255; // sentinel
+SliceQuantizer monthSlicer = sliceQuantizer(SLICE_COUNT, RAW_OFFSET);
 int year = START_YEAR;
 int lastYearDrawn = -1;
 int lastMonthSent = -1;
@@ -79,12 +97,62 @@ int futureYear = MAX_YEAR + FUTURE_MIN_OFFSET;
 unsigned long lastFutureStepMs = 0;
 unsigned long futureEnteredMs = 0;
 
-// helper: compute signed delta between two AS5600 raw readings (-2047..+2048)
-static int32_t signedRawDelta(uint16_t prev, uint16_t now) {
-  int32_t delta = int32_t(now) - int32_t(prev);
-  if (delta > 2048) delta -= 4096;
-  else if (delta < -2048) delta += 4096;
-  return delta;
+// LED flash played out over frames: phases left (on/off alternating, current one included)
+CRGB flashColor = CRGB::Black;
+uint8_t flashPhases = 0;
+uint16_t flashOnMs = 0;
+uint16_t flashOffMs = 0;
+unsigned long flashDeadline = 0;
+
+static uint8_t monthForSlice(uint8_t slice) {
+  return ((slice - JAN_SLICE + SLICE_COUNT) % SLICE_COUNT) + 1;  // cw increases month
+}
+
+// year rollover on a Dec <-> Jan crossing
+static void trackMonth(uint8_t month) {
+  if (lastMonth != 255 && month != lastMonth) {
+    if (lastMonth == 12 && month == 1) {
+      year = min(year + 1, MAX_YEAR);
+    } else if (lastMonth == 1 && month == 12) {
+      year = max(year - 1, MIN_YEAR);
+    }
+  }
+  lastMonth = month;
+}
+
+// Start `times` on/off flashes of the LED. updateFlash() advances them each frame.
+static void startFlash(CRGB color, uint8_t times, uint16_t onMs, uint16_t offMs) {
+  if (!leds || NUM_PIXELS == 0 || times == 0) return;
+  flashColor = color;
+  flashOnMs = onMs;
+  flashOffMs = offMs;
+  flashPhases = times * 2;
+  flashDeadline = millis() + onMs;
+  leds[0] = color;
+  ledShow();
+}
+
+// True while a flash owns the LED; switches phase once its deadline has passed.
+static bool updateFlash(unsigned long now) {
+  if (flashPhases == 0) return false;
+  if (long(now - flashDeadline) < 0) return true;
+  if (--flashPhases == 0) return false;
+  bool on = (flashPhases % 2) == 0;
+  leds[0] = on ? flashColor : CRGB::Black;
+  ledShow();
+  flashDeadline = now + (on ? flashOnMs : flashOffMs);
+  return true;
+}
+
+// stored calibration (calibration.h) over the defaults above
+static void applyCalibration() {
+  ModuleCalibration c;
+  if (!calib_get(MOD_DATE, c)) return;
+  RAW_OFFSET = c.rawOffset;
+  JAN_SLICE = c.homeSlice % SLICE_COUNT;
+  monthSlicer.offset = RAW_OFFSET;
+  slice_reset(monthSlicer);
+  lastMonth = 255;
 }
 
 // Draw the real year on the shared display (normal mode)
@@ -101,7 +169,7 @@ static void drawRealYearIfNeeded() {
     display.setCursor((SCREEN_W - w)/2 - x1,
                       (SCREEN_H - h)/2 - y1);
     display.print(buf);
-    display.display();
+    displayFlush();
     display.setFont();  // restore default
   }
 }
@@ -116,8 +184,9 @@ static void handleSerialCommands(uint16_t raw, int slice, int month, int32_t sde
   if (s.length() == 0) return;
 
   if (s.equalsIgnoreCase("c")) {
-    RAW_OFFSET = raw;
-    Serial.printf("module_date: RAW_OFFSET set to %u\n", RAW_OFFSET);
+    calib_set(MOD_DATE, { raw, JAN_SLICE, 0 });
+    applyCalibration();
+    Serial.printf("module_date: RAW_OFFSET set to %u (saved)\n", RAW_OFFSET);
   } else if (s.equalsIgnoreCase("p")) {
     Serial.printf("raw=%u shifted=%ld slice=%d month=%d sdelta=%ld dt=%lu\n",
                   raw, long(int32_t(raw) - int32_t(RAW_OFFSET)), slice, month, (long)sdelta, dt);
@@ -137,12 +206,7 @@ static void enterFutureMode() {
   futureEnteredMs = millis();
 
   // simple visual "transport" animation: flash LED a few times
-  if (leds && NUM_PIXELS > 0) {
-    for (int i=0;i<3;i++) {
-      leds[0] = CRGB::White; FastLED.show(); delay(120);
-      leds[0] = CRGB::Black; FastLED.show(); delay(80);
-    }
-  }
+  startFlash(CRGB::White, 3, 120, 80);
 
   // Show the entry year using white background + BLACK text (inverted look)
   display.clearDisplay();
@@ -155,7 +219,7 @@ static void enterFutureMode() {
   display.getTextBounds(buf, 0, 0, &x1, &y1, &w, &h);
   display.setCursor((SCREEN_W - w)/2 - x1, (SCREEN_H - h)/2 - y1);
   display.print(buf);
-  display.display();
+  displayFlush();
 }
 
 // Exit future mode (restore normal display)
@@ -164,16 +228,11 @@ static void exitFutureMode() {
   inFutureMode = false;
 
   // exit LED flash
-  if (leds && NUM_PIXELS > 0) {
-    for (int i=0;i<2;i++) {
-      leds[0] = CRGB::Blue; FastLED.show(); delay(120);
-      leds[0] = CRGB::Black; FastLED.show(); delay(80);
-    }
-  }
+  startFlash(CRGB::Blue, 2, 120, 80);
 
   // clear inverted screen and force redraw in normal mode
   display.clearDisplay();
-  display.display();
+  displayFlush();
   lastYearDrawn = -1;
 }
 
@@ -196,10 +255,7 @@ static void futureAttemptStep(int direction, int steps = 1) {
   futureYear = MAX_YEAR + futureOffsetYrs;
 
   // tiny twinkle and update display (keep inverted style)
-  if (leds && NUM_PIXELS > 0) {
-    leds[0] = CRGB::White; FastLED.show(); delay(80);
-    leds[0] = CRGB::Black; FastLED.show();
-  }
+  startFlash(CRGB::White, 1, 80, 0);
 
   // draw inverted-style year
   display.clearDisplay();
@@ -212,36 +268,37 @@ static void futureAttemptStep(int direction, int steps = 1) {
   display.getTextBounds(buf, 0, 0, &x1, &y1, &w, &h);
   display.setCursor((SCREEN_W - w)/2 - x1, (SCREEN_H - h)/2 - y1);
   display.print(buf);
-  display.display();
+  displayFlush();
 }
 
-// Process fast-spin input while in future mode: allow multi-step based on spin magnitude
-static void handleFutureModeInput(int32_t signedDelta, unsigned long dt) {
-  if (dt == 0) return;
-  // too slow overall between reads is ignored
-  if (dt > FUTURE_SPIN_DT_MAX) return;
+// Spin steps in the encoder snapshot: 0 = no spin, else signed (cw > 0), one per multiple of
+// FUTURE_SPIN_VELOCITY up to FUTURE_MAX_STEPS_PER_SPIN.
+static int spinSteps(const EncoderState& enc) {
+  int32_t speed = abs(enc.velocity);
+  if (speed < FUTURE_SPIN_VELOCITY) return 0;
 
-  int magnitude = abs(signedDelta);
-  if (magnitude < FUTURE_SPIN_THRESHOLD) return;
-
-  int vel = int((uint32_t)magnitude * 1000u / (uint32_t)dt);
   if (DEBUG_RAW) {
-    Serial.printf("FUTURE step candidate: sdelta=%ld dt=%lu vel=%d\n", (long)signedDelta, dt, vel);
+    Serial.printf("FUTURE spin candidate: vel=%ld conf=%u\n", (long)enc.velocity, enc.confidence);
   }
-  if (vel < FUTURE_SPIN_VELOCITY) return;
+  if (enc.confidence < FUTURE_MIN_CONFIDENCE) return 0;
 
-  // compute steps (existing logic), cap it
-  int steps = magnitude / FUTURE_SPIN_THRESHOLD;
-  if (steps < 1) steps = 1;
+  int steps = speed / FUTURE_SPIN_VELOCITY;
   if (steps > FUTURE_MAX_STEPS_PER_SPIN) steps = FUTURE_MAX_STEPS_PER_SPIN;
+  return enc.velocity > 0 ? steps : -steps;
+}
+
+// Process fast-spin input while in future mode: allow multi-step based on spin speed
+static void handleFutureModeInput(const EncoderState& enc) {
+  int steps = spinSteps(enc);
+  if (steps == 0) return;
 
-  if (signedDelta > 0) {
+  if (steps > 0) {
     futureAttemptStep(+1, steps);
   } else {
     if (futureOffsetYrs <= FUTURE_MIN_OFFSET) {
       exitFutureMode();
     } else {
-      futureAttemptStep(-1, steps);
+      futureAttemptStep(-1, -steps);
     }
   }
 }
@@ -258,32 +315,37 @@ bool module_date_isEnabled() {
 }
 
 void module_date_setup() {
-  lastRaw = as5600.readAngle();
+  lastCount = encoder_read().count;
   lastRawMs = millis();
-  lastMonth = 255;
+  calib_load(MOD_DATE, { RAW_OFFSET, JAN_SLICE, 0 });
+  applyCalibration();
+  sampleCursor = encoder_cursor();
   year = START_YEAR;
   lastYearDrawn = -1;
   lastMonthSent = -1;
   lastYearSent = -1;
   inFutureMode = false;
+  flashPhases = 0;
 
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   display.clearDisplay();
-  display.display();
+  displayFlush();
   Serial.println("module_date: setup complete");
 }
 
 void module_date_activate() {
-  lastMonth = 255;
+  applyCalibration();  // picks up runtime recalibration
+  sampleCursor = encoder_cursor();
   year = START_YEAR;
   lastYearDrawn = -1;
   inFutureMode = false;
+  flashPhases = 0;
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   Serial.println("module_date: activated");
 }
@@ -291,32 +353,43 @@ void module_date_activate() {
 void module_date_deactivate() {
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   inFutureMode = false;
+  flashPhases = 0;
   Serial.println("module_date: deactivated");
 }
 
 void module_date_loop() {
-  // keep mqtt loop processing (main.ino handles reconnect)
-  mqttClient.loop();
-
   unsigned long now = millis();
 
-  // 1) read raw & compute timing
-  uint16_t raw = as5600.readAngle();
+  // 1) year rollover detection (month crossing). Replay every encoder sample since the last
+  //    frame: a fast spin can skip whole months between two frames, never between two samples.
+  //    Rollover follows the slice past the hysteresis band; the shown and published month is
+  //    the settled one. Sample times are mapped onto millis() by their age.
+  EncoderSample samples[32];
+  size_t n;
+  uint32_t nowUs = micros();
+  while ((n = encoder_samples(sampleCursor, samples, 32)) > 0) {
+    for (size_t i = 0; i < n; ++i) {
+      uint32_t sampleMs = now - int32_t(nowUs - samples[i].us) / 1000;
+      slice_update(monthSlicer, samples[i].raw, sampleMs);
+      trackMonth(monthForSlice(uint8_t(monthSlicer.held)));
+    }
+  }
+
+  // 2) read raw & compute timing (at least as new as the replayed samples)
+  EncoderState enc = encoder_read();
+  uint16_t raw = enc.raw;
   unsigned long dt = now - lastRawMs;
   if (dt == 0) dt = 1;
-  int32_t sdelta = signedRawDelta(lastRaw, raw);
-
-  // 2) calibrate & wrap
-  int32_t shifted = int32_t(raw) - int32_t(RAW_OFFSET);
-  if (shifted < 0) shifted += 4096;
-  else if (shifted >= 4096) shifted -= 4096;
+  int32_t sdelta = int32_t(enc.count - lastCount);  // unwrapped: exact even after a slow frame
 
-  // 3) compute slice & month (forward mapping: cw increases month)
-  uint8_t slice = (shifted * SLICE_COUNT) / 4096;
-  uint8_t month = ((slice - JAN_SLICE + SLICE_COUNT) % SLICE_COUNT) + 1;
+  // 3) calibrate & wrap, settled slice & month (forward mapping: cw increases month)
+  int32_t shifted = encoderPhase(raw, RAW_OFFSET);
+  uint8_t slice = slice_update(monthSlicer, raw, now);
+  trackMonth(monthForSlice(uint8_t(monthSlicer.held)));
+  uint8_t month = monthForSlice(slice);
 
   // debug print
   if (DEBUG_RAW) {
@@ -324,73 +397,59 @@ void module_date_loop() {
     Serial.print(" shifted="); Serial.print(shifted);
     Serial.print(" slice="); Serial.print(slice);
     Serial.print(" month="); Serial.print(month);
-    Serial.print(" sdelta="); Serial.println(sdelta);
+    Serial.print(" sdelta="); Serial.print(sdelta);
+    Serial.print(" vel="); Serial.print(enc.velocity);
+    Serial.print(" conf="); Serial.println(enc.confidence);
   }
 
   // serial commands (pass diagnostics)
   handleSerialCommands(raw, slice, month, sdelta, dt);
 
-  // 4) year rollover detection (month crossing)
-  if (lastMonth != 255 && month != lastMonth) {
-    if (lastMonth == 12 && month == 1) {
-      year = min(year + 1, MAX_YEAR);
-    } else if (lastMonth == 1 && month == 12) {
-      year = max(year - 1, MIN_YEAR);
-    }
-  }
-  lastMonth = month;
-
-  // 5) decide future mode entry
+  // 4) decide future mode entry
 if (ENABLE_FUTURE && !inFutureMode) {
-  if (year >= MAX_YEAR && sdelta > 0 && (dt <= FUTURE_SPIN_DT_MAX) && (abs(sdelta) >= FUTURE_SPIN_THRESHOLD)) {
-    // compute velocity in ticks per second
-    int vel = int((uint32_t)abs(sdelta) * 1000u / (uint32_t)dt);
-    if (DEBUG_RAW) {
-      Serial.printf("FUTURE entry candidate: sdelta=%ld dt=%lu vel=%d\n", (long)sdelta, dt, vel);
-    }
-    if (vel >= FUTURE_SPIN_VELOCITY) {
-      enterFutureMode();
-    }
+  if (year >= MAX_YEAR && spinSteps(enc) > 0) {
+    enterFutureMode();
   }
 }
 
-  // 6) render & input handling
+  // 5) render & input handling
   if (inFutureMode) {
     // process quick spins while in future-mode
-    handleFutureModeInput(sdelta, dt);
+    handleFutureModeInput(enc);
 
-    // ambient twinkle LED
-    if (leds && NUM_PIXELS > 0) {
+    // ambient twinkle LED (after any entry/step flash)
+    if (!updateFlash(now) && leds && NUM_PIXELS > 0) {
       if ((now - futureEnteredMs) % 400 < 80) leds[0] = CRGB::White;
       else leds[0] = CRGB::Black;
-      FastLED.show();
+      ledShow();
     }
 
     // do not publish normal timeline MQTT while in future-mode
   } else {
-    // normal timeline: LED color by month
-    if (leds && NUM_PIXELS > 0) {
+    // normal timeline: LED color by month (after any exit flash)
+    if (!updateFlash(now) && leds && NUM_PIXELS > 0) {
       leds[0] = monthColors[month - 1];
-      FastLED.show();
+      ledShow();
     }
 
     // redraw real year if needed
     drawRealYearIfNeeded();
 
-    // publish month/year when changed
-    if (month != lastMonthSent || year != lastYearSent) {
+    // publish month/year when changed (and not mid-crossing: year moves before the month settles)
+    if (slice_isSettled(monthSlicer) && (month != lastMonthSent || year != lastYearSent)) {
       lastMonthSent = month;
       lastYearSent  = year;
       char payload[32];
       snprintf(payload, sizeof(payload),
                "{\"month\":%d,\"year\":%d}", month, year);
-      mqttClient.publish(pubTopic, payload);
-      Serial.print("MQTT ▶ ");
-      Serial.println(payload);
+      publishJson(pubTopic, payload);
+      LOGD("published month=%d year=%d", month, year);
     }
   }
 
   // store last readings
-  lastRaw = raw;
+  lastCount = enc.count;
   lastRawMs = now;
-}
\ No newline at end of file
+}
+
+#endif // SPINNER_WITH_DATE
@@ -3,8 +3,15 @@
 // Option: show SLEEPS/AGO as two lines (configurable).
 // MQTT publishing (spinner/days) remains unchanged.
 
+#include "build_profile.h"
+#if SPINNER_WITH_DAYS
+
 #include "module_days.h"
 #include "shared.h"
+#include "encoder.h"
+#include "font_metrics.h"
+#include "slice_quantizer.h"
+#include "calibration.h"
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
@@ -21,14 +28,17 @@ namespace {
 
 // ===== CONFIG =====
 const bool DEBUG_RAW = false;       // set true while calibrating
-uint16_t RAW_OFFSET = 78;           // calibrate with 'c' if needed
-const uint8_t HOME_SLICE = 6;       // which aligned slice corresponds to physical home marker
+uint16_t RAW_OFFSET = 78;           // default; calibrate with 'c' if needed (saved to NVS)
+uint8_t HOME_SLICE = 6;             // which aligned slice corresponds to physical home marker
 const bool REVERSE_ROTATION = true; // flip direction if needed
 const int SLICE_COUNT = 7;
 const char* TZ = "Europe/London";
+const time_t NTP_VALID_EPOCH = 1600000000;  // clock counts as set past this (Sep 2020)
+const uint32_t NTP_REPORT_MS = 4000;        // debug note if SNTP hasn't answered by then
 
 // Set this to the slice index (0..SLICE_COUNT-1) that corresponds to MONDAY on your wheel.
 // Example: if the slice that is physically Monday reads as 2, set sliceIndexForMonday = 2.
+// Default only: 'M n' (or the calibration MQTT command's "extra") stores it.
 int sliceIndexForMonday = 6; // <-- change this to match your wheel
 
 // Visual options
@@ -42,40 +52,57 @@ const CRGB sliceColors[SLICE_COUNT] = {
 };
 
 // internal state
-uint16_t lastRaw = 0;
+int64_t lastCount = 0;
 uint32_t lastRawMs = 0;
 bool ntpInitialized = false;
+bool ntpRequested = false;
+uint32_t ntpRequestMs = 0;
+bool ntpLateReported = false;
+SliceQuantizer slicer = sliceQuantizer(SLICE_COUNT, RAW_OFFSET);
+
+// stored calibration (calibration.h) over the defaults above
+static void applyCalibration() {
+  ModuleCalibration c;
+  if (!calib_get(MOD_DAYS, c)) return;
+  RAW_OFFSET = c.rawOffset;
+  HOME_SLICE = c.homeSlice % SLICE_COUNT;
+  sliceIndexForMonday = c.extra % SLICE_COUNT;
+  slicer.offset = RAW_OFFSET;
+  slice_reset(slicer);
+}
 
-// helper: signed delta for AS5600 wrapping
-static int32_t signedRawDelta(uint16_t prev, uint16_t now) {
-  int32_t d = int32_t(now) - int32_t(prev);
-  if (d > 2048) d -= 4096;
-  else if (d < -2048) d += 4096;
-  return d;
+static void saveCalibration() {
+  calib_set(MOD_DAYS, { RAW_OFFSET, HOME_SLICE, uint8_t(sliceIndexForMonday) });
 }
 
-// try NTP (short wait)
+// Start SNTP once WiFi is up, then only check (never wait) whether the clock has been set;
+// SNTP keeps retrying in the background.
 static void tryInitNtp() {
   if (ntpInitialized) return;
-  if (WiFi.status() != WL_CONNECTED) {
-    if (DEBUG_RAW) Serial.println("module_days: WiFi not connected; skipping NTP init");
-    return;
+  if (!ntpRequested) {
+    if (WiFi.status() != WL_CONNECTED) {
+      if (DEBUG_RAW) Serial.println("module_days: WiFi not connected; skipping NTP init");
+      return;
+    }
+    setenv("TZ", TZ, 1);
+    tzset();
+    configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+    ntpRequested = true;
+    ntpRequestMs = millis();
   }
-  setenv("TZ", TZ, 1);
-  tzset();
-  configTime(0, 0, "pool.ntp.org", "time.nist.gov");
-  uint32_t start = millis();
-  while (time(nullptr) < 1600000000UL && millis() - start < 4000) delay(200);
-  if (time(nullptr) >= 1600000000UL) {
-    ntpInitialized = true;
-    if (DEBUG_RAW) {
-      struct tm nowtm; time_t now = time(nullptr); localtime_r(&now, &nowtm);
-      Serial.printf("module_days: NTP OK %04d-%02d-%02d %02d:%02d:%02d\n",
-                    nowtm.tm_year+1900, nowtm.tm_mon+1, nowtm.tm_mday,
-                    nowtm.tm_hour, nowtm.tm_min, nowtm.tm_sec);
+  if (time(nullptr) < NTP_VALID_EPOCH) {
+    if (DEBUG_RAW && !ntpLateReported && millis() - ntpRequestMs >= NTP_REPORT_MS) {
+      ntpLateReported = true;
+      Serial.println("module_days: NTP not acquired yet");
     }
-  } else {
-    if (DEBUG_RAW) Serial.println("module_days: NTP not acquired");
+    return;
+  }
+  ntpInitialized = true;
+  if (DEBUG_RAW) {
+    struct tm nowtm; time_t now = time(nullptr); localtime_r(&now, &nowtm);
+    Serial.printf("module_days: NTP OK %04d-%02d-%02d %02d:%02d:%02d\n",
+                  nowtm.tm_year+1900, nowtm.tm_mon+1, nowtm.tm_mday,
+                  nowtm.tm_hour, nowtm.tm_min, nowtm.tm_sec);
   }
 }
 
@@ -91,13 +118,13 @@ static void handleSerialCommands(uint16_t raw) {
 
   if (s.equalsIgnoreCase("c")) {
     RAW_OFFSET = raw;
-    Serial.printf("module_days: RAW_OFFSET set to %u\n", RAW_OFFSET);
+    saveCalibration();
+    applyCalibration();
+    Serial.printf("module_days: RAW_OFFSET set to %u (saved)\n", RAW_OFFSET);
   }
   else if (s.equalsIgnoreCase("p")) {
-    int32_t shifted = int32_t(raw) - int32_t(RAW_OFFSET);
-    if (shifted < 0) shifted += 4096;
-    else if (shifted >= 4096) shifted -= 4096;
-    int sliceRaw = (shifted * SLICE_COUNT) / 4096;
+    int32_t shifted = encoderPhase(raw, RAW_OFFSET);
+    int sliceRaw = encoderSlice(raw, RAW_OFFSET, SLICE_COUNT);
     int sliceAligned = (sliceRaw + SLICE_COUNT - int(HOME_SLICE)) % SLICE_COUNT;
     int slice = REVERSE_ROTATION ? (SLICE_COUNT - sliceAligned) % SLICE_COUNT : sliceAligned;
     if (slice < 0) slice += SLICE_COUNT;
@@ -115,7 +142,8 @@ static void handleSerialCommands(uint16_t raw) {
     int n = s.substring(2).toInt();
     if (n >= 0 && n < SLICE_COUNT) {
       sliceIndexForMonday = n;
-      Serial.printf("module_days: sliceIndexForMonday set to %d (temporary, recompile to persist)\n", sliceIndexForMonday);
+      saveCalibration();
+      Serial.printf("module_days: sliceIndexForMonday set to %d (saved)\n", sliceIndexForMonday);
     } else {
       Serial.printf("module_days: invalid M value '%s' (expect 0..%d)\n", s.substring(2).c_str(), SLICE_COUNT-1);
     }
@@ -133,48 +161,49 @@ void module_days_enable(bool /*on*/) {}
 bool module_days_isEnabled() { return true; }
 
 void module_days_setup() {
-  lastRaw = as5600.readAngle();
+  EncoderState enc = encoder_read();
+  lastCount = enc.count;
   lastRawMs = millis();
+  calib_load(MOD_DAYS, { RAW_OFFSET, HOME_SLICE, uint8_t(sliceIndexForMonday) });
+  applyCalibration();
   tryInitNtp();
 
-  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; FastLED.show(); }
+  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; ledShow(); }
   display.clearDisplay();
-  display.display();
+  displayFlush();
 
   if (DEBUG_RAW) Serial.printf("module_days: setup raw=%u RAW_OFFSET=%u sliceIndexForMonday=%d\n",
-                              lastRaw, RAW_OFFSET, sliceIndexForMonday);
+                              enc.raw, RAW_OFFSET, sliceIndexForMonday);
 }
 
 void module_days_activate() {
-  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; FastLED.show(); }
+  applyCalibration();  // picks up runtime recalibration
+  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; ledShow(); }
   if (DEBUG_RAW) Serial.println("module_days: activated");
 }
 
 void module_days_deactivate() {
-  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; FastLED.show(); }
+  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; ledShow(); }
   if (DEBUG_RAW) Serial.println("module_days: deactivated");
 }
 
 void module_days_loop() {
-  mqttClient.loop();
-
   unsigned long nowMs = millis();
 
   // read sensor
-  uint16_t raw = as5600.readAngle();
+  EncoderState enc = encoder_read();
+  uint16_t raw = enc.raw;
   unsigned long dt = nowMs - lastRawMs; if (dt == 0) dt = 1;
-  int32_t sdelta = signedRawDelta(lastRaw, raw);
+  int32_t sdelta = int32_t(enc.count - lastCount);
 
   // serial control
   handleSerialCommands(raw);
 
   // calibration offset & wrap
-  int32_t shifted = int32_t(raw) - int32_t(RAW_OFFSET);
-  if (shifted < 0) shifted += 4096;
-  else if (shifted >= 4096) shifted -= 4096;
+  int32_t shifted = encoderPhase(raw, RAW_OFFSET);
 
   // compute slices
-  int sliceRaw = (shifted * SLICE_COUNT) / 4096;
+  int sliceRaw = slice_update(slicer, raw, nowMs);
   int sliceAligned = (sliceRaw + SLICE_COUNT - int(HOME_SLICE)) % SLICE_COUNT;
   int slice = REVERSE_ROTATION ? (SLICE_COUNT - sliceAligned) % SLICE_COUNT : sliceAligned;
   if (slice < 0) slice += SLICE_COUNT;
@@ -184,11 +213,11 @@ void module_days_loop() {
                   raw, shifted, sliceRaw, sliceAligned, slice, (long)sdelta, dt);
   }
 
-  // maybe init NTP if wifi came up later
+  // maybe init NTP if wifi came up later (non-blocking: starts SNTP, then polls each frame)
   if (!ntpInitialized && WiFi.status() == WL_CONNECTED) tryInitNtp();
 
   // LED for slice
-  if (leds && NUM_PIXELS > 0) { leds[0] = sliceColors[slice % SLICE_COUNT]; FastLED.show(); }
+  if (leds && NUM_PIXELS > 0) { leds[0] = sliceColors[slice % SLICE_COUNT]; ledShow(); }
 
   // map slice -> weekday using sliceIndexForMonday
   int labelWeekday = (slice - sliceIndexForMonday + 1 + 7) % 7; // 0=Sun..6=Sat
@@ -251,7 +280,7 @@ if (ntpInitialized) {
     snprintf(payload, sizeof(payload),
              "{\"days_ago\":%d,\"date\":\"%s\",\"photoprism_q\":\"%s\"}",
              daysAgo, dateIso, ppq);
-    mqttClient.publish("spinner/days", payload);
+    publishJson("spinner/days", payload);
     if (DEBUG_RAW) Serial.printf("module_days: MQTT ▶ %s\n", payload);
     strncpy(lastDateSent, dateIso, sizeof(lastDateSent));
   }
@@ -260,7 +289,7 @@ if (ntpInitialized) {
   if (lastPublishedAgo != daysAgo) {
     char payload[64];
     snprintf(payload, sizeof(payload), "{\"days_ago\":%d,\"date\":\"\"}", daysAgo);
-    mqttClient.publish("spinner/days", payload);
+    publishJson("spinner/days", payload);
     lastPublishedAgo = daysAgo;
     if (DEBUG_RAW) Serial.printf("module_days: MQTT ▶ %s\n", payload);
   }
@@ -274,10 +303,9 @@ if (ntpInitialized) {
     display.setFont(&FreeSans12pt7b);
     display.setTextSize(1);
     display.setTextColor(SSD1306_WHITE);
-    int16_t x1, y1; uint16_t w1, h1;
-    display.getTextBounds(topLine, 0, 0, &x1, &y1, &w1, &h1);
-    int16_t cx = (SCREEN_W - w1) / 2 - x1;
-    int16_t cy = (SCREEN_H - h1) / 2 - y1;
+    TextBounds b = font_textBounds(&FreeSans12pt7b, topLine);
+    int16_t cx = (SCREEN_W - b.w) / 2 - b.x;
+    int16_t cy = (SCREEN_H - b.h) / 2 - b.y;
     display.setCursor(cx, cy);
     display.print(topLine);
   } else {
@@ -285,37 +313,32 @@ if (ntpInitialized) {
     display.setFont(&FreeSans12pt7b);
     display.setTextSize(1);
     display.setTextColor(SSD1306_WHITE);
-    int16_t tx, ty; uint16_t tw, th;
-    display.getTextBounds(topLine, 0, 0, &tx, &ty, &tw, &th);
-    int topH = th;
-
-    display.setFont(&FreeSans9pt7b);
-    display.getTextBounds(bottomLine, 0, 0, &tx, &ty, &tw, &th);
-    int bottomH = th;
+    TextBounds top = font_textBounds(&FreeSans12pt7b, topLine);
+    int topH = top.h;
+    int bottomH = font_textBounds(&FreeSans9pt7b, bottomLine).h;
 
     int totalH = topH + LINE_GAP + bottomH;
     int16_t startY = (SCREEN_H - totalH) / 2;
 
     // draw top
-    display.setFont(&FreeSans12pt7b);
-    display.getTextBounds(topLine, 0, 0, &tx, &ty, &tw, &th);
-    int16_t topX = (SCREEN_W - tw) / 2 - tx;
-    int16_t topY = startY - ty;
+    int16_t topX = (SCREEN_W - top.w) / 2 - top.x;
+    int16_t topY = startY - top.y;
     display.setCursor(topX, topY);
     display.print(topLine);
 
     // draw bottom
-    display.setFont(&FreeSans12pt7b);
-    display.getTextBounds(bottomLine, 0, 0, &tx, &ty, &tw, &th);
-    int16_t bottomX = (SCREEN_W - tw) / 2 - tx;
-    int16_t bottomY = startY + topH + LINE_GAP - ty;
+    TextBounds bottom = font_textBounds(&FreeSans12pt7b, bottomLine);
+    int16_t bottomX = (SCREEN_W - bottom.w) / 2 - bottom.x;
+    int16_t bottomY = startY + topH + LINE_GAP - bottom.y;
     display.setCursor(bottomX, bottomY);
     display.print(bottomLine);
   }
 
-  display.display();
+  displayFlush();
 
   // store last readings
-  lastRaw = raw;
+  lastCount = enc.count;
   lastRawMs = nowMs;
-}
\ No newline at end of file
+}
+
+#endif // SPINNER_WITH_DAYS
@@ -2,10 +2,20 @@
 // Marquee of waypoint names with symbols placed BETWEEN underscore gap slots.
 // Single-line marquee (top), bottom status (time/distance).
 // Defensive fixes to avoid crashes on module switching.
-// Adds MQTT publish when a waypoint is focused (topic: "distance") and ensures mqttClient.loop() is serviced.
+// Adds MQTT publish when a waypoint is focused (topic: "distance") (net task keeps the client serviced).
+
+#include "build_profile.h"
+#if SPINNER_WITH_DISTANCE
 
 #include "module_distance.h"
 #include "shared.h"
+#include "encoder.h"
+#include "font_metrics.h"
+#include "oled.h"
+
+#define LOGGER_TAG "distance"
+#define LOGGER_LEVEL LOG_LEVEL_INFO  // LOG_LEVEL_DEBUG for placement and focus traces
+#include "logger.h"
 
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
@@ -19,7 +29,6 @@
 namespace
 {
   // ===== CONFIG =====
-  static const bool DEBUG = false; // set true to enable placement debug prints
   bool ENABLE_DISTANCE = true;
 
   const int MAX_MILES = 500;
@@ -69,7 +78,7 @@ namespace
   String baseMarquee; // base marquee: '_' slots + letters (no symbols)
   int charW = 6, charH = 10, charY = 0;
   long totalCounts = 0;
-  uint16_t lastRaw = 0;
+  int64_t lastCount = 0;
 
   int *waypointPixelOffset = nullptr; // per-waypoint pixel start
   bool active = false;
@@ -83,22 +92,53 @@ namespace
 
   // last waypoint published via MQTT (-1 = none)
   int lastPublishedIdx = -1;
+
+  // Marquee + symbols pre-rendered once per activation, in the SSD1306 buffer layout (one byte
+  // = 8 vertical pixels of a column, a row of bytes per page), so a frame is one memcpy per page.
+  // nullptr = render glyph by glyph (no memory, or the route is too long for a GFX canvas).
+  uint8_t *strip = nullptr;
+  int stripW = 0;           // columns (pixels)
+  uint8_t stripPage0 = 0;   // first display page the marquee touches
+  uint8_t stripPages = 0;
+
+  // Adafruit_GFX target writing into `strip`, so glyphs come out exactly as on the display
+  class StripCanvas : public Adafruit_GFX
+  {
+  public:
+    StripCanvas(int16_t w) : Adafruit_GFX(w, SCREEN_H) {}
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override
+    {
+      if (x < 0 || x >= stripW || y < 0) return;
+      int page = y / 8 - stripPage0;
+      if (page < 0 || page >= stripPages) return;
+      uint8_t &b = strip[page * stripW + x];
+      if (color == SSD1306_WHITE) b |= uint8_t(1 << (y & 7));
+      else if (color == SSD1306_BLACK) b &= uint8_t(~(1 << (y & 7)));
+      else b ^= uint8_t(1 << (y & 7));
+    }
+  };
 }
 
 // ---------- helpers ----------
 static int measureRenderedCharWidth(char c)
 {
-  display.setFont(MARQUEE_FONT);
-  display.setTextSize(1);
-  char buf[4] = {c, 0, 0, 0};
-  int16_t rx, ry;
-  uint16_t rw, rh;
-  display.getTextBounds(buf, 0, 0, &rx, &ry, &rw, &rh);
-  return (int)rw + MARQUEE_LETTER_SPACING;
+  return (int)font_charWidth(MARQUEE_FONT, c) + MARQUEE_LETTER_SPACING;
+}
+
+static int nameWidth(int i)
+{
+  return (int)font_textBounds(MARQUEE_FONT, waypoints[i].name).w;
+}
+
+static void freeStrip()
+{
+  if (strip) { free(strip); strip = nullptr; }
+  stripW = 0;
 }
 
 static void freeOffsets()
 {
+  freeStrip();
   if (waypointPixelOffset) { free(waypointPixelOffset); waypointPixelOffset = nullptr; }
   if (underscorePixelPos) { free(underscorePixelPos); underscorePixelPos = nullptr; }
   if (symbolPlacements) { free(symbolPlacements); symbolPlacements = nullptr; }
@@ -117,7 +157,7 @@ static void buildBaseMarqueeAndOffsets()
   int charIndex = 0;
   int *nameCharIndex = (int *)malloc(sizeof(int) * numWP);
   if (!nameCharIndex) {
-    Serial.println("module_distance: malloc failed (nameCharIndex)");
+    LOGE("malloc failed (nameCharIndex)");
     return;
   }
 
@@ -134,14 +174,11 @@ static void buildBaseMarqueeAndOffsets()
   // allocate waypointPixelOffset
   waypointPixelOffset = (int *)malloc(sizeof(int) * numWP);
   if (!waypointPixelOffset) {
-    Serial.println("module_distance: malloc failed (waypointPixelOffset)");
+    LOGE("malloc failed (waypointPixelOffset)");
     free(nameCharIndex);
     return;
   }
 
-  display.setFont(MARQUEE_FONT);
-  display.setTextSize(1);
-
   // count underscores
   int totalChars = (int)baseMarquee.length();
   int ucount = 0;
@@ -150,7 +187,7 @@ static void buildBaseMarqueeAndOffsets()
   if (underscoreCount > 0) {
     underscorePixelPos = (int *)malloc(sizeof(int) * underscoreCount);
     if (!underscorePixelPos) {
-      Serial.println("module_distance: malloc failed (underscorePixelPos)");
+      LOGE("malloc failed (underscorePixelPos)");
       free(nameCharIndex);
       return;
     }
@@ -174,28 +211,21 @@ static void buildBaseMarqueeAndOffsets()
   free(nameCharIndex);
 
   // measure charW/charH
-  int16_t rx, ry; uint16_t rw, rh;
-  display.getTextBounds("_", 0, 0, &rx, &ry, &rw, &rh);
-  charW = (int)rw + MARQUEE_LETTER_SPACING;
-  charH = (int)rh;
-  charY = ((SCREEN_H / 2 - (int)charH) / 2) - ry + MARQUEE_Y_OFFSET;
-
-  if (DEBUG) {
-    Serial.printf("buildBase: chars=%d underscores=%d charW=%d charH=%d\n", totalChars, underscoreCount, charW, charH);
-  }
+  TextBounds ub = font_textBounds(MARQUEE_FONT, "_");
+  charW = (int)ub.w + MARQUEE_LETTER_SPACING;
+  charH = (int)ub.h;
+  charY = ((SCREEN_H / 2 - (int)charH) / 2) - ub.y + MARQUEE_Y_OFFSET;
+
+  LOGD("buildBase: chars=%d underscores=%d charW=%d charH=%d", totalChars, underscoreCount, charW, charH);
 }
 
 // check if pixel mid overlaps any waypoint name area (+/- gapPx)
 static bool midOverlapsName(int midPx, int gapPx)
 {
   if (!waypointPixelOffset) return false;
-  display.setFont(MARQUEE_FONT);
-  display.setTextSize(1);
   for (int i = 0; i < numWP; ++i) {
-    int16_t bx, by; uint16_t bw, bh;
-    display.getTextBounds(waypoints[i].name, 0, 0, &bx, &by, &bw, &bh);
     int nameLeft = waypointPixelOffset[i];
-    int nameRight = nameLeft + (int)bw;
+    int nameRight = nameLeft + nameWidth(i);
     if (midPx >= (nameLeft - gapPx) && midPx <= (nameRight + gapPx)) return true;
   }
   return false;
@@ -213,7 +243,7 @@ static void decideSymbolPlacements()
 
   symbolPlacements = (SymbolPlacement *)malloc(sizeof(SymbolPlacement) * approxSymbols);
   if (!symbolPlacements) {
-    Serial.println("module_distance: malloc failed (symbols)");
+    LOGE("malloc failed (symbols)");
     return;
   }
   symbolPlacementCount = 0;
@@ -251,7 +281,7 @@ static void decideSymbolPlacements()
     }
 
     if (foundOrdinal < 0) {
-      if (DEBUG) Serial.printf("skip symbol for bucket %d (no safe ordinal)\n", k);
+      LOGD("skip symbol for bucket %d (no safe ordinal)", k);
       continue;
     }
 
@@ -260,7 +290,7 @@ static void decideSymbolPlacements()
     symbolPlacements[symbolPlacementCount].underscoreOrdinal = foundOrdinal;
     symbolPlacements[symbolPlacementCount].sym = sym;
     ++symbolPlacementCount;
-    if (DEBUG) Serial.printf("placed symbol #%d at ordinal=%d sym=%c (bucket %d)\n", symbolPlacementCount - 1, foundOrdinal, sym, k);
+    LOGD("placed symbol #%d at ordinal=%d sym=%c (bucket %d)", symbolPlacementCount - 1, foundOrdinal, sym, k);
   }
 
   // sort placements
@@ -272,11 +302,111 @@ static void decideSymbolPlacements()
     }
   }
 
-  if (DEBUG) {
-    Serial.printf("decideSymbolPlacements: final count=%d\n", symbolPlacementCount);
-    for (int s = 0; s < symbolPlacementCount; ++s) {
-      Serial.printf("  sym[%d] underscoreOrd=%d sym=%c\n", s, symbolPlacements[s].underscoreOrdinal, symbolPlacements[s].sym);
+  LOGD("decideSymbolPlacements: final count=%d", symbolPlacementCount);
+  for (int s = 0; s < symbolPlacementCount; ++s) {
+    LOGD("  sym[%d] underscoreOrd=%d sym=%c", s, symbolPlacements[s].underscoreOrdinal, symbolPlacements[s].sym);
+  }
+}
+
+// Whether the one-character string `s` printed with the cursor at x puts ink in 0..viewW-1.
+// Culling by the ink box (not the layout slot) keeps glyph-by-glyph drawing pixel-identical to
+// a window of the strip.
+static bool inkVisible(const char *s, int x, int viewW)
+{
+  TextBounds b = font_textBounds(MARQUEE_FONT, s);
+  return b.w > 0 && x + b.x + (int)b.w > 0 && x + b.x < viewW;
+}
+
+// Marquee letters and symbols onto `gfx`, shifted left by scrollX; glyphs with no ink in
+// 0..viewW are skipped.
+static void drawMarquee(Adafruit_GFX &gfx, int scrollX, int viewW)
+{
+  gfx.setFont(MARQUEE_FONT);
+  gfx.setTextSize(1);
+  gfx.setTextColor(SSD1306_WHITE);
+
+  int totalChars = (int)baseMarquee.length();
+  int px = 0;
+  for (int i = 0; i < totalChars; ++i) {
+    char c = baseMarquee.charAt(i);
+    int w = measureRenderedCharWidth(c);
+    int drawX = px - scrollX;
+    char buf[2] = {c, 0};
+    if (inkVisible(buf, drawX, viewW)) {
+      gfx.setCursor(drawX, charY);
+      gfx.print(buf);
     }
+    px += w;
+  }
+
+  // draw symbols
+  for (int s = 0; s < symbolPlacementCount; ++s) {
+    int ord = symbolPlacements[s].underscoreOrdinal;
+    char sym = symbolPlacements[s].sym;
+    if (ord < 0 || ord >= underscoreCount) continue;
+    int leftPx = underscorePixelPos[ord];
+    int rightPx = (ord + 1 < underscoreCount) ? underscorePixelPos[ord + 1] : (leftPx + charW);
+    int mid = (leftPx + rightPx) / 2;
+    char bufSym[2] = {sym, 0};
+    int bw = (int)font_charWidth(MARQUEE_FONT, sym);
+    int symX = mid - (bw / 2);
+    int drawX = symX - scrollX;
+    if (inkVisible(bufSym, drawX, viewW)) {
+      gfx.setCursor(drawX, charY);
+      gfx.print(bufSym);
+    }
+  }
+}
+
+// Render the whole route into `strip` (after the offsets and symbol placements are decided).
+// Leaves strip == nullptr when it can't, and loop() draws glyph by glyph instead.
+static void renderStrip()
+{
+  freeStrip();
+  if (!underscorePixelPos) return;
+
+  // rows any marquee glyph can reach, as whole display pages
+  const GFXfont *f = MARQUEE_FONT;
+  int top = SCREEN_H, bottom = 0;
+  for (uint16_t c = f->first; c <= f->last; ++c) {
+    const GFXglyph &g = f->glyph[c - f->first];
+    top = min(top, charY + g.yOffset);
+    bottom = max(bottom, charY + g.yOffset + g.height);
+  }
+  top = max(top, 0);
+  bottom = min(bottom, (int)SCREEN_H);
+  if (bottom <= top) return;
+
+  int routeW = 0;
+  for (int i = 0; i < (int)baseMarquee.length(); ++i) routeW += measureRenderedCharWidth(baseMarquee.charAt(i));
+  int w = routeW + charW + SCREEN_W;  // symbols may sit one slot past the last underscore
+  if (w > INT16_MAX) {
+    LOGW("route too wide for a strip (%d px), drawing glyph by glyph", w);
+    return;
+  }
+
+  stripPage0 = uint8_t(top / 8);
+  stripPages = uint8_t((bottom - 1) / 8 - stripPage0 + 1);
+  strip = (uint8_t *)calloc(size_t(w) * stripPages, 1);
+  if (!strip) {
+    LOGW("no memory for the strip (%u bytes), drawing glyph by glyph", unsigned(w * stripPages));
+    return;
+  }
+  stripW = w;
+  StripCanvas canvas((int16_t)w);
+  canvas.setTextWrap(false);
+  drawMarquee(canvas, 0, w);
+  LOGI("strip: %d px x %u pages (%u bytes)", w, unsigned(stripPages), unsigned(w * stripPages));
+}
+
+// The window of `strip` at scrollX into the (cleared) display buffer.
+static void blitStrip(int scrollX)
+{
+  int n = min((int)SCREEN_W, stripW - scrollX);
+  if (scrollX < 0 || n <= 0) return;
+  uint8_t *fb = display.getBuffer();
+  for (int p = 0; p < stripPages; ++p) {
+    memcpy(fb + (stripPage0 + p) * SCREEN_W, strip + p * stripW + scrollX, n);
   }
 }
 
@@ -287,34 +417,33 @@ bool module_distance_isEnabled() { return ENABLE_DISTANCE; }
 void module_distance_setup()
 {
   randomSeed(analogRead(0) ^ millis());
-  lastRaw = 4095 - as5600.readAngle();
+  lastCount = encoder_read().count;
   totalCounts = 0;
   display.setTextWrap(false);
   buildBaseMarqueeAndOffsets();
   decideSymbolPlacements();
   display.clearDisplay();
-  display.display();
-  if (DEBUG) {
-    Serial.println("module_distance: setup complete");
-    Serial.print("baseMarquee: "); Serial.println(baseMarquee);
-  }
+  displayFlush();
+  LOGD("setup complete");
+  LOGD("baseMarquee: %s", baseMarquee);
 }
 
 void module_distance_activate()
 {
   // Ensure marquee/offsets exist before using them
   if (!waypointPixelOffset || !underscorePixelPos) {
-    if (DEBUG) Serial.println("module_distance: rebuilding marquee in activate()");
+    LOGD("rebuilding marquee in activate()");
     buildBaseMarqueeAndOffsets();
   }
 
-  // (re)decide symbol placements now that offsets exist
+  // (re)decide symbol placements now that offsets exist, and render the route with them
   decideSymbolPlacements();
+  renderStrip();
 
   active = true;
   lastPublishedIdx = -1; // reset publish state on activation
-  if (leds && NUM_PIXELS > 0) { leds[0] = DEFAULT_COLOUR; FastLED.show(); }
-  if (DEBUG) Serial.println("module_distance: activated");
+  if (leds && NUM_PIXELS > 0) { leds[0] = DEFAULT_COLOUR; ledShow(); }
+  LOGD("activated");
 }
 
 void module_distance_deactivate()
@@ -322,38 +451,32 @@ void module_distance_deactivate()
   active = false;
   freeOffsets();
   lastPublishedIdx = -1;
-  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; FastLED.show(); }
-  if (DEBUG) Serial.println("module_distance: deactivated");
+  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; ledShow(); }
+  LOGD("deactivated");
 }
 
 void module_distance_loop()
 {
   if (!ENABLE_DISTANCE || !active) return;
 
-  // ensure mqtt client processed (important to keep connection alive)
-  if (mqttClient.connected()) mqttClient.loop();
-
   // protect against missing offsets
   if (!waypointPixelOffset || !underscorePixelPos) {
-    if (DEBUG) Serial.println("module_distance: missing offsets in loop(), attempting rebuild");
+    LOGD("missing offsets in loop(), attempting rebuild");
     buildBaseMarqueeAndOffsets();
     decideSymbolPlacements();
+    renderStrip();
     if (!waypointPixelOffset || !underscorePixelPos) {
-      if (DEBUG) Serial.println("module_distance: rebuild failed, skipping loop iteration");
-      delay(50);
+      LOGD("rebuild failed, skipping loop iteration");
       return;
     }
   }
 
-  // 1) read & invert encoder
-  uint16_t raw = as5600.readAngle();
-  uint16_t inv = 4095 - raw;
+  // 1) read encoder
+  int64_t count = encoder_read().count;
 
-  // 2) signed delta wrap aware
-  int32_t diff = int32_t(inv) - int32_t(lastRaw);
-  if (diff > 2048) diff -= 4096;
-  if (diff < -2048) diff += 4096;
-  lastRaw = inv;
+  // 2) signed delta (inverted direction)
+  int32_t diff = int32_t(lastCount - count);
+  lastCount = count;
 
   // 3) accumulate & clamp
   totalCounts += diff;
@@ -370,51 +493,45 @@ void module_distance_loop()
   int hr = totalMin / 60;
   int mn = totalMin % 60;
 
-  // 5) compute scroll offset
-  int16_t scrollX = miles * charW;
+  // 5) compute scroll offset. With the hardware content scroll built in (oled.h) it is
+  //    pixel-continuous (a whole mile still lands on its slot), so a slow turn moves the marquee
+  //    a column at a time and each column is one scroll command. Without it, a pixel step would
+  //    resend every marquee page, so the marquee moves in whole slots.
+  int16_t scrollX = SPINNER_OLED_CONTENT_SCROLL ? int16_t(milesF * charW + 0.5f)
+                                                : int16_t(miles * charW);
 
   // 6) detect waypoint visible for LED and compute focused wp for MQTT
   bool anyVis = false;
   for (int i = 0; i < numWP; ++i) {
     int16_t nameX = waypointPixelOffset[i] - scrollX;
-    int16_t bx, by; uint16_t bw, bh;
-    display.setFont(MARQUEE_FONT);
-    display.getTextBounds(waypoints[i].name, 0, 0, &bx, &by, &bw, &bh);
-    if ((nameX + (int)bw > 0) && (nameX < SCREEN_W)) { anyVis = true; break; }
+    if ((nameX + nameWidth(i) > 0) && (nameX < SCREEN_W)) { anyVis = true; break; }
   }
 
   bool destVis = false;
   {
     int i = numWP - 1;
     int16_t nameX = waypointPixelOffset[i] - scrollX;
-    int16_t bx, by; uint16_t bw, bh;
-    display.setFont(MARQUEE_FONT);
-    display.getTextBounds(waypoints[i].name, 0, 0, &bx, &by, &bw, &bh);
-    if ((nameX + (int)bw > 0) && (nameX < SCREEN_W)) destVis = true;
+    if ((nameX + nameWidth(i) > 0) && (nameX < SCREEN_W)) destVis = true;
   }
 
   // ---------- Find focused waypoint (closest center to screen center) ----------
   int centerX = SCREEN_W / 2;
   int bestIdx = -1;
   int bestDist = INT32_MAX;
-  display.setFont(MARQUEE_FONT);
   for (int i = 0; i < numWP; ++i) {
-    int16_t bx, by; uint16_t bw, bh;
-    display.getTextBounds(waypoints[i].name, 0, 0, &bx, &by, &bw, &bh);
     int wpLeft = waypointPixelOffset[i] - scrollX;
-    int wpCenter = wpLeft + (int)bw / 2;
+    int wpCenter = wpLeft + nameWidth(i) / 2;
     int d = abs(wpCenter - centerX);
     if (d < bestDist) { bestDist = d; bestIdx = i; }
   }
   const int FOCUS_THRESHOLD_PX = charW * 3; // tweakable
   bool focused = (bestIdx >= 0 && bestDist <= FOCUS_THRESHOLD_PX);
 
-  // Always print focused waypoint to serial so you can see it in monitor
+  // every frame, so debug only; focus changes are logged with the publish below
   if (focused) {
-    Serial.printf("Focused waypoint: idx=%d name=%s distPx=%d\n", bestIdx, waypoints[bestIdx].name, bestDist);
+    LOGD("Focused waypoint: idx=%d name=%s distPx=%d", bestIdx, waypoints[bestIdx].name, bestDist);
   } else {
-    // Print when nothing focused (helps debugging)
-    if (DEBUG) Serial.println("No focused waypoint");
+    LOGD("No focused waypoint");
   }
 
   // MQTT: publish when focused waypoint changes
@@ -423,14 +540,11 @@ void module_distance_loop()
     // prepare payload
     char payload[80];
     snprintf(payload, sizeof(payload), "{\"name\":\"%s\",\"mile\":%d}", waypoints[bestIdx].name, waypoints[bestIdx].mile);
-    if (mqttClient.connected()) {
-      bool ok = mqttClient.publish(MQTT_TOPIC, payload);
-      Serial.print("MQTT publish ");
-      Serial.print(ok ? "OK: " : "FAILED: ");
-      Serial.println(payload);
+    if (mqttIsConnected()) {
+      bool ok = publishJson(MQTT_TOPIC, payload);
+      LOGI("MQTT publish %s%s", ok ? "OK: " : "FAILED: ", waypoints[bestIdx].name);
     } else {
-      Serial.print("MQTT skipped (not connected): ");
-      Serial.println(payload);
+      LOGI("MQTT skipped (not connected): %s", waypoints[bestIdx].name);
     }
   } else if (!focused) {
     // clear lastPublishedIdx so it will publish again when a wp re-enters focus
@@ -441,46 +555,13 @@ void module_distance_loop()
   if (destVis) leds[0] = WP_COLOUR;
   else if (anyVis) leds[0] = WP_COLOUR;
   else leds[0] = DEFAULT_COLOUR;
-  FastLED.show();
+  ledShow();
 
   // 8) draw
   display.clearDisplay();
-  display.setFont(MARQUEE_FONT);
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
 
-  int totalChars = (int)baseMarquee.length();
-  int px = 0;
-  for (int i = 0; i < totalChars; ++i) {
-    char c = baseMarquee.charAt(i);
-    int w = measureRenderedCharWidth(c);
-    int drawX = px - scrollX;
-    if (!(drawX + w <= 0 || drawX >= SCREEN_W)) {
-      char buf[2] = {c, 0};
-      display.setCursor(drawX, charY);
-      display.print(buf);
-    }
-    px += w;
-  }
-
-  // draw symbols
-  for (int s = 0; s < symbolPlacementCount; ++s) {
-    int ord = symbolPlacements[s].underscoreOrdinal;
-    char sym = symbolPlacements[s].sym;
-    if (ord < 0 || ord >= underscoreCount) continue;
-    int leftPx = underscorePixelPos[ord];
-    int rightPx = (ord + 1 < underscoreCount) ? underscorePixelPos[ord + 1] : (leftPx + charW);
-    int mid = (leftPx + rightPx) / 2;
-    char bufSym[2] = {sym, 0};
-    int16_t bx, by; uint16_t bw, bh;
-    display.getTextBounds(bufSym, 0, 0, &bx, &by, &bw, &bh);
-    int symX = mid - ((int)bw / 2);
-    int drawX = symX - scrollX;
-    if (!(drawX + (int)bw <= 0 || drawX >= SCREEN_W)) {
-      display.setCursor(drawX, charY);
-      display.print(bufSym);
-    }
-  }
+  if (strip) blitStrip(scrollX);
+  else drawMarquee(display, scrollX, SCREEN_W);
 
   // bottom status
   display.setFont(STATUS_FONT);
@@ -488,13 +569,12 @@ void module_distance_loop()
   display.setTextColor(SSD1306_WHITE);
   char statusBuf[32];
   snprintf(statusBuf, sizeof(statusBuf), "%dh%02dm (%dmi)", hr, mn, miles);
-  int16_t sx, sy; uint16_t sw, sh;
-  display.getTextBounds(statusBuf, 0, 0, &sx, &sy, &sw, &sh);
-  display.setCursor((SCREEN_W - (int)sw) / 2 - sx,
-                    SCREEN_H / 2 + ((SCREEN_H / 2 - (int)sh) / 2) - sy + STATUS_Y_OFFSET);
+  TextBounds sb = font_textBounds(STATUS_FONT, statusBuf);
+  display.setCursor((SCREEN_W - (int)sb.w) / 2 - sb.x,
+                    SCREEN_H / 2 + ((SCREEN_H / 2 - (int)sb.h) / 2) - sb.y + STATUS_Y_OFFSET);
   display.print(statusBuf);
 
-  display.display();
+  displayFlush();
+}
 
-  delay(10);
-}
\ No newline at end of file
+#endif // SPINNER_WITH_DISTANCE
@@ -1,6 +1,16 @@
 // module_family.cpp
+#include "build_profile.h"
+#if SPINNER_WITH_FAMILY
+
 #include "module_family.h"
 #include "shared.h"
+#include "encoder.h"
+#include "slice_quantizer.h"
+#include "calibration.h"
+
+#define LOGGER_TAG "family"
+#define LOGGER_LEVEL LOG_LEVEL_INFO  // LOG_LEVEL_DEBUG for per-publish traces
+#include "logger.h"
 
 // fonts
 #include <Fonts/FreeSans12pt7b.h>
@@ -9,8 +19,8 @@
 namespace {
   // Module local config (use same values you had)
   const bool DEBUG_RAW      = false;
-  const uint16_t RAW_OFFSET = 2636;
-  const uint8_t  HOME_SLICE = 0;
+  uint16_t RAW_OFFSET = 2636;  // defaults; a stored calibration overrides them
+  uint8_t  HOME_SLICE = 0;
   const int SLICE_COUNT    = 6;   // 6 family segments
 
   // Data
@@ -36,8 +46,18 @@ namespace {
   const char* pubTopic = "spinner/birthfam";
 
   // module state
-  uint16_t lastRaw = 0;
   int lastIdx = -1;
+  SliceQuantizer slicer = sliceQuantizer(SLICE_COUNT, RAW_OFFSET);
+}
+
+// stored calibration (calibration.h) over the defaults above
+static void applyCalibration() {
+  ModuleCalibration c;
+  if (!calib_get(MOD_FAMILY, c)) return;
+  RAW_OFFSET = c.rawOffset;
+  HOME_SLICE = c.homeSlice % SLICE_COUNT;
+  slicer.offset = RAW_OFFSET;
+  slice_reset(slicer);
 }
 
 // helper: display update
@@ -64,29 +84,31 @@ static void updateDisplay(int idx) {
   display.setCursor(nx, ny);
   display.print(familyNames[idx]);
 
-  display.display();
+  displayFlush();
 }
 
 
 // API implementations
 void module_family_setup() {
-  // module expects shared hardware to be initialised already (Wire, as5600, leds, display, mqttClient)
-  lastRaw = as5600.readAngle();
+  // module expects shared hardware to be initialised already (Wire, as5600, leds, display, mqtt helpers)
   lastIdx = -1;
+  calib_load(MOD_FAMILY, { RAW_OFFSET, HOME_SLICE, 0 });
+  applyCalibration();
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   display.clearDisplay();
-  display.display();
+  displayFlush();
   Serial.println("module_family: setup complete");
 }
 
 void module_family_activate() {
   lastIdx = -1;
+  applyCalibration();  // picks up runtime recalibration
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   Serial.println("module_family: activated");
 }
@@ -94,25 +116,20 @@ void module_family_activate() {
 void module_family_deactivate() {
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   Serial.println("module_family: deactivated");
 }
 
 void module_family_loop() {
-  // keep mqtt loop processing (main.ino should handle reconnect)
-  mqttClient.loop();
-
   // 1) Read raw angle
-  uint16_t raw = as5600.readAngle();
+  uint16_t raw = encoder_read().raw;
 
   // 2) Calibrate & wrap
-  int32_t shifted = int32_t(raw) - int32_t(RAW_OFFSET);
-  if (shifted < 0)        shifted += 4096;
-  else if (shifted >= 4096) shifted -= 4096;
+  int32_t shifted = encoderPhase(raw, RAW_OFFSET);
 
   // 3) Compute slice 0…(SLICE_COUNT-1)
-  uint8_t slice = (shifted * SLICE_COUNT) / 4096;
+  uint8_t slice = slice_update(slicer, raw, millis());
 
   // 4) Map slice → segment index (0…numSegments-1)
   uint8_t idx = (slice + SLICE_COUNT - HOME_SLICE) % SLICE_COUNT;
@@ -128,7 +145,7 @@ void module_family_loop() {
   // LED color
   if (leds && NUM_PIXELS > 0) {
     leds[0] = familyColors[idx];
-    FastLED.show();
+    ledShow();
   }
 
   // Display & MQTT only on change
@@ -143,14 +160,13 @@ void module_family_loop() {
              familyNames[idx],
              familyRels[idx]);
 
-    if (mqttClient.connected()) {
-      mqttClient.publish(pubTopic, payload);
-      Serial.print("MQTT ▶ ");
-      Serial.println(payload);
+    if (mqttIsConnected()) {
+      publishJson(pubTopic, payload);
+      LOGD("published name=%s relation=%s", familyNames[idx], familyRels[idx]);
     } else {
-      Serial.println("MQTT publish skipped — not connected");
+      LOGD("mqtt not connected; publish skipped");
     }
   }
+}
 
-  delay(20);
-}
\ No newline at end of file
+#endif // SPINNER_WITH_FAMILY
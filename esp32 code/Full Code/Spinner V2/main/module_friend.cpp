@@ -1,6 +1,16 @@
 // module_friend.cpp
+#include "build_profile.h"
+#if SPINNER_WITH_FRIEND
+
 #include "module_friend.h"
 #include "shared.h"
+#include "encoder.h"
+#include "slice_quantizer.h"
+#include "calibration.h"
+
+#define LOGGER_TAG "friend"
+#define LOGGER_LEVEL LOG_LEVEL_INFO  // LOG_LEVEL_DEBUG for per-publish traces
+#include "logger.h"
 
 // Fonts used by the display — keep these includes as in your original file
 #include <Fonts/Rabito_font30pt7b.h>  // large
@@ -11,8 +21,8 @@
 // Module-local constants
 namespace {
   const bool DEBUG_RAW = false;
-  const uint16_t RAW_OFFSET = 2019;  // calibrate to your home marker
-  const uint8_t HOME_SLICE = 0;
+  uint16_t RAW_OFFSET = 2019;  // home marker default; a stored calibration overrides it
+  uint8_t HOME_SLICE = 0;
 
   // friend names & assets (same as your sketch)
   const char* friends[] = { "Asha", "Esta", "Seth", "Bo", "Bronn", "School" };
@@ -42,6 +52,17 @@ namespace {
 
   // module-local state (file-scoped)
   int lastIdx = -1;
+  SliceQuantizer slicer = sliceQuantizer(SLICE_COUNT, RAW_OFFSET);
+}
+
+// stored calibration (calibration.h) over the defaults above
+static void applyCalibration() {
+  ModuleCalibration c;
+  if (!calib_get(MOD_FRIEND, c)) return;
+  RAW_OFFSET = c.rawOffset;
+  HOME_SLICE = c.homeSlice % SLICE_COUNT;
+  slicer.offset = RAW_OFFSET;
+  slice_reset(slicer);
 }
 
 // ----- helper functions -----
@@ -61,56 +82,55 @@ static void updateDisplay(int idx) {
   int16_t cy = (SCREEN_H - h) / 2 - y1;
   display.setCursor(cx, cy);
   display.print(name);
-  display.display();
+  displayFlush();
 }
 
 // ----- module API -----
 void module_friend_setup() {
   // module initial state - assume shared hardware (Wire, AS5600, FastLED, display, mqtt) already initialised
   lastIdx = -1;
+  calib_load(MOD_FRIEND, { RAW_OFFSET, HOME_SLICE, 0 });
+  applyCalibration();
   // ensure LED safe state
   leds[0] = CRGB::Black;
-  FastLED.show();
+  ledShow();
   // clear display
   display.clearDisplay();
-  display.display();
+  displayFlush();
   Serial.println("module_friend: setup done");
 }
 
 void module_friend_activate() {
   // reset index so first read forces an update
   lastIdx = -1;
+  applyCalibration();  // picks up runtime recalibration
   leds[0] = CRGB::Black;
-  FastLED.show();
+  ledShow();
   Serial.println("module_friend: activated");
 }
 
 void module_friend_deactivate() {
   // tidy up hardware state when switching away
   leds[0] = CRGB::Black;
-  FastLED.show();
+  ledShow();
   // optionally publish a "stopped" message or disconnect MQTT if needed
   Serial.println("module_friend: deactivated");
 }
 
 void module_friend_loop() {
-  // ensure mqtt alive — we expect mqttClient defined in shared.h
-  if (!mqttClient.connected()) {
-    // don't block here — main.ino should reconnect, but we'll print for debug
+  // mqtt is serviced by the net task — just note it for debug
+  if (!mqttIsConnected()) {
     if (DEBUG_RAW) Serial.println("module_friend: mqtt disconnected");
   }
-  mqttClient.loop();
 
   // 1) read raw angle from shared as5600
-  uint16_t raw = as5600.readAngle();
+  uint16_t raw = encoder_read().raw;
 
   // 2) apply calibration offset & wrap
-  int32_t shifted = int32_t(raw) - RAW_OFFSET;
-  if (shifted < 0) shifted += 4096;
-  else if (shifted >= 4096) shifted -= 4096;
+  int32_t shifted = encoderPhase(raw, RAW_OFFSET);
 
   // 3) compute slice 0…SLICE_COUNT-1
-  uint8_t slice = (shifted * SLICE_COUNT) / 4096;
+  uint8_t slice = slice_update(slicer, raw, millis());
 
   // 4) map slice → friend index
   uint8_t idx = (slice + SLICE_COUNT - HOME_SLICE) % SLICE_COUNT;
@@ -125,20 +145,19 @@ void module_friend_loop() {
     lastIdx = idx;
     // LED
     leds[0] = friendColors[idx];
-    FastLED.show();
+    ledShow();
     // display
     updateDisplay(idx);
     // publish JSON payload
     char payload[64];
     snprintf(payload, sizeof(payload), "{\"name\":\"%s\"}", friends[idx]);
-    if (mqttClient.connected()) {
-      mqttClient.publish(pubTopic, payload);
-      Serial.print("MQTT ▶ ");
-      Serial.println(payload);
+    if (mqttIsConnected()) {
+      publishJson(pubTopic, payload);
+      LOGD("published name=%s", friends[idx]);
     } else {
-      Serial.println("MQTT publish skipped — not connected");
+      LOGD("mqtt not connected; publish skipped");
     }
   }
+}
 
-  delay(20); // tiny sleep so we don't hammer CPU; acceptable for this loop
-}
\ No newline at end of file
+#endif // SPINNER_WITH_FRIEND
@@ -0,0 +1,141 @@
+// module_registry.h
+// Compile-time module registry. Each module is described by a stateless descriptor type:
+//
+//   struct FriendModule : ModuleDefaults {
+//     static constexpr ModuleId ID = MOD_FRIEND;
+//     static constexpr const char* NAME = "friend";
+//     static constexpr uint8_t NEEDS = NEED_DISPLAY | NEED_ENCODER;
+//     static constexpr std::array<TagSpec, 1> TAGS = {{ { uidKeyFromHex("F16B8949") } }};
+//     static constexpr EncoderProfile ENCODER = ENCODER_PROFILE_LOW_NOISE;
+//     static void activate() { module_friend_activate(); }
+//     ...
+//   };
+//
+// ModuleRegistry<Ms...> folds over the descriptor list: hook calls become a compare chain of
+// direct (inlinable) calls on the registry index - no function pointer table, no virtuals -
+// and the tag table, resource needs and limits are all computed by the compiler.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <utility>
+#include "tags.h"
+#include "encoder_source.h"
+
+// resources a module uses while active (ORed into ModuleRegistry::NEEDS)
+enum ModuleNeeds : uint8_t {
+  NEED_DISPLAY = 1 << 0,
+  NEED_ENCODER = 1 << 1,
+  NEED_LED = 1 << 2,
+  NEED_NET = 1 << 3,  // publishes / subscribes, or needs WiFi (NTP)
+};
+
+// one tag a module answers to (album id only for MOD_ALBUM)
+struct TagSpec {
+  UidKey key;
+  const char* album = nullptr;
+};
+
+// Defaults for everything a descriptor may leave out.
+struct ModuleDefaults {
+  static constexpr uint8_t NEEDS = 0;
+  static constexpr uint8_t SUBSCRIPTIONS = 0;  // broker subscriptions held at once
+  static constexpr uint8_t ROUTES = 0;         // mqtt_route() patterns registered in setup()
+  static constexpr std::array<TagSpec, 0> TAGS{};
+  static constexpr EncoderProfile ENCODER = ENCODER_PROFILE_LOW_NOISE;  // AS5600 CONF while active
+
+  static void setup() {}
+  static void activate() {}
+  static void deactivate() {}
+  static void loop() {}
+};
+
+template <class... Ms>
+struct ModuleRegistry {
+  static constexpr int COUNT = sizeof...(Ms);
+  static constexpr uint8_t NEEDS = (Ms::NEEDS | ... | 0);
+  static constexpr size_t SUBSCRIPTIONS = (size_t(Ms::SUBSCRIPTIONS) + ... + 0);
+  static constexpr size_t ROUTES = (size_t(Ms::ROUTES) + ... + 0);
+  static constexpr size_t TAG_COUNT = (Ms::TAGS.size() + ... + 0);
+
+  // every descriptor's TAGS, flattened into one table for the perfect hash
+  static constexpr std::array<TagEntry, TAG_COUNT> tags() {
+    std::array<TagEntry, TAG_COUNT> out{};
+    size_t n = 0;
+    (appendTags<Ms>(out, n), ...);
+    (void)n;  // unused for an empty registry
+    return out;
+  }
+
+  // registry index of `id`, -1 when the build profile left the module out
+  static constexpr int indexOf(ModuleId id) {
+    int i = 0, found = -1;
+    ((found = (Ms::ID == id && found < 0) ? i : found, ++i), ...);
+    return found;
+  }
+
+  static constexpr bool uniqueIds() {
+    constexpr ModuleId ids[] = { Ms::ID..., MOD_COUNT };
+    for (int i = 0; i < COUNT; ++i) {
+      if (ids[i] >= MOD_COUNT) return false;
+      for (int j = i + 1; j < COUNT; ++j) if (ids[i] == ids[j]) return false;
+    }
+    return true;
+  }
+
+  static ModuleId id(int idx) {
+    ModuleId out = MOD_COUNT;
+    visit(idx, [&](auto m) { out = decltype(m)::ID; });
+    return out;
+  }
+
+  static const char* name(int idx) {
+    const char* out = "?";
+    visit(idx, [&](auto m) { out = decltype(m)::NAME; });
+    return out;
+  }
+
+  static EncoderProfile encoderProfile(int idx) {
+    EncoderProfile out = ENCODER_PROFILE_IDLE;
+    visit(idx, [&](auto m) { out = decltype(m)::ENCODER; });
+    return out;
+  }
+
+  static void setup(int idx) { visit(idx, [](auto m) { decltype(m)::setup(); }); }
+  static void activate(int idx) { visit(idx, [](auto m) { decltype(m)::activate(); }); }
+  static void deactivate(int idx) { visit(idx, [](auto m) { decltype(m)::deactivate(); }); }
+  static void loop(int idx) { visit(idx, [](auto m) { decltype(m)::loop(); }); }
+
+ private:
+  template <class M, size_t N>
+  static constexpr void appendTags(std::array<TagEntry, N>& out, size_t& n) {
+    for (const TagSpec& t : M::TAGS) out[n++] = TagEntry{ t.key, M::ID, t.album };
+  }
+
+  template <class F, size_t... I>
+  static void visitImpl(int idx, F&& f, std::index_sequence<I...>) {
+    (void)((idx == int(I) && (f(Ms{}), true)) || ...);
+  }
+
+  template <class F>
+  static void visit(int idx, F&& f) {
+    visitImpl(idx, f, std::index_sequence_for<Ms...>{});
+  }
+};
+
+// ModuleRegistryOf<Use<ON, M>...>::type = ModuleRegistry of the Ms whose ON is true.
+template <bool On, class M> struct Use {};
+
+template <class Reg, class... Us> struct ModuleRegistryCollect { using type = Reg; };
+template <class... Ms, class M, class... Rest>
+struct ModuleRegistryCollect<ModuleRegistry<Ms...>, Use<true, M>, Rest...> {
+  using type = typename ModuleRegistryCollect<ModuleRegistry<Ms..., M>, Rest...>::type;
+};
+template <class... Ms, class M, class... Rest>
+struct ModuleRegistryCollect<ModuleRegistry<Ms...>, Use<false, M>, Rest...> {
+  using type = typename ModuleRegistryCollect<ModuleRegistry<Ms...>, Rest...>::type;
+};
+
+template <class... Us>
+using ModuleRegistryOf = typename ModuleRegistryCollect<ModuleRegistry<>, Us...>::type;
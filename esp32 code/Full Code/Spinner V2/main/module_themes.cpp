@@ -2,8 +2,18 @@
 // 9-segment themes spinner with per-theme font support.
 // Publishes JSON to MQTT topic "spinner/themes" when focus changes.
 
+#include "build_profile.h"
+#if SPINNER_WITH_THEMES
+
 #include "module_themes.h"
 #include "shared.h"
+#include "encoder.h"
+#include "slice_quantizer.h"
+#include "calibration.h"
+
+#define LOGGER_TAG "themes"
+#define LOGGER_LEVEL LOG_LEVEL_INFO  // LOG_LEVEL_DEBUG for per-publish traces
+#include "logger.h"
 
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
@@ -69,13 +79,26 @@ namespace {
   int themeYoffsets[SLICE_COUNT] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
   // small mapping offset (if you want to rotate which physical angle maps to slice0)
-  // To calibrate, set RAW_OFFSET to the `raw` value printed by Serial when DEBUG==true
+  // To calibrate, set RAW_OFFSET to the `raw` value printed by Serial when DEBUG==true, or
+  // store it at runtime (calibration tag / MQTT, see calibration.h), which overrides these.
   uint16_t RAW_OFFSET = 170;
+  uint8_t HOME_SLICE = 0;
 
   int lastIdx = -1;
+  SliceQuantizer slicer = sliceQuantizer(SLICE_COUNT, RAW_OFFSET);
   bool active = false;
 } // namespace
 
+// stored calibration (calibration.h) over the defaults above
+static void applyCalibration() {
+  ModuleCalibration c;
+  if (!calib_get(MOD_THEMES, c)) return;
+  RAW_OFFSET = c.rawOffset;
+  HOME_SLICE = c.homeSlice % SLICE_COUNT;
+  slicer.offset = RAW_OFFSET;
+  slice_reset(slicer);
+}
+
 // draw centered with the theme-specific font (safe fallback if null)
 static void drawCenteredWithFont(const char* txt, const GFXfont* f, int yNudge) {
   display.clearDisplay();
@@ -93,28 +116,31 @@ static void drawCenteredWithFont(const char* txt, const GFXfont* f, int yNudge)
   int16_t cy = (SCREEN_H - (int)bh) / 2 - by + yNudge;
   display.setCursor(cx, cy);
   display.print(txt);
-  display.display();
+  displayFlush();
 }
 
 void module_themes_setup() {
   lastIdx = -1;
+  calib_load(MOD_THEMES, { RAW_OFFSET, HOME_SLICE, 0 });
+  applyCalibration();
   active = false;
-  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; FastLED.show(); }
-  display.clearDisplay(); display.display();
+  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; ledShow(); }
+  display.clearDisplay(); displayFlush();
   if (DEBUG) Serial.println("module_themes: setup");
 }
 
 void module_themes_activate() {
   lastIdx = -1; // force first update
+  applyCalibration();  // picks up runtime recalibration
   active = true;
-  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; FastLED.show(); }
+  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; ledShow(); }
   if (DEBUG) Serial.println("module_themes: activated");
 }
 
 void module_themes_deactivate() {
   active = false;
-  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; FastLED.show(); }
-  display.clearDisplay(); display.display();
+  if (leds && NUM_PIXELS > 0) { leds[0] = CRGB::Black; ledShow(); }
+  display.clearDisplay(); displayFlush();
   if (DEBUG) Serial.println("module_themes: deactivated");
 }
 
@@ -122,13 +148,11 @@ void module_themes_loop() {
   if (!active) return;
 
   // read raw and map to slice
-  uint16_t raw = as5600.readAngle();
-  int32_t shifted = int32_t(raw) - int32_t(RAW_OFFSET);
-  if (shifted < 0) shifted += 4096;
-  else if (shifted >= 4096) shifted -= 4096;
+  uint16_t raw = encoder_read().raw;
+  int32_t shifted = encoderPhase(raw, RAW_OFFSET);
 
-  uint8_t slice = (shifted * SLICE_COUNT) / 4096;
-  uint8_t idx = slice % SLICE_COUNT;
+  uint8_t slice = slice_update(slicer, raw, millis());
+  uint8_t idx = (slice + SLICE_COUNT - HOME_SLICE) % SLICE_COUNT;
 
   if (DEBUG) {
     Serial.print("module_themes: raw="); Serial.print(raw);
@@ -145,7 +169,7 @@ void module_themes_loop() {
     // LED
     if (leds && NUM_PIXELS > 0) {
       leds[0] = themeColors[idx];
-      FastLED.show();
+      ledShow();
     }
 
     // display with optional per-theme y-nudge
@@ -156,19 +180,14 @@ void module_themes_loop() {
     char payload[128];
     snprintf(payload, sizeof(payload), "{\"name\":\"%s\",\"idx\":%d}", themes[idx], idx);
     
-    if (mqttClient.connected()) {
-      mqttClient.publish(pubTopic, payload);
-      if (DEBUG) {
-        Serial.print("module_themes: mqtt -> "); Serial.println(payload);
-      } else {
-        Serial.print("module_themes: focused: "); Serial.println(themes[idx]);
-      }
+    LOGI("focused: %s", themes[idx]);
+    if (mqttIsConnected()) {
+      publishJson(pubTopic, payload);
+      LOGD("published name=%s idx=%d", themes[idx], idx);
     } else {
-      Serial.print("module_themes: focused: ");
-      Serial.println(themes[idx]);
-      Serial.println("module_themes: mqtt not connected, publish skipped");
+      LOGD("mqtt not connected; publish skipped");
     }
   }
+}
 
-  delay(20);
-}
\ No newline at end of file
+#endif // SPINNER_WITH_THEMES
@@ -4,8 +4,13 @@
 // Encoder angle (AS5600) maps to a label index; the focused label is centered.
 // Written to plug into your existing shared.h (as5600, display, leds, NUM_PIXELS).
 
+#include "build_profile.h"
+#if SPINNER_WITH_TIMELINE
+
 #include "module_timeline.h"
 #include "shared.h"
+#include "encoder.h"
+#include "font_metrics.h"
 
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
@@ -73,7 +78,7 @@ static void buildLabels()
 // Map AS5600 raw angle (0..4095) to 0..labelsCount-1
 static int angleToIndex()
 {
-  uint16_t raw = as5600.readAngle();
+  uint16_t raw = encoder_read().raw;
   uint16_t val = REVERSE_DIRECTION ? (4095 - raw) : raw;
   // Guard: labelsCount should be > 0
   if (labelsCount <= 0) return 0;
@@ -85,9 +90,8 @@ static int angleToIndex()
 
 static void drawCenteredTextAtX(const String &txt, int x, int y)
 {
-  int16_t bx, by; uint16_t bw, bh;
-  display.getTextBounds(txt.c_str(), 0, 0, &bx, &by, &bw, &bh);
-  int cx = x - ((int)bw / 2) - bx;
+  TextBounds b = font_textBounds(LABEL_FONT, txt.c_str());
+  int cx = x - ((int)b.w / 2) - b.x;
   display.setCursor(cx, y);
   display.print(txt);
 }
@@ -103,7 +107,7 @@ void module_timeline_setup()
   // initial LED
   if (leds && NUM_PIXELS > 0) {
     leds[0] = DEFAULT_COLOR;
-    FastLED.show();
+    ledShow();
   }
   if (DEBUG) Serial.println("module_timeline: setup complete");
 }
@@ -114,7 +118,7 @@ void module_timeline_activate()
   if (!labels.size()) buildLabels();
   if (leds && NUM_PIXELS > 0) {
     leds[0] = DEFAULT_COLOR;
-    FastLED.show();
+    ledShow();
   }
   if (DEBUG) Serial.println("module_timeline: activated");
 }
@@ -124,7 +128,7 @@ void module_timeline_deactivate()
   active = false;
   if (leds && NUM_PIXELS > 0) {
     leds[0] = CRGB::Black;
-    FastLED.show();
+    ledShow();
   }
   if (DEBUG) Serial.println("module_timeline: deactivated");
 }
@@ -143,7 +147,7 @@ void module_timeline_loop()
     String lab = labels[focused];
     if (lab.endsWith("12m") || lab.endsWith("24m") || lab.endsWith("36m")) leds[0] = HIGHLIGHT_COLOR;
     else leds[0] = DEFAULT_COLOR;
-    FastLED.show();
+    ledShow();
   }
 
   // draw background / baseline
@@ -192,12 +196,12 @@ void module_timeline_loop()
   } else {
     snprintf(status, sizeof(status), "Age: %s", lab.c_str());
   }
-  int16_t sx, sy; uint16_t sw, sh;
-  display.getTextBounds(status, 0, 0, &sx, &sy, &sw, &sh);
+  TextBounds sb = font_textBounds(LABEL_FONT, status);
   int statusY = TIMELINE_BASE_Y + TICK_H + 14 + STATUS_Y_OFFSET;
-  display.setCursor((SCREEN_W - (int)sw) / 2 - sx, statusY);
+  display.setCursor((SCREEN_W - (int)sb.w) / 2 - sb.x, statusY);
   display.print(status);
 
-  display.display();
-  delay(10);
-}
\ No newline at end of file
+  displayFlush();
+}
+
+#endif // SPINNER_WITH_TIMELINE
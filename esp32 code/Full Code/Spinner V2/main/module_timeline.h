@@ -1,3 +1,15 @@
+// module_timeline.h
+#pragma once
+
+// Module API used by main.ino
+void module_timeline_setup();
+void module_timeline_activate();
+void module_timeline_deactivate();
+void module_timeline_loop();
+
+void module_timeline_enable(bool on);
+bool module_timeline_isEnabled();
+
 const int MAX_MONTHS = 36;
 const float BIRTH_CM = 50.0f;
 const float MAX_CM = 95.0f;
@@ -0,0 +1,176 @@
+// modules.h
+// The module descriptors and the registry this build runs (see module_registry.h).
+//
+// To add a module: give it a ModuleId (tags.h), a descriptor below, a SPINNER_WITH_* switch in
+// build_profile.h and a Use<> line in Modules. Tags, resource needs and limits are checked by
+// the compiler; nothing else has to be kept in sync.
+#pragma once
+
+#include "build_profile.h"
+#include "module_registry.h"
+#include "net.h"
+#include "mqtt_router.h"
+#include "calibration.h"
+#include "module_friend.h"
+#include "module_family.h"
+#include "module_date.h"
+#include "module_days.h"
+#include "module_distance.h"
+#include "module_timeline.h"
+#include "module_cousins.h"
+#include "module_afamily.h"
+#include "module_themes.h"
+#include "module_album.h"
+
+const uint8_t NEED_WHEEL = NEED_DISPLAY | NEED_ENCODER | NEED_LED;
+
+struct FriendModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_FRIEND;
+  static constexpr const char* NAME = "friend";
+  static constexpr uint8_t NEEDS = NEED_WHEEL | NEED_NET;
+  static constexpr std::array<TagSpec, 1> TAGS = {{ { uidKeyFromHex("F16B8949") } }};
+  static void setup() { module_friend_setup(); }
+  static void activate() { module_friend_activate(); }
+  static void deactivate() { module_friend_deactivate(); }
+  static void loop() { module_friend_loop(); }
+};
+
+struct FamilyModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_FAMILY;
+  static constexpr const char* NAME = "family";
+  static constexpr uint8_t NEEDS = NEED_WHEEL | NEED_NET;
+  static constexpr std::array<TagSpec, 1> TAGS = {{ { uidKeyFromHex("91798949") } }};
+  static void setup() { module_family_setup(); }
+  static void activate() { module_family_activate(); }
+  static void deactivate() { module_family_deactivate(); }
+  static void loop() { module_family_loop(); }
+};
+
+struct DateModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_DATE;
+  static constexpr const char* NAME = "date";
+  static constexpr uint8_t NEEDS = NEED_WHEEL | NEED_NET;
+  static constexpr std::array<TagSpec, 1> TAGS = {{ { uidKeyFromHex("A1778949") } }};
+  static void setup() { module_date_setup(); }
+  static void activate() { module_date_activate(); }
+  static void deactivate() { module_date_deactivate(); }
+  static void loop() { module_date_loop(); }
+};
+
+struct DaysModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_DAYS;
+  static constexpr const char* NAME = "days";
+  static constexpr uint8_t NEEDS = NEED_WHEEL | NEED_NET;  // NTP
+  static constexpr std::array<TagSpec, 1> TAGS = {{ { uidKeyFromHex("C19D8949") } }};
+  static void setup() { module_days_setup(); }
+  static void activate() { module_days_activate(); }
+  static void deactivate() { module_days_deactivate(); }
+  static void loop() { module_days_loop(); }
+};
+
+struct DistanceModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_DISTANCE;
+  static constexpr const char* NAME = "distance";
+  static constexpr uint8_t NEEDS = NEED_WHEEL | NEED_NET;
+  static constexpr EncoderProfile ENCODER = ENCODER_PROFILE_FAST;
+  static constexpr std::array<TagSpec, 1> TAGS = {{ { uidKeyFromHex("1D0B1CBB8A0000") } }};
+  static void setup() { module_distance_setup(); }
+  static void activate() { module_distance_activate(); }
+  static void deactivate() { module_distance_deactivate(); }
+  static void loop() { module_distance_loop(); }
+};
+
+// no tag yet: set up, but not selectable
+struct TimelineModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_TIMELINE;
+  static constexpr const char* NAME = "timeline";
+  static constexpr uint8_t NEEDS = NEED_WHEEL;
+  static void setup() { module_timeline_setup(); }
+  static void activate() { module_timeline_activate(); }
+  static void deactivate() { module_timeline_deactivate(); }
+  static void loop() { module_timeline_loop(); }
+};
+
+struct CousinsModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_COUSINS;
+  static constexpr const char* NAME = "cousins";
+  static constexpr uint8_t NEEDS = NEED_WHEEL | NEED_NET;
+  static constexpr std::array<TagSpec, 1> TAGS = {{ { uidKeyFromHex("D19B8949") } }};
+  static void setup() { module_cousins_setup(); }
+  static void activate() { module_cousins_activate(); }
+  static void deactivate() { module_cousins_deactivate(); }
+  static void loop() { module_cousins_loop(); }
+};
+
+struct AfamilyModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_AFAMILY;
+  static constexpr const char* NAME = "afamily";
+  static constexpr uint8_t NEEDS = NEED_WHEEL | NEED_NET;
+  static constexpr std::array<TagSpec, 1> TAGS = {{ { uidKeyFromHex("E1998949") } }};
+  static void setup() { module_afamily_setup(); }
+  static void activate() { module_afamily_activate(); }
+  static void deactivate() { module_afamily_deactivate(); }
+  static void loop() { module_afamily_loop(); }
+};
+
+struct ThemesModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_THEMES;
+  static constexpr const char* NAME = "themes";
+  static constexpr uint8_t NEEDS = NEED_WHEEL | NEED_NET;
+  static constexpr std::array<TagSpec, 1> TAGS = {{ { uidKeyFromHex("81AD8949") } }};
+  static void setup() { module_themes_setup(); }
+  static void activate() { module_themes_activate(); }
+  static void deactivate() { module_themes_deactivate(); }
+  static void loop() { module_themes_loop(); }
+};
+
+// one module, one album per tag
+struct AlbumModule : ModuleDefaults {
+  static constexpr ModuleId ID = MOD_ALBUM;
+  static constexpr const char* NAME = "album";
+  static constexpr uint8_t NEEDS = NEED_WHEEL | NEED_NET;
+  static constexpr EncoderProfile ENCODER = ENCODER_PROFILE_FAST;  // scrubbing
+  static constexpr uint8_t SUBSCRIPTIONS = 1;  // spinner/album/<id>/photo
+  static constexpr uint8_t ROUTES = 1;         // spinner/album/+/photo
+  static constexpr std::array<TagSpec, 2> TAGS = {{
+    { uidKeyFromHex("C1A18949"), "at3k2ggmwen1awna" },  // baby
+    { uidKeyFromHex("41AF8949"), "at3k2guo8gcj8w5m" },  // toddler
+  }};
+  static void setup() { module_album_setup(); }
+  static void activate() { module_album_activate(); }
+  static void deactivate() { module_album_deactivate(); }
+  static void loop() { module_album_loop(); }
+};
+
+// Registry order = setup order.
+using Modules = ModuleRegistryOf<
+  Use<SPINNER_WITH_FRIEND, FriendModule>,
+  Use<SPINNER_WITH_FAMILY, FamilyModule>,
+  Use<SPINNER_WITH_DATE, DateModule>,
+  Use<SPINNER_WITH_DAYS, DaysModule>,
+  Use<SPINNER_WITH_DISTANCE, DistanceModule>,
+  Use<SPINNER_WITH_TIMELINE, TimelineModule>,
+  Use<SPINNER_WITH_COUSINS, CousinsModule>,
+  Use<SPINNER_WITH_AFAMILY, AfamilyModule>,
+  Use<SPINNER_WITH_THEMES, ThemesModule>,
+  Use<SPINNER_WITH_ALBUM, AlbumModule>
+>;
+
+static_assert(Modules::uniqueIds(), "two descriptors share a ModuleId");
+static_assert(MOD_COUNT <= 32, "ModuleId doubles as a subscription owner bit");
+static_assert(Modules::SUBSCRIPTIONS + CALIB_SUBSCRIPTIONS <= NET_MAX_SUBSCRIPTIONS, "modules hold more subscriptions than net.cpp can track");
+static_assert(Modules::ROUTES + CALIB_ROUTES <= MQTT_MAX_ROUTES, "modules register more MQTT routes than mqtt_router.cpp has");
+static_assert(MOD_COUNT < 32, "calibration.cpp subscribes as owner MOD_COUNT");
+
+inline constexpr auto TAGS = Modules::tags();
+inline constexpr auto TAG_HASH = uidBuildPerfectHash(TAGS);
+static_assert(TAG_HASH.seed != 0, "duplicate UID in module TAGS");
+
+constexpr bool tagsWellFormed() {
+  for (const TagEntry& t : TAGS) {
+    if (t.key.len == 0) return false;
+    if ((t.module == MOD_ALBUM) != (t.album != nullptr)) return false;
+  }
+  return true;
+}
+static_assert(tagsWellFormed(), "bad hex UID in module TAGS, or album id missing/misplaced");
@@ -0,0 +1,161 @@
+// mqtt_router.cpp
+// Pattern trie + dispatch for inbound MQTT (see mqtt_router.h).
+#include "mqtt_router.h"
+
+#define LOGGER_TAG "mqtt"
+#define LOGGER_LEVEL LOG_LEVEL_INFO  // LOG_LEVEL_DEBUG echoes every inbound message
+#include "logger.h"
+
+#include <Arduino.h>
+
+namespace {
+
+// ===== CONFIG =====
+const int MAX_NODES = 32;
+
+// One trie level. Segments point into the registered pattern strings, nothing is copied.
+struct Node {
+  const char* seg;
+  uint8_t segLen;
+  int8_t child;       // first child, -1 = none
+  int8_t sibling;     // next sibling, -1 = none
+  int8_t firstRoute;  // routes ending at this node, -1 = none
+};
+
+struct Route {
+  MqttHandler handler;
+  void* ctx;
+  int8_t next;  // next route on the same node
+};
+
+// ===== STATE =====
+Node nodes[MAX_NODES] = { { "", 0, -1, -1, -1 } };  // [0] = root
+int nodeCount = 1;
+Route routes[MQTT_MAX_ROUTES];
+int routeCount = 0;
+
+MqttRouterStats stats = {};
+
+static bool isWildcard(const Node& n, char w) {
+  return n.segLen == 1 && n.seg[0] == w;
+}
+
+static size_t levelLen(const char* level) {
+  const char* slash = strchr(level, '/');
+  return slash ? size_t(slash - level) : strlen(level);
+}
+
+static int findOrAddChild(int parent, const char* seg, uint8_t segLen) {
+  int last = -1;
+  for (int c = nodes[parent].child; c >= 0; c = nodes[c].sibling) {
+    if (nodes[c].segLen == segLen && memcmp(nodes[c].seg, seg, segLen) == 0) return c;
+    last = c;
+  }
+  if (nodeCount >= MAX_NODES) return -1;
+  int idx = nodeCount++;
+  nodes[idx] = { seg, segLen, -1, -1, -1 };
+  if (last < 0) nodes[parent].child = int8_t(idx);
+  else nodes[last].sibling = int8_t(idx);
+  return idx;
+}
+
+static void fire(int node, const MqttMessage& msg, int& hits) {
+  for (int r = nodes[node].firstRoute; r >= 0; r = routes[r].next) {
+    routes[r].handler(msg, routes[r].ctx);
+    ++hits;
+  }
+}
+
+// `level` = start of the current topic level, nullptr once the topic is exhausted.
+static void match(int node, const char* level, const MqttMessage& msg, int& hits) {
+  if (!level) {
+    fire(node, msg, hits);
+    // "a/#" also matches "a"
+    for (int c = nodes[node].child; c >= 0; c = nodes[c].sibling) {
+      if (isWildcard(nodes[c], '#')) fire(c, msg, hits);
+    }
+    return;
+  }
+
+  size_t len = levelLen(level);
+  const char* next = level[len] == '/' ? level + len + 1 : nullptr;
+  for (int c = nodes[node].child; c >= 0; c = nodes[c].sibling) {
+    const Node& n = nodes[c];
+    if (isWildcard(n, '#')) {
+      fire(c, msg, hits);
+    } else if (isWildcard(n, '+') || (n.segLen == len && memcmp(n.seg, level, len) == 0)) {
+      match(c, next, msg, hits);
+    }
+  }
+}
+
+// the logger keeps at most LOG_STR_MAX bytes of a string, so only a preview is copied
+static void logMessage(const MqttMessage& msg) {
+  char preview[LOG_STR_MAX + 1];
+  size_t n = msg.length < LOG_STR_MAX ? msg.length : LOG_STR_MAX;
+  memcpy(preview, msg.payload, n);
+  preview[n] = '\0';
+  LOGD("in %s (%u bytes) %s%s", msg.topic, (unsigned)msg.length, preview, n < msg.length ? "..." : "");
+}
+
+} // namespace
+
+bool mqtt_route(const char* pattern, MqttHandler handler, void* ctx) {
+  if (!pattern || !*pattern || !handler || routeCount >= MQTT_MAX_ROUTES) return false;
+
+  int node = 0;
+  const char* level = pattern;
+  for (;;) {
+    size_t len = levelLen(level);
+    bool last = level[len] == '\0';
+    // wildcards must fill a whole level, and '#' must be the last one
+    for (size_t i = 0; i < len; ++i) {
+      if ((level[i] == '+' || level[i] == '#') && len != 1) return false;
+    }
+    if (len == 1 && level[0] == '#' && !last) return false;
+    if (len > 255) return false;
+
+    node = findOrAddChild(node, level, uint8_t(len));
+    if (node < 0) {
+      LOGE("router full, dropping %s", pattern);
+      return false;
+    }
+    if (last) break;
+    level += len + 1;
+  }
+
+  Route& r = routes[routeCount];
+  r.handler = handler;
+  r.ctx = ctx;
+  r.next = nodes[node].firstRoute;
+  nodes[node].firstRoute = int8_t(routeCount++);
+  return true;
+}
+
+void mqtt_dispatch(char* topic, byte* payload, unsigned int length) {
+  MqttMessage msg = { topic, payload, length };
+  if (LOGGER_LEVEL >= LOG_LEVEL_DEBUG) logMessage(msg);
+
+  int hits = 0;
+  match(0, topic, msg, hits);
+  stats.delivered += hits;
+  if (hits == 0) {
+    ++stats.unmatched;
+    LOGD("no route for %s", topic);
+  }
+}
+
+const char* mqtt_topicLevel(const char* topic, uint8_t level, size_t* len) {
+  if (!topic) return nullptr;
+  for (uint8_t i = 0; i < level; ++i) {
+    topic = strchr(topic, '/');
+    if (!topic) return nullptr;
+    ++topic;
+  }
+  if (len) *len = levelLen(topic);
+  return topic;
+}
+
+MqttRouterStats mqtt_routerStats() {
+  return stats;
+}
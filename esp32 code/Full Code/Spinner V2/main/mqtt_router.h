@@ -0,0 +1,40 @@
+// mqtt_router.h
+// Topic-routed MQTT dispatch. Modules register topic patterns (MQTT wildcards: `+` for one
+// level, `#` for the rest) once in setup(); inbound messages are matched against a small trie
+// of those patterns and handed to every matching handler.
+//
+// Handlers run on the net task, inside the PubSubClient callback. The message is a view into
+// PubSubClient's receive buffer: it is not copied, not NUL-terminated, and only valid until the
+// handler returns. Parse or copy what you need, then hand it to the render side (a queue) -
+// never draw or block from a handler.
+#pragma once
+
+#include <Arduino.h>
+
+struct MqttMessage {
+  const char* topic;       // NUL-terminated
+  const uint8_t* payload;  // NOT NUL-terminated
+  size_t length;
+};
+
+const int MQTT_MAX_ROUTES = 16;  // patterns across all modules
+
+typedef void (*MqttHandler)(const MqttMessage& msg, void* ctx);
+
+// setup() only (before tasks_start()): the trie is read lock-free by the net task afterwards.
+// `pattern` must outlive the router (string literal). Returns false on a malformed pattern or
+// when the node/route pools are full.
+bool mqtt_route(const char* pattern, MqttHandler handler, void* ctx = nullptr);
+
+// PubSubClient callback (registered by net_begin()).
+void mqtt_dispatch(char* topic, byte* payload, unsigned int length);
+
+// Zero-copy access to topic level `level` (0-based); sets *len, nullptr if there is no such level.
+const char* mqtt_topicLevel(const char* topic, uint8_t level, size_t* len);
+
+// counters for diagnostics
+struct MqttRouterStats {
+  uint32_t delivered;  // handler invocations
+  uint32_t unmatched;  // messages no pattern matched
+};
+MqttRouterStats mqtt_routerStats();
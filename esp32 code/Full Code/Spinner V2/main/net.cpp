@@ -0,0 +1,278 @@
+// net.cpp
+// WiFi/MQTT connection state machine with exponential backoff + jitter (see net.h).
+#include "net.h"
+#include "shared.h"
+#include "tasks.h"
+#include "mqtt_router.h"
+
+#define LOGGER_TAG "net"
+#define LOGGER_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+
+namespace {
+
+// ===== CONFIG =====
+const unsigned long WIFI_CONNECT_TIMEOUT_MS = 10000;  // re-issue WiFi.begin() after this
+const unsigned long BACKOFF_BASE_MS = 500;
+const unsigned long BACKOFF_MAX_MS = 30000;
+const uint16_t MQTT_SOCKET_TIMEOUT_S = 2;             // bounds the one blocking call we make
+// PubSubClient's receive buffer. Router handlers read payloads in place, so this is the
+// largest message we can take (MQTT_MAX_PACKET_SIZE in main.ino never reaches the library).
+const uint16_t MQTT_BUFFER_SIZE = 4096;
+// A topic the broker keeps refusing is retried with backoff, then left alone until the next
+// broker session (or until its owner asks for it again).
+const unsigned long SUB_RETRY_BASE_MS = 500;
+const uint8_t SUB_MAX_FAILURES = 5;
+
+struct Subscription {
+  char topic[TASK_TOPIC_MAX];
+  uint32_t owners;  // bit per owning module; the broker subscription lives while any is set
+  bool live;        // subscribed on the current broker session
+  uint8_t failures;  // consecutive failed subscribes this session
+  unsigned long retryAtMs;
+};
+
+// ===== STATE =====
+const char* wifiSsid = nullptr;
+const char* wifiPwd = nullptr;
+
+volatile NetState state = NET_WIFI_CONNECTING;
+NetState afterBackoff = NET_WIFI_CONNECTING;
+unsigned long stateSinceMs = 0;
+unsigned long backoffUntilMs = 0;
+uint8_t failures = 0;  // consecutive failed attempts, drives the backoff
+volatile uint32_t session = 0;
+
+char deviceId[24];  // esp32-<mac>, also the MQTT client id
+
+Subscription subs[NET_MAX_SUBSCRIPTIONS];
+NetStats stats = {};
+
+static const char* stateName(NetState s) {
+  switch (s) {
+    case NET_WIFI_CONNECTING: return "wifi-connecting";
+    case NET_MQTT_CONNECTING: return "mqtt-connecting";
+    case NET_ONLINE: return "online";
+    case NET_BACKOFF: return "backoff";
+  }
+  return "?";
+}
+
+static void enter(NetState s, unsigned long nowMs) {
+  if (s == state) return;
+  LOGI("%s -> %s", stateName(state), stateName(s));
+  state = s;
+  stateSinceMs = nowMs;
+}
+
+// exponential backoff with +/-25% jitter so a fleet doesn't hammer the broker in lockstep
+static void backoff(NetState next, unsigned long nowMs) {
+  unsigned long delayMs = BACKOFF_BASE_MS << (failures < 6 ? failures : 6);
+  if (delayMs > BACKOFF_MAX_MS) delayMs = BACKOFF_MAX_MS;
+  delayMs = delayMs * 3 / 4 + esp_random() % (delayMs / 2 + 1);
+  if (failures < 255) ++failures;
+
+  afterBackoff = next;
+  backoffUntilMs = nowMs + delayMs;
+  LOGD("retry in %lums (failures=%u)", delayMs, failures);
+  enter(NET_BACKOFF, nowMs);
+}
+
+static void resetSubscription(Subscription& sub) {
+  sub.live = false;
+  sub.failures = 0;
+  sub.retryAtMs = 0;
+}
+
+static void markAllSubscriptionsStale() {
+  for (size_t i = 0; i < NET_MAX_SUBSCRIPTIONS; ++i) resetSubscription(subs[i]);
+}
+
+// Broker connected only. A failure schedules a retry (doubling) until SUB_MAX_FAILURES.
+static void trySubscribe(Subscription& sub, unsigned long nowMs) {
+  if (mqttClient.subscribe(sub.topic, 0)) {
+    sub.live = true;
+    sub.failures = 0;
+    LOGD("subscribed %s", sub.topic);
+    return;
+  }
+  ++stats.subscribeFailures;
+  if (++sub.failures >= SUB_MAX_FAILURES) {
+    ++stats.subscribeGiveUps;
+    LOGW("subscribe %s failed %u times, giving up this session", sub.topic, sub.failures);
+    return;
+  }
+  sub.retryAtMs = nowMs + (SUB_RETRY_BASE_MS << (sub.failures - 1));
+  LOGD("subscribe %s failed, retry %u", sub.topic, sub.failures);
+}
+
+// (re)subscribe every topic that is due; the writes don't wait for a SUBACK
+static void subscribePending(unsigned long nowMs) {
+  for (size_t i = 0; i < NET_MAX_SUBSCRIPTIONS; ++i) {
+    Subscription& sub = subs[i];
+    if (!sub.owners || sub.live || sub.failures >= SUB_MAX_FAILURES) continue;
+    if ((long)(nowMs - sub.retryAtMs) < 0) continue;
+    trySubscribe(sub, nowMs);
+  }
+}
+
+static void tryBroker(unsigned long nowMs) {
+  if (mqttClient.connect(net_deviceId())) {
+    ++stats.mqttConnects;
+    ++session;
+    failures = 0;
+    markAllSubscriptionsStale();
+    enter(NET_ONLINE, nowMs);
+    subscribePending(nowMs);  // before anything queued gets published on the new session
+  } else {
+    ++stats.mqttFailures;
+    LOGW("mqtt connect failed, rc=%d", mqttClient.state());
+    backoff(NET_MQTT_CONNECTING, nowMs);
+  }
+}
+
+} // namespace
+
+void net_begin(const char* ssid, const char* pwd, const char* server, uint16_t port) {
+  wifiSsid = ssid;
+  wifiPwd = pwd;
+
+  mqttClient.setServer(server, port);
+  mqttClient.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
+  if (!mqttClient.setBufferSize(MQTT_BUFFER_SIZE)) LOGE("MQTT buffer alloc failed");
+  // all inbound messages go through the topic router
+  mqttClient.setCallback(mqtt_dispatch);
+
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(true);
+  WiFi.begin(wifiSsid, wifiPwd);
+  state = NET_WIFI_CONNECTING;
+  stateSinceMs = millis();
+  LOGI("connecting to WiFi %s", wifiSsid);
+}
+
+void net_tick(unsigned long nowMs) {
+  bool wifiUp = WiFi.status() == WL_CONNECTED;
+
+  // losing WiFi trumps everything else
+  if (!wifiUp && state != NET_WIFI_CONNECTING && !(state == NET_BACKOFF && afterBackoff == NET_WIFI_CONNECTING)) {
+    ++stats.wifiDrops;
+    // the old socket can still look open; connect() would return true on it without a CONNECT
+    mqttClient.disconnect();
+    markAllSubscriptionsStale();
+    enter(NET_WIFI_CONNECTING, nowMs);
+  }
+
+  switch (state) {
+    case NET_WIFI_CONNECTING:
+      if (wifiUp) {
+        failures = 0;
+        enter(NET_MQTT_CONNECTING, nowMs);
+      } else if (nowMs - stateSinceMs >= WIFI_CONNECT_TIMEOUT_MS) {
+        WiFi.disconnect();
+        backoff(NET_WIFI_CONNECTING, nowMs);
+      }
+      break;
+
+    case NET_BACKOFF:
+      if ((long)(nowMs - backoffUntilMs) >= 0) {
+        if (afterBackoff == NET_WIFI_CONNECTING) WiFi.begin(wifiSsid, wifiPwd);
+        enter(afterBackoff, nowMs);
+      }
+      break;
+
+    case NET_MQTT_CONNECTING:
+      tryBroker(nowMs);
+      break;
+
+    case NET_ONLINE:
+      if (!mqttClient.loop()) {
+        LOGW("broker connection lost");
+        markAllSubscriptionsStale();
+        backoff(NET_MQTT_CONNECTING, nowMs);
+        break;
+      }
+      subscribePending(nowMs);  // failed topics whose retry is due
+      break;
+  }
+}
+
+NetState net_state() {
+  return state;
+}
+
+bool net_online() {
+  return state == NET_ONLINE;
+}
+
+bool net_subscribed() {
+  if (state != NET_ONLINE) return false;
+  for (size_t i = 0; i < NET_MAX_SUBSCRIPTIONS; ++i) {
+    if (subs[i].owners && !subs[i].live) return false;
+  }
+  return true;
+}
+
+bool net_addSubscription(const char* topic, uint8_t owner) {
+  uint32_t bit = 1UL << owner;
+  int freeSlot = -1;
+  for (size_t i = 0; i < NET_MAX_SUBSCRIPTIONS; ++i) {
+    if (subs[i].owners && strcmp(subs[i].topic, topic) == 0) {
+      subs[i].owners |= bit;  // already (being) subscribed for someone else
+      if (subs[i].failures >= SUB_MAX_FAILURES) {  // given up on, and asked for again: retry now
+        resetSubscription(subs[i]);
+        if (state == NET_ONLINE) trySubscribe(subs[i], millis());
+      }
+      return true;
+    }
+    if (!subs[i].owners && freeSlot < 0) freeSlot = i;
+  }
+  if (freeSlot < 0) {
+    LOGE("subscription table full, dropping %s", topic);
+    return false;
+  }
+  strncpy(subs[freeSlot].topic, topic, TASK_TOPIC_MAX - 1);
+  subs[freeSlot].topic[TASK_TOPIC_MAX - 1] = '\0';
+  subs[freeSlot].owners = bit;
+  resetSubscription(subs[freeSlot]);
+  if (state == NET_ONLINE) trySubscribe(subs[freeSlot], millis());  // retried by net_tick on failure
+  return true;
+}
+
+// drop `owner`'s reference to slot i; unsubscribes when it was the last one
+static void release(size_t i, uint8_t owner) {
+  subs[i].owners &= ~(1UL << owner);
+  if (subs[i].owners) return;
+  if (subs[i].live && mqttClient.connected()) mqttClient.unsubscribe(subs[i].topic);
+  resetSubscription(subs[i]);
+  LOGD("unsubscribed %s", subs[i].topic);
+}
+
+void net_removeSubscription(const char* topic, uint8_t owner) {
+  for (size_t i = 0; i < NET_MAX_SUBSCRIPTIONS; ++i) {
+    if (subs[i].owners && strcmp(subs[i].topic, topic) == 0) release(i, owner);
+  }
+}
+
+void net_releaseOwner(uint8_t owner) {
+  for (size_t i = 0; i < NET_MAX_SUBSCRIPTIONS; ++i) {
+    if (subs[i].owners & (1UL << owner)) release(i, owner);
+  }
+}
+
+const char* net_deviceId() {
+  if (!deviceId[0]) snprintf(deviceId, sizeof(deviceId), "esp32-%lx", (unsigned long)(uint32_t)ESP.getEfuseMac());
+  return deviceId;
+}
+
+uint32_t net_session() {
+  return session;
+}
+
+NetStats net_stats() {
+  return stats;
+}
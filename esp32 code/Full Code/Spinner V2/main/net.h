@@ -0,0 +1,50 @@
+// net.h
+// Non-blocking WiFi/MQTT connection manager. net_tick() advances at most one step per call,
+// so the net task never sits in a connect loop and the rest of the wheel keeps running
+// while the network is down.
+//
+// Subscriptions are owned here: modules ask for topics (via mqttSubscribe() in shared.h) and
+// the manager restores them right after every reconnect. Each topic is reference counted by
+// owner (ModuleId), so two modules can share one broker subscription. A topic the broker
+// refuses is retried with backoff and given up on for the session after a few failures;
+// that never holds back publishing, which only needs the broker connection.
+#pragma once
+
+#include <Arduino.h>
+
+enum NetState : uint8_t {
+  NET_WIFI_CONNECTING,  // WiFi.begin() issued, waiting for WL_CONNECTED
+  NET_MQTT_CONNECTING,  // WiFi up, next tick tries the broker
+  NET_ONLINE,           // broker connected (subscriptions tracked separately)
+  NET_BACKOFF,          // waiting before the next WiFi/broker attempt
+};
+
+// Call once from setup(); does not wait for the network.
+void net_begin(const char* ssid, const char* pwd, const char* server, uint16_t port);
+
+// Net task only. One state-machine step plus mqttClient.loop() when connected.
+void net_tick(unsigned long nowMs);
+
+NetState net_state();
+bool net_online();      // broker connected: publishing works
+bool net_subscribed();  // online and every requested topic is subscribed
+uint32_t net_session();  // bumps on every new broker session
+const char* net_deviceId();  // "esp32-<mac>": MQTT client id and spinner/<device>/... topics
+
+const size_t NET_MAX_SUBSCRIPTIONS = 8;  // topics tracked across reconnects
+
+// Net task only. Desired subscriptions survive disconnects; when connected the subscribe is
+// sent immediately so it stays ordered with publishes queued after it. `owner` < 32.
+bool net_addSubscription(const char* topic, uint8_t owner);
+void net_removeSubscription(const char* topic, uint8_t owner);
+void net_releaseOwner(uint8_t owner);  // drop every topic `owner` holds
+
+// counters for diagnostics
+struct NetStats {
+  uint32_t wifiDrops;
+  uint32_t mqttConnects;
+  uint32_t mqttFailures;
+  uint32_t subscribeFailures;
+  uint32_t subscribeGiveUps;  // topics left unsubscribed for the rest of a session
+};
+NetStats net_stats();
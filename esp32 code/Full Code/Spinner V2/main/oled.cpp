@@ -0,0 +1,193 @@
+// oled.cpp
+// Partial SSD1306 flush (see oled.h).
+#include "oled.h"
+#include "tasks.h"
+
+#define LOGGER_TAG "oled"
+#define LOGGER_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+namespace {
+
+// ===== CONFIG =====
+// bytes per I2C transaction, control byte included (the ESP32 Wire buffer is 128 bytes)
+const size_t WIRE_CHUNK = 128;
+const uint8_t CONTROL_COMMANDS = 0x00;
+const uint8_t CONTROL_DATA = 0x40;
+
+const bool CONTENT_SCROLL = SPINNER_OLED_CONTENT_SCROLL;
+const uint8_t CMD_CONTENT_SCROLL_RIGHT = 0x2C;
+const uint8_t CMD_CONTENT_SCROLL_LEFT = 0x2D;
+const bool SCROLL_RIGHT_RAISES_COLUMN = SPINNER_OLED_SCROLL_RIGHT_RAISES_COLUMN;
+// the controller applies a content scroll on a later panel frame (~105 Hz by default) and needs
+// two frames between steps; nothing is written to the panel before it is done. This is the
+// display task's frame-rate cap while scrolling (oled.h).
+const TickType_t CONTENT_SCROLL_WAIT = pdMS_TO_TICKS(25);
+
+// ===== STATE =====
+TwoWire* bus = nullptr;
+uint8_t address = 0;
+uint16_t width = 0;
+uint8_t pages = 0;
+uint8_t* shadow = nullptr;  // what the panel holds, pages * width bytes
+bool shadowValid = false;
+OledStats stats = {};
+
+// Point the controller's write window at columns c0..c1 of `page`.
+static bool setWindow(uint8_t page, uint16_t c0, uint16_t c1) {
+  bus->beginTransmission(address);
+  bus->write(CONTROL_COMMANDS);
+  bus->write(SSD1306_PAGEADDR);
+  bus->write(page);
+  bus->write(page);
+  bus->write(SSD1306_COLUMNADDR);
+  bus->write(uint8_t(c0));
+  bus->write(uint8_t(c1));
+  return bus->endTransmission() == 0;
+}
+
+static bool sendData(const uint8_t* data, size_t len) {
+  while (len) {
+    size_t n = len < WIRE_CHUNK - 1 ? len : WIRE_CHUNK - 1;
+    bus->beginTransmission(address);
+    bus->write(CONTROL_DATA);
+    bus->write(data, n);
+    if (bus->endTransmission() != 0) return false;
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+// One-column content scroll of pages p0..p1, whole width. `dir` is in framebuffer terms:
+// -1 = content moves to lower x, +1 = to higher x.
+static bool contentScroll(uint8_t p0, uint8_t p1, int8_t dir) {
+  bool right = (dir > 0) == SCROLL_RIGHT_RAISES_COLUMN;
+  bus->beginTransmission(address);
+  bus->write(CONTROL_COMMANDS);
+  bus->write(right ? CMD_CONTENT_SCROLL_RIGHT : CMD_CONTENT_SCROLL_LEFT);
+  bus->write(0x00);  // dummy
+  bus->write(p0);
+  bus->write(0x01);  // one column
+  bus->write(p1);
+  bus->write(0x00);  // dummy
+  bus->write(0x00);  // start column
+  bus->write(uint8_t(width - 1));
+  return bus->endTransmission() == 0;
+}
+
+// How `page` of `fb` relates to what the panel shows: 0 = unchanged or not a one-column move,
+// -1 / +1 = moved left / right by one column. A page where only the edge column changed also
+// "moves" (blank content does), but the diff sends that one byte without a scroll.
+static int8_t pageShift(const uint8_t* fb, uint8_t page) {
+  const uint8_t* row = fb + page * width;
+  const uint8_t* seen = shadow + page * width;
+  if (memcmp(row, seen, width) == 0) return 0;
+  if (memcmp(row, seen + 1, width - 1) == 0 && memcmp(row, seen, width - 1) != 0) return -1;
+  if (memcmp(row + 1, seen, width - 1) == 0 && memcmp(row + 1, seen + 1, width - 1) != 0) return 1;
+  return 0;
+}
+
+// unchanged and one value across (blank): moving it changes nothing, so it can join a run
+static bool pageFlat(const uint8_t* fb, uint8_t page) {
+  const uint8_t* row = fb + page * width;
+  const uint8_t* seen = shadow + page * width;
+  for (uint16_t c = 0; c < width; ++c) {
+    if (row[c] != row[0] || seen[c] != row[0]) return false;
+  }
+  return true;
+}
+
+// Shift the first run of pages that moved by one column in the controller, and the shadow
+// with them; the exposed column is marked stale so the diff sends it. Blank pages between
+// moved ones join the run; the run starts and ends on a moved page, since every page in it
+// costs its exposed column.
+static void scrollMovedPages(const uint8_t* fb) {
+  int8_t dir = 0;
+  uint8_t p0 = 0, p1 = 0;
+  for (uint8_t page = 0; page < pages; ++page) {
+    int8_t s = pageShift(fb, page);
+    if (s && !dir) {
+      dir = s;
+      p0 = p1 = page;
+    } else if (dir && s == dir) {
+      p1 = page;
+    } else if (dir && !(s == 0 && pageFlat(fb, page))) {
+      break;
+    }
+  }
+  if (!dir) return;
+
+  i2cLock();
+  bool ok = contentScroll(p0, p1, dir);
+  i2cUnlock();
+  if (!ok) {
+    shadowValid = false;
+    return;
+  }
+  vTaskDelay(CONTENT_SCROLL_WAIT);
+  stats.scrolls++;
+  for (uint8_t page = p0; page <= p1; ++page) {
+    const uint8_t* row = fb + page * width;
+    uint8_t* seen = shadow + page * width;
+    uint16_t exposed = dir < 0 ? width - 1 : 0;
+    if (dir < 0) memmove(seen, seen + 1, width - 1);
+    else memmove(seen + 1, seen, width - 1);
+    seen[exposed] = uint8_t(~row[exposed]);
+  }
+}
+
+} // namespace
+
+void oled_begin(Adafruit_SSD1306& display, TwoWire& wire, uint8_t addr) {
+  bus = &wire;
+  address = addr;
+  width = display.width();
+  pages = uint8_t((display.height() + 7) / 8);
+  if (!shadow) shadow = (uint8_t*)malloc(size_t(width) * pages);
+  if (!shadow) LOGW("no memory for the shadow buffer, full flushes only");
+  shadowValid = false;
+}
+
+void oled_invalidate() {
+  shadowValid = false;
+}
+
+uint16_t oled_flush(const uint8_t* fb) {
+  if (!bus || !fb) return 0;
+  stats.flushes++;
+  stats.fullBytes += width * pages;
+
+  uint16_t sent = 0;
+  if (CONTENT_SCROLL && shadow && shadowValid) scrollMovedPages(fb);
+  bool full = !shadow || !shadowValid;
+  shadowValid = shadow != nullptr;
+  for (uint8_t page = 0; page < pages; ++page) {
+    const uint8_t* row = fb + page * width;
+    uint8_t* seen = shadow ? shadow + page * width : nullptr;
+    uint16_t c0 = 0, c1 = width - 1;
+    if (!full) {
+      while (c0 < width && row[c0] == seen[c0]) ++c0;
+      if (c0 == width) continue;  // page unchanged
+      while (row[c1] == seen[c1]) --c1;
+    }
+    uint16_t len = c1 - c0 + 1;
+    i2cLock();
+    bool ok = setWindow(page, c0, c1) && sendData(row + c0, len);
+    i2cUnlock();
+    if (!ok) {
+      // the panel is in an unknown state now: resend everything next time
+      shadowValid = false;
+      LOGD("I2C error on page %u", unsigned(page));
+      break;
+    }
+    if (seen) memcpy(seen + c0, row + c0, len);
+    sent += len;
+  }
+  stats.bytes += sent;
+  return sent;
+}
+
+OledStats oled_stats() {
+  return stats;
+}
@@ -0,0 +1,62 @@
+// oled.h
+// Partial SSD1306 flush. display.display() pushes the whole 1 KB framebuffer every time (~25 ms
+// at 400 kHz), although a frame usually changes a few glyphs. oled_flush() keeps a shadow copy
+// of what the panel holds, diffs the framebuffer against it page by page and sends only the
+// changed column span of each page, using the controller's page/column address window.
+//
+// The shadow only knows what went through oled_flush(): anything else that writes the panel
+// (display.display(), a re-init) must be followed by oled_invalidate(), which makes the next
+// flush a full one. A failed I2C transfer does the same.
+//
+// Hardware scrolling (build with -DSPINNER_OLED_CONTENT_SCROLL=1): when a run of pages holds
+// exactly what the panel shows moved by one column (a marquee scrolling a pixel), the flush
+// shifts them inside the controller with its one-column content scroll (2Ch/2Dh). After that
+// only the newly exposed column goes over the bus, a byte per page. Larger jumps go through
+// the diff as before. Off by default and not yet verified on the panel: older SSD1306
+// revisions and some clones lack the command, and the direction is an assumption (below).
+//
+// Frame-rate cap: the controller applies the scroll on a later panel frame, so each step is
+// followed by a fixed vTaskDelay(25 ms) before anything else is written. That wait, not the
+// bus, limits the display task to ~40 flushes/s (and the marquee to ~40 px/s) while it
+// scrolls; frames presented meanwhile are coalesced (tasks.h DisplayStats.dropped).
+//
+// Direction: Adafruit_SSD1306::begin() sets segment remap (A1h) and COM scan decrement, so
+// framebuffer x = column address = panel left to right. Whether 2Ch ("right") then moves RAM
+// towards higher column addresses is not stated for the remapped case;
+// SPINNER_OLED_SCROLL_RIGHT_RAISES_COLUMN says it does. If it is wrong the shadow and the panel
+// disagree by two columns after every step, which shows as scrolling text smearing; set it
+// to 0 then.
+//
+// One caller at a time: the display task (tasks.h), or setup() before it runs. The I2C bus lock
+// is taken per page, so the encoder still gets samples in between.
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+
+#ifndef SPINNER_OLED_CONTENT_SCROLL
+  #define SPINNER_OLED_CONTENT_SCROLL 0
+#endif
+#ifndef SPINNER_OLED_SCROLL_RIGHT_RAISES_COLUMN
+  #define SPINNER_OLED_SCROLL_RIGHT_RAISES_COLUMN 1
+#endif
+
+struct OledStats {
+  uint32_t flushes;    // oled_flush() calls
+  uint32_t bytes;      // framebuffer bytes sent
+  uint32_t fullBytes;  // what full flushes would have sent
+  uint32_t scrolls;    // one-column hardware scrolls
+};
+
+// After display.begin(). `addr` = the panel's I2C address. Without memory for the shadow every
+// flush is a full one.
+void oled_begin(Adafruit_SSD1306& display, TwoWire& wire, uint8_t addr);
+void oled_invalidate();
+
+// Send what changed in `fb` (a framebuffer laid out like display.getBuffer()) since the last
+// flush; returns the framebuffer bytes sent.
+uint16_t oled_flush(const uint8_t* fb);
+
+// Running totals, for the perf report (a torn read between fields is harmless there).
+OledStats oled_stats();
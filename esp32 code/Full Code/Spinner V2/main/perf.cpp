@@ -0,0 +1,171 @@
+// perf.cpp
+// Stage histograms and the periodic perf summary (see perf.h).
+#include "perf.h"
+
+#if SPINNER_PERF
+
+#include "shared.h"
+#include "net.h"
+#include "scheduler.h"
+#include "modules.h"
+#include "oled.h"
+#include "tasks.h"
+
+#define LOGGER_TAG "perf"
+#define LOGGER_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+
+namespace {
+
+// ===== CONFIG =====
+const unsigned long PERF_REPORT_S = 30;
+const size_t PERF_PAYLOAD_MAX = 1024;
+
+// Log-linear buckets in microseconds: exact below 4 us, then 4 buckets per power of two
+// (<= 25% error) up to ~4 s; anything longer lands in the last bucket.
+const uint8_t SUB_BITS = 2;
+const uint8_t SUBS = 1 << SUB_BITS;
+const uint8_t OCTAVES = 20;
+const uint8_t BINS = SUBS * (OCTAVES + 1);
+
+struct Histogram {
+  uint16_t bins[BINS];  // saturating counts
+  uint32_t count;
+  uint32_t minUs;
+  uint32_t maxUs;
+  volatile bool resetPending;  // set by the reporter, honoured by the writer
+};
+
+// ===== STATE =====
+Histogram hist[PERF_SLOT_COUNT];
+uint32_t cyclesPerUs = 240;
+unsigned long lastReportMs = 0;
+char topic[48];
+
+static uint8_t bucketOf(uint32_t us) {
+  if (us < SUBS) return uint8_t(us);
+  uint8_t e = 31 - __builtin_clz(us);  // >= SUB_BITS
+  uint8_t sub = (us >> (e - SUB_BITS)) & (SUBS - 1);
+  uint32_t idx = uint32_t(SUBS) * (e - SUB_BITS + 1) + sub;
+  return idx < BINS ? uint8_t(idx) : uint8_t(BINS - 1);
+}
+
+// largest value that lands in bucket `b`
+static uint32_t bucketTop(uint8_t b) {
+  if (b < SUBS) return b;
+  uint8_t e = b / SUBS + SUB_BITS - 1;
+  uint32_t sub = b % SUBS;
+  return ((SUBS + sub + 1) << (e - SUB_BITS)) - 1;
+}
+
+static void clear(Histogram& h) {
+  memset(h.bins, 0, sizeof(h.bins));
+  h.count = 0;
+  h.minUs = UINT32_MAX;
+  h.maxUs = 0;
+}
+
+static uint32_t percentile(const Histogram& h, uint32_t count, uint8_t pct) {
+  uint32_t rank = (count * pct + 99) / 100;
+  uint32_t seen = 0;
+  for (uint8_t b = 0; b < BINS; ++b) {
+    seen += h.bins[b];
+    if (seen >= rank) {
+      uint32_t top = bucketTop(b);
+      return top < h.maxUs ? top : h.maxUs;
+    }
+  }
+  return h.maxUs;
+}
+
+static const char* slotName(uint8_t slot) {
+  switch (slot) {
+    case PERF_FRAME: return "frame";
+    case PERF_TAGS: return "tags";
+    case PERF_ENCODER: return "enc";
+    case PERF_RFID: return "rfid";
+    case PERF_DISPLAY: return "disp";
+    case PERF_FLUSH: return "flush";
+    case PERF_LED: return "led";
+    case PERF_NET: return "net";
+  }
+  int idx = Modules::indexOf(ModuleId(slot - PERF_STAGE_COUNT));
+  return idx >= 0 ? Modules::name(idx) : "?";
+}
+
+// {"up":s,"st":{"<stage>":[min,p50,p99,max,n],...},"sched":{"<rate>":[ticks,overruns,worstLateUs],...},
+//  "oled":[flushes,bytesSent,bytesFull,hwScrolls],"frames":[presented,dropped,lastLatencyUs,maxLatencyUs]}
+// (oled and frame counters since boot)
+static size_t buildSummary(char* out, size_t len, unsigned long nowMs) {
+  size_t n = snprintf(out, len, "{\"up\":%lu,\"st\":{", nowMs / 1000);
+  bool first = true;
+  for (uint8_t s = 0; s < PERF_SLOT_COUNT && n < len; ++s) {
+    Histogram& h = hist[s];
+    uint32_t count = h.count;  // snapshot; the writer may still be adding
+    if (h.resetPending || count == 0) continue;
+    n += snprintf(out + n, len - n, "%s\"%s\":[%lu,%lu,%lu,%lu,%lu]", first ? "" : ",", slotName(s),
+                  (unsigned long)h.minUs, (unsigned long)percentile(h, count, 50),
+                  (unsigned long)percentile(h, count, 99), (unsigned long)h.maxUs, (unsigned long)count);
+    first = false;
+    h.resetPending = true;
+  }
+  if (n < len) n += snprintf(out + n, len - n, "},\"sched\":{");
+  for (size_t i = 0; i < sched_count() && n < len; ++i) {
+    const SchedRate* r = sched_rate(i);
+    n += snprintf(out + n, len - n, "%s\"%s\":[%lu,%lu,%lu]", i ? "," : "", r->name,
+                  (unsigned long)r->ticks, (unsigned long)r->overruns, (unsigned long)r->worstLateUs);
+  }
+  OledStats o = oled_stats();
+  DisplayStats d = tasks_displayStats();
+  if (n < len) n += snprintf(out + n, len - n, "},\"oled\":[%lu,%lu,%lu,%lu]", (unsigned long)o.flushes,
+                             (unsigned long)o.bytes, (unsigned long)o.fullBytes, (unsigned long)o.scrolls);
+  if (n < len) n += snprintf(out + n, len - n, ",\"frames\":[%lu,%lu,%lu,%lu]}", (unsigned long)d.presented,
+                             (unsigned long)d.dropped, (unsigned long)d.lastLatencyUs,
+                             (unsigned long)d.maxLatencyUs);
+  return n;
+}
+
+} // namespace
+
+void perf_begin() {
+  cyclesPerUs = ESP.getCpuFreqMHz();
+  if (cyclesPerUs == 0) cyclesPerUs = 240;
+  for (uint8_t s = 0; s < PERF_SLOT_COUNT; ++s) clear(hist[s]);
+}
+
+void perf_record(uint8_t slot, uint32_t cycles) {
+  if (slot >= PERF_SLOT_COUNT) return;
+  Histogram& h = hist[slot];
+  if (h.resetPending) {
+    clear(h);
+    h.resetPending = false;
+  }
+  uint32_t us = cycles / cyclesPerUs;
+  uint8_t b = bucketOf(us);
+  if (h.bins[b] != UINT16_MAX) ++h.bins[b];
+  ++h.count;
+  if (us < h.minUs) h.minUs = us;
+  if (us > h.maxUs) h.maxUs = us;
+}
+
+void perf_report(unsigned long nowMs) {
+  if (nowMs - lastReportMs < PERF_REPORT_S * 1000UL) return;
+  lastReportMs = nowMs;
+  if (!net_online()) return;
+
+  if (!topic[0]) snprintf(topic, sizeof(topic), "spinner/%s/perf", net_deviceId());
+  static char payload[PERF_PAYLOAD_MAX];  // net task only
+  size_t n = buildSummary(payload, sizeof(payload), nowMs);
+  if (n >= sizeof(payload)) {
+    LOGW("summary truncated, not published");
+    return;
+  }
+  // the net task owns mqttClient, so publish directly instead of through the 192-byte queue
+  bool ok = mqttClient.publish(topic, payload);
+  LOGD("%s (%u bytes)", ok ? "published" : "publish failed", (unsigned)n);
+}
+
+#endif // SPINNER_PERF
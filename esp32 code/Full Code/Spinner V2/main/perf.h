@@ -0,0 +1,59 @@
+// perf.h
+// Per-stage timing: PERF_SCOPE(stage) times the rest of the enclosing block with the CPU cycle
+// counter and folds it into a small log-linear histogram (min/p50/p99/max). The net task
+// publishes a compact summary to spinner/<device>/perf every PERF_REPORT_S seconds.
+//
+// Recording is a cycle-counter read, a count-leading-zeros and an increment, so it stays on
+// in production. Build with -DSPINNER_PERF=0 to compile all of it out.
+//
+// Every stage has a single writer task; the reporter only reads (and asks writers to reset).
+#pragma once
+
+#include <Arduino.h>
+#include "tags.h"
+
+#ifndef SPINNER_PERF
+  #define SPINNER_PERF 1
+#endif
+
+enum PerfStage : uint8_t {
+  PERF_FRAME,    // one loop() frame, excluding the scheduler sleep
+  PERF_TAGS,     // loop(): draining and applying tag events
+  PERF_ENCODER,  // sense task: encoder_sourceRead()
+  PERF_RFID,     // rfid task: RC522 select / UID read
+  PERF_DISPLAY,  // displayFlush(): frame hand-over on the render task
+  PERF_FLUSH,    // display task: oled_flush() incl. I2C bus waits
+  PERF_LED,      // ledShow()
+  PERF_NET,      // net task: net_tick() incl. mqttClient.loop()
+  PERF_STAGE_COUNT
+};
+
+// active module's loop(), one slot per ModuleId
+inline constexpr uint8_t perfModuleSlot(ModuleId id) { return PERF_STAGE_COUNT + id; }
+const uint8_t PERF_SLOT_COUNT = PERF_STAGE_COUNT + MOD_COUNT;
+
+#if SPINNER_PERF
+
+void perf_begin();
+void perf_record(uint8_t slot, uint32_t cycles);
+// net task only: publishes the summary when it is due (needs the broker connected)
+void perf_report(unsigned long nowMs);
+
+struct PerfScope {
+  uint8_t slot;
+  uint32_t start;
+  explicit PerfScope(uint8_t s) : slot(s), start(ESP.getCycleCount()) {}
+  ~PerfScope() { perf_record(slot, ESP.getCycleCount() - start); }
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+#define PERF_SCOPE(slot) PerfScope PERF_CONCAT(perfScope_, __LINE__)(slot)
+
+#else
+
+inline void perf_begin() {}
+inline void perf_report(unsigned long) {}
+#define PERF_SCOPE(slot) do {} while (0)
+
+#endif
@@ -0,0 +1,140 @@
+// rfid.cpp
+// IRQ-driven (or low-rate polled) MFRC522 presence detection, see rfid.h.
+#include "rfid.h"
+#include "perf.h"
+
+#define LOGGER_TAG "rfid"
+#define LOGGER_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <MFRC522.h>
+
+extern MFRC522 mfrc522;  // constructed in main.ino
+
+namespace {
+
+// ===== CONFIG =====
+const uint32_t RFID_IRQ_KICK_MS = 100;       // how often an empty field is re-armed (IRQ mode)
+const uint32_t RFID_POLL_INTERVAL_MS = 150;  // fallback polling rate without an IRQ pin
+const uint32_t RFID_PRESENCE_CHECK_MS = 250; // re-check interval while a tag is present
+const uint8_t RFID_MISSES_FOR_REMOVAL = 3;   // consecutive missed checks before TAG_REMOVED
+
+// register values (MFRC522 datasheet 9.3.1.3 / 9.3.1.4)
+const byte COMIEN_IRQ_INV_RX = 0xA0;  // IRqInv (active-low pin) | RxIEn
+const byte DIVIEN_PUSH_PULL = 0x80;   // IRQPushPull, no DivIrq sources
+const byte COMIRQ_CLEAR_ALL = 0x7F;
+const byte BITFRAMING_START_7BIT = 0x87;  // StartSend | 7 valid bits (short frame)
+
+// ===== STATE =====
+int irqPin = -1;
+TaskHandle_t rfidTask = nullptr;
+
+bool tagPresent = false;
+Uid presentUid = {};
+uint8_t misses = 0;
+
+static void IRAM_ATTR onRfidIrq() {
+  BaseType_t woken = pdFALSE;
+  if (rfidTask) vTaskNotifyGiveFromISR(rfidTask, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+static void clearIrq() {
+  mfrc522.PCD_WriteRegister(MFRC522::ComIrqReg, COMIRQ_CLEAR_ALL);
+}
+
+// Send WUPA and return immediately; the chip raises RxIRq if any card (idle or halted) answers.
+static void armReceive() {
+  mfrc522.PCD_WriteRegister(MFRC522::CommandReg, MFRC522::PCD_Idle);
+  clearIrq();
+  mfrc522.PCD_WriteRegister(MFRC522::FIFOLevelReg, 0x80);  // flush FIFO
+  mfrc522.PCD_WriteRegister(MFRC522::FIFODataReg, MFRC522::PICC_CMD_WUPA);
+  mfrc522.PCD_WriteRegister(MFRC522::CommandReg, MFRC522::PCD_Transceive);
+  mfrc522.PCD_WriteRegister(MFRC522::BitFramingReg, BITFRAMING_START_7BIT);
+}
+
+// Full select + UID read. `woken` = a WUPA already got an answer (IRQ path), so the card is
+// in READY and goes straight to anticollision.
+static bool readCard(Uid& out, bool woken) {
+  PERF_SCOPE(PERF_RFID);
+  if (!woken) {
+    byte atqa[2];
+    byte atqaSize = sizeof(atqa);
+    MFRC522::StatusCode st = mfrc522.PICC_WakeupA(atqa, &atqaSize);
+    if (st != MFRC522::STATUS_OK && st != MFRC522::STATUS_COLLISION) return false;
+  }
+  if (!mfrc522.PICC_ReadCardSerial()) return false;
+  out = uidFromBytes(mfrc522.uid.uidByte, mfrc522.uid.size);
+  mfrc522.PICC_HaltA();
+  return !out.empty();
+}
+
+// Fold one check result into present/removed events.
+static bool updatePresence(bool seen, const Uid& uid, RfidEvent& ev) {
+  if (seen) {
+    misses = 0;
+    if (tagPresent && uid == presentUid) return false;
+    tagPresent = true;
+    presentUid = uid;
+    ev.type = RFID_TAG_PRESENT;
+    ev.uid = uid;
+    return true;
+  }
+  if (!tagPresent) return false;
+  if (++misses < RFID_MISSES_FOR_REMOVAL) return false;
+  tagPresent = false;
+  misses = 0;
+  ev.type = RFID_TAG_REMOVED;
+  ev.uid = presentUid;
+  return true;
+}
+
+} // namespace
+
+void rfid_begin(int pin) {
+  irqPin = pin;
+  if (irqPin < 0) {
+    LOGI("polling every %lums", (unsigned long)RFID_POLL_INTERVAL_MS);
+    return;
+  }
+  pinMode(irqPin, INPUT_PULLUP);
+  mfrc522.PCD_WriteRegister(MFRC522::ComIEnReg, COMIEN_IRQ_INV_RX);
+  mfrc522.PCD_WriteRegister(MFRC522::DivIEnReg, DIVIEN_PUSH_PULL);
+  clearIrq();
+  LOGI("IRQ mode on GPIO%d", irqPin);
+}
+
+void rfid_bindCurrentTask() {
+  rfidTask = xTaskGetCurrentTaskHandle();
+  if (irqPin >= 0) attachInterrupt(digitalPinToInterrupt(irqPin), onRfidIrq, FALLING);
+}
+
+bool rfid_waitEvent(RfidEvent& ev) {
+  Uid uid = {};
+  bool seen = false;
+
+  if (tagPresent) {
+    // present tag: cheap periodic WUPA check in either mode
+    vTaskDelay(pdMS_TO_TICKS(RFID_PRESENCE_CHECK_MS));
+    seen = readCard(uid, false);
+  } else if (irqPin >= 0) {
+    // empty field: arm the chip and sleep until it answers or the kick interval elapses
+    armReceive();
+    bool fired = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RFID_IRQ_KICK_MS)) > 0;
+    if (!fired) return false;
+    seen = readCard(uid, true);
+    LOGD("irq, read %s", seen ? "ok" : "failed");
+  } else {
+    vTaskDelay(pdMS_TO_TICKS(RFID_POLL_INTERVAL_MS));
+    seen = readCard(uid, false);
+  }
+
+  // our own transceives raise RxIRq too; drop those before the next wait
+  if (irqPin >= 0) {
+    clearIrq();
+    ulTaskNotifyTake(pdTRUE, 0);
+  }
+  return updatePresence(seen, uid, ev);
+}
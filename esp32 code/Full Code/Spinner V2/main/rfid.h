@@ -0,0 +1,33 @@
+// rfid.h
+// MFRC522 tag detection for the rfid task.
+//
+// With an IRQ pin wired, the task arms the RC522 (WUPA + Transceive, RxIRq routed to the pin
+// via ComIEnReg/DivIEnReg) and sleeps until the chip answers, so an empty field costs a few SPI
+// writes per kick instead of a blocking PICC_IsNewCardPresent(). Without one it falls back to
+// polling at RFID_POLL_INTERVAL_MS.
+//
+// Once a tag is seen it is re-checked with WUPA (which also wakes the halted card), so a tag
+// resting on the reader stays "present" and lifting it produces RFID_TAG_REMOVED.
+#pragma once
+
+#include <Arduino.h>
+#include "uid.h"
+
+enum RfidEventType : uint8_t {
+  RFID_TAG_PRESENT,  // new tag (or a different tag) in the field
+  RFID_TAG_REMOVED,  // the present tag stopped answering
+};
+
+struct RfidEvent {
+  RfidEventType type;
+  Uid uid;
+};
+
+// Call from setup() after PCD_Init(). irqPin < 0 selects polling.
+void rfid_begin(int irqPin);
+
+// rfid task only: binds the IRQ to the calling task.
+void rfid_bindCurrentTask();
+
+// rfid task only: sleeps until the next IRQ / check is due, returns true with an event.
+bool rfid_waitEvent(RfidEvent& ev);
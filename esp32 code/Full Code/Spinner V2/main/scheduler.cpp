@@ -0,0 +1,134 @@
+// scheduler.cpp
+// Fixed-rate tick scheduler (see scheduler.h).
+#include "scheduler.h"
+
+#define LOGGER_TAG "sched"
+#define LOGGER_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#if __has_include(<esp_pm.h>)
+  #include <esp_pm.h>
+#endif
+
+namespace {
+
+// ===== CONFIG =====
+// Let the idle task enter light sleep between ticks. Needs CONFIG_PM_ENABLE and
+// CONFIG_FREERTOS_USE_TICKLESS_IDLE in the core's sdkconfig; otherwise idle just waits.
+const bool LIGHT_SLEEP_IDLE = true;
+
+const size_t MAX_RATES = 8;
+
+// ===== STATE =====
+SchedRate* rates[MAX_RATES];
+size_t rateCount = 0;
+
+// esp_timer task context: wake the task bound to the rate
+static void onTimer(void* task) {
+  xTaskNotifyGive(static_cast<TaskHandle_t>(task));
+}
+
+} // namespace
+
+void sched_begin() {
+#if defined(CONFIG_PM_ENABLE) && defined(CONFIG_FREERTOS_USE_TICKLESS_IDLE)
+  if (LIGHT_SLEEP_IDLE) {
+    // no frequency scaling (the Arduino SPI/I2C HAL doesn't hold PM locks), only light sleep
+    int mhz = getCpuFrequencyMhz();
+    esp_pm_config_t pm = {};
+    pm.max_freq_mhz = mhz;
+    pm.min_freq_mhz = mhz;
+    pm.light_sleep_enable = true;
+    esp_err_t err = esp_pm_configure(&pm);
+    LOGI("light sleep in idle %s", err == ESP_OK ? "on" : "unavailable");
+    return;
+  }
+#endif
+  LOGD("light sleep not supported by this core build");
+}
+
+void sched_register(SchedRate& rate) {
+  for (size_t i = 0; i < rateCount; ++i) {
+    if (rates[i] == &rate) return;
+  }
+  if (rateCount < MAX_RATES) rates[rateCount++] = &rate;
+}
+
+uint32_t schedAdvance(SchedRate& r, uint64_t nowUs) {
+  if (r.deadlineUs == 0) {
+    // first tick: the grid starts now
+    r.deadlineUs = nowUs;
+    r.releasedUs = nowUs;
+  }
+
+  uint32_t busy = uint32_t(nowUs - r.releasedUs);
+  if (busy > r.worstBusyUs) r.worstBusyUs = busy;
+  ++r.ticks;
+
+  r.deadlineUs += r.periodUs;
+  if (nowUs >= r.deadlineUs) {
+    // missed the next release: run it now, drop any further whole periods, keep the phase
+    ++r.overruns;
+    uint64_t behind = (nowUs - r.deadlineUs) / r.periodUs;
+    r.skipped += uint32_t(behind);
+    r.deadlineUs += behind * r.periodUs;
+    LOGD("%s overrun (busy %luus)", r.name, (unsigned long)busy);
+    return 0;
+  }
+  return uint32_t(r.deadlineUs - nowUs);
+}
+
+void schedReleased(SchedRate& r, uint64_t nowUs) {
+  uint32_t late = nowUs > r.deadlineUs ? uint32_t(nowUs - r.deadlineUs) : 0;
+  if (late > r.worstLateUs) r.worstLateUs = late;
+  r.releasedUs = nowUs;
+}
+
+bool sched_bindTimer(SchedRate& r) {
+  if (r.timer) return true;
+  esp_timer_create_args_t args = {};
+  args.callback = onTimer;
+  args.arg = xTaskGetCurrentTaskHandle();
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = r.name;
+  args.skip_unhandled_events = true;  // a late task gets one release, not a backlog
+  esp_timer_handle_t t = nullptr;
+  if (esp_timer_create(&args, &t) != ESP_OK) {
+    LOGW("%s: no timer, using tick delays", r.name);
+    return false;
+  }
+  // the timer defines the grid from here on
+  uint64_t now = esp_timer_get_time();
+  r.deadlineUs = now;
+  r.releasedUs = now;
+  esp_timer_start_periodic(t, r.periodUs);
+  r.timer = t;
+  LOGI("%s: timer release every %luus", r.name, (unsigned long)r.periodUs);
+  return true;
+}
+
+void sched_wait(SchedRate& r) {
+  uint32_t sleepUs = schedAdvance(r, esp_timer_get_time());
+  if (r.timer) {
+    // after an overrun the missed release is already pending and returns at once
+    TickType_t limit = pdMS_TO_TICKS(sleepUs / 1000 + 2);
+    ulTaskNotifyTake(pdTRUE, sleepUs > 0 ? limit : 0);
+  } else if (sleepUs > 0) {
+    // whole RTOS ticks: a release jitters by up to one tick, the grid itself doesn't drift
+    TickType_t ticks = (sleepUs + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000);
+    vTaskDelay(ticks);
+  } else {
+    taskYIELD();  // overran: still give equal-priority tasks a turn
+  }
+  schedReleased(r, esp_timer_get_time());
+}
+
+size_t sched_count() {
+  return rateCount;
+}
+
+const SchedRate* sched_rate(size_t i) {
+  return i < rateCount ? rates[i] : nullptr;
+}
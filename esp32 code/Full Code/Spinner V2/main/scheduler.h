@@ -0,0 +1,56 @@
+// scheduler.h
+// Fixed-rate ticks for the periodic activities (encoder sampling, render frames, network
+// service). Each activity declares its rate once; sched_wait() sleeps the calling task until
+// the next release on an absolute microsecond grid, so rates don't drift with loop body time.
+//
+// A release that is missed (the body ran past the next deadline) counts as an overrun and the
+// missed periods are skipped, not replayed in a burst. While every task is blocked the idle
+// task may enter light sleep (see sched_begin()).
+//
+// Releases normally come from RTOS tick delays (1 ms resolution). A rate bound to a hardware
+// timer with sched_bindTimer() is released by an esp_timer instead, for sub-tick periods.
+#pragma once
+
+#include <Arduino.h>
+
+struct SchedRate {
+  const char* name;
+  uint32_t periodUs;
+
+  // bookkeeping, owned by the scheduler
+  uint64_t deadlineUs;     // next release, 0 = not started
+  uint64_t releasedUs;     // when the current tick actually started
+  uint32_t ticks;
+  uint32_t overruns;       // ticks that ran past the following deadline
+  uint32_t skipped;        // whole periods dropped to catch up after overruns
+  uint32_t worstBusyUs;    // longest tick body
+  uint32_t worstLateUs;    // longest release delay past the deadline
+  void* timer;             // esp_timer handle once bound, else nullptr
+};
+
+// Aggregate-initialise a rate: SchedRate r = schedRateHz("render", 60);
+constexpr SchedRate schedRateHz(const char* name, uint32_t hz) {
+  return SchedRate{ name, uint32_t(1000000UL / hz), 0, 0, 0, 0, 0, 0, 0, nullptr };
+}
+
+// setup(): enables light sleep in idle when the core supports it (PM + tickless idle).
+void sched_begin();
+
+// Add a rate to the diagnostics list (setup() only, before tasks_start()).
+void sched_register(SchedRate& rate);
+
+// Release `rate` from a periodic hardware timer that notifies the calling task; call it from
+// the task that sched_wait()s on the rate. Returns false (tick delays stay in use) on failure.
+bool sched_bindTimer(SchedRate& rate);
+
+// End of a tick: account for it, then block until the next release.
+void sched_wait(SchedRate& rate);
+
+// Clock-independent core of sched_wait(): accounts the tick that ends at `nowUs` and returns
+// how long to sleep until the next release. Call schedReleased() once awake.
+uint32_t schedAdvance(SchedRate& rate, uint64_t nowUs);
+void schedReleased(SchedRate& rate, uint64_t nowUs);
+
+// registered rates, for reporting
+size_t sched_count();
+const SchedRate* sched_rate(size_t i);
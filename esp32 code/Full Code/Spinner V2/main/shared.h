@@ -19,14 +19,25 @@ extern const uint16_t SCREEN_H;
 extern const uint8_t OLED_RESET;
 
 // -- shared objects (defined/constructed in main.ino)
-extern AS5600 as5600;               // magnetic encoder
+extern AS5600 as5600;               // magnetic encoder (sense task only; modules use encoder.h)
 extern CRGB *leds;                  // pointer to LED array created in main
 extern Adafruit_SSD1306 display;    // OLED display (constructed in main)
 extern WiFiClient wifiClient;
 extern PubSubClient mqttClient;
 
-// helper: publish wrapper (optional)
-inline bool publishJson(const char* topic, const char* payload) {
-  if (!mqttClient.connected()) return false;
-  return mqttClient.publish(topic, payload);
-}
\ No newline at end of file
+// -- cross-task plumbing (defined in tasks.cpp). mqttClient belongs to the net task, so modules
+//    publish/subscribe through these queue-backed helpers instead of calling it directly.
+bool publishJson(const char* topic, const char* payload);  // false if offline or queue full
+// Subscriptions are reference counted per owner (the module's ModuleId from tags.h); inbound
+// messages are delivered through mqtt_route() handlers, not per module.
+bool mqttSubscribe(uint8_t owner, const char* topic);
+bool mqttUnsubscribe(uint8_t owner, const char* topic);
+bool mqttReleaseAll(uint8_t owner);  // drop every subscription `owner` holds
+bool mqttIsConnected();
+uint32_t mqttSession();  // changes whenever the broker session is re-established
+
+// Present the frame drawn into `display`: it is copied and handed to the display task, which
+// sends it out (partial flush, oled.h). Never waits for the bus; a frame still queued when the
+// next one arrives is replaced (latest wins). Before tasks_start() it flushes in place.
+void displayFlush();
+void ledShow();          // FastLED.show(), timed for perf
@@ -0,0 +1,41 @@
+// slice_quantizer.cpp
+// Hysteresis + dwell slice quantizer (see slice_quantizer.h).
+#include "slice_quantizer.h"
+#include "encoder.h"
+
+namespace {
+
+// Is `phase` within the slice's sector widened by `margin` counts on both sides? Distances are
+// taken around the circle and scaled by 2 * slices to stay in integers.
+static bool inSlice(uint16_t phase, uint8_t slice, uint8_t slices, uint16_t margin) {
+  int32_t turn = int32_t(ENCODER_COUNTS) * 2 * slices;
+  int32_t center = int32_t(2 * slice + 1) * ENCODER_COUNTS;
+  int32_t d = int32_t(phase) * 2 * slices - center;
+  d %= turn;
+  if (d > turn / 2) d -= turn;
+  else if (d < -turn / 2) d += turn;
+  if (d < 0) d = -d;
+  return d <= int32_t(ENCODER_COUNTS) + int32_t(margin) * 2 * slices;
+}
+
+} // namespace
+
+uint8_t slice_update(SliceQuantizer& q, uint16_t raw, uint32_t nowMs) {
+  uint16_t phase = encoderPhase(raw, q.offset);
+  if (q.held < 0) {
+    q.held = q.settled = encoderSlice(raw, q.offset, q.slices);
+    q.heldMs = nowMs;
+    return uint8_t(q.settled);
+  }
+
+  if (!inSlice(phase, uint8_t(q.held), q.slices, q.hysteresis)) {
+    q.held = encoderSlice(raw, q.offset, q.slices);
+    q.heldMs = nowMs;
+  }
+  if (q.held != q.settled && nowMs - q.heldMs >= q.dwellMs) q.settled = q.held;
+  return uint8_t(q.settled);
+}
+
+void slice_reset(SliceQuantizer& q) {
+  q.held = q.settled = -1;
+}
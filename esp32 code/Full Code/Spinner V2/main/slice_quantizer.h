@@ -0,0 +1,43 @@
+// slice_quantizer.h
+// Turns the wheel angle into one of N equal slices for the selector modules, without the
+// flicker of a bare encoderSlice(): a wheel resting on a boundary stays on its slice until it
+// moves `hysteresis` counts past it, and a new slice is only reported once it has held for
+// `dwellMs`. Each reported change costs a redraw, an LED update and an MQTT publish (which makes
+// the server run a photo query), so only settled transitions get through.
+#pragma once
+
+#include <Arduino.h>
+
+const uint16_t SLICE_HYSTERESIS = 40;  // counts (~3.5 deg) past a boundary before switching
+const uint16_t SLICE_DWELL_MS = 60;
+
+struct SliceQuantizer {
+  uint16_t offset;      // raw angle where slice 0 starts (calibration)
+  uint8_t slices;
+  uint16_t hysteresis;  // counts
+  uint16_t dwellMs;
+
+  // state, owned by slice_update()
+  int16_t held;         // slice after hysteresis, -1 before the first update
+  int16_t settled;      // `held` once it stayed put for dwellMs
+  uint32_t heldMs;      // when `held` last changed
+};
+
+// Aggregate-initialise: SliceQuantizer q = sliceQuantizer(12, RAW_OFFSET);
+constexpr SliceQuantizer sliceQuantizer(uint8_t slices, uint16_t offset,
+                                        uint16_t hysteresis = SLICE_HYSTERESIS,
+                                        uint16_t dwellMs = SLICE_DWELL_MS) {
+  return SliceQuantizer{ offset, slices, hysteresis, dwellMs, -1, -1, 0 };
+}
+
+// Fold in an angle; returns the settled slice (0..slices-1). The first update after
+// construction or slice_reset() settles immediately.
+uint8_t slice_update(SliceQuantizer& q, uint16_t raw, uint32_t nowMs);
+
+// Forget the current slice (module activation, recalibration).
+void slice_reset(SliceQuantizer& q);
+
+// True while the reported slice is the one the wheel is on (no change waiting out its dwell).
+inline bool slice_isSettled(const SliceQuantizer& q) {
+  return q.held >= 0 && q.held == q.settled;
+}
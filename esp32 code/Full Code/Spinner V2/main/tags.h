@@ -0,0 +1,34 @@
+// tags.h
+// RFID tag -> module (and album) mapping.
+//
+// Tags are declared by each module's descriptor in modules.h; the registry flattens them into
+// one table and the compiler builds a perfect hash over it. UIDs are written the way the serial
+// log prints them (uppercase hex, no separators) and may be 4, 7 or 10 bytes.
+#pragma once
+
+#include "uid.h"
+
+// Stable module ids (also the MQTT subscription owner ids). Builds that strip a module keep its
+// id; use Modules::indexOf() for the registry position.
+enum ModuleId : uint8_t {
+  MOD_FRIEND,
+  MOD_FAMILY,
+  MOD_DATE,
+  MOD_DAYS,
+  MOD_DISTANCE,
+  MOD_TIMELINE,
+  MOD_COUSINS,
+  MOD_AFAMILY,
+  MOD_THEMES,
+  MOD_ALBUM,
+  MOD_COUNT
+};
+
+struct TagEntry {
+  UidKey key;
+  ModuleId module;
+  const char* album;  // PhotoPrism album id for MOD_ALBUM tags, otherwise nullptr
+};
+
+// O(1), allocation free. nullptr for unknown tags (or tags of modules not in this build).
+const TagEntry* tagLookup(const UidKey& key);
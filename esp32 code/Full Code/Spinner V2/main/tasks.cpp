@@ -0,0 +1,335 @@
+// tasks.cpp
+// Sense / rfid / net tasks and the queues between them (see tasks.h for the graph).
+#include "tasks.h"
+#include "shared.h"
+#include "net.h"
+#include "scheduler.h"
+#include "perf.h"
+#include "encoder.h"
+#include "encoder_source.h"
+#include "oled.h"
+
+#define LOGGER_TAG "tasks"
+#define LOGGER_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include <AS5600.h>
+#include <atomic>
+
+namespace {
+
+// ===== CONFIG =====
+const BaseType_t SENSE_CORE = 1;
+const BaseType_t RFID_CORE = 0;
+const BaseType_t NET_CORE = 0;
+const BaseType_t DISPLAY_CORE = 0;
+
+const UBaseType_t SENSE_PRIO = 5;  // pre-empts the Arduino loop task (prio 1) on core 1
+const UBaseType_t RFID_PRIO = 2;
+const UBaseType_t NET_PRIO = 3;
+const UBaseType_t DISPLAY_PRIO = 4;  // mostly blocked on the bus, so it doesn't starve net
+
+const uint32_t SENSE_STACK = 3072;
+const uint32_t RFID_STACK = 4096;
+const uint32_t NET_STACK = 6144;
+const uint32_t DISPLAY_STACK = 3072;
+
+// declared rates of the periodic activities (rfid is event driven and paces itself)
+const uint32_t SENSE_HZ = 1000;  // encoder sampling (hardware timer)
+const uint32_t RENDER_HZ = 60;   // loop(): tag switching + active module frame
+const uint32_t NET_HZ = 20;      // connection manager, MQTT service, outbound queue
+
+// sense task never waits longer than this for the bus; a held bus means a display flush
+// is in progress, so we skip the sample instead of stalling the task
+const TickType_t SENSE_BUS_WAIT = pdMS_TO_TICKS(1);
+// other bus users step aside for a waiting sampler for at most one sense period
+const int64_t SENSE_BUS_YIELD_US = 1000000 / SENSE_HZ;
+
+const UBaseType_t TAG_QUEUE_LEN = 4;
+const UBaseType_t OUT_QUEUE_LEN = 16;
+
+enum NetOp : uint8_t { NET_PUBLISH, NET_SUBSCRIBE, NET_UNSUBSCRIBE, NET_RELEASE };
+
+struct NetRequest {
+  NetOp op;
+  uint8_t owner;  // ModuleId for subscription ops
+  char topic[TASK_TOPIC_MAX];
+  char payload[TASK_OUT_PAYLOAD_MAX];
+};
+
+// ===== STATE =====
+SemaphoreHandle_t i2cMutex = nullptr;
+// the sense task wants the bus: a give doesn't hand the mutex over, so a flush that takes it
+// again right after its page would otherwise starve the sampler for the whole frame. Stays set
+// after a sample was skipped, so the next transfer waits for the next sample.
+std::atomic<bool> senseWantsBus{false};
+QueueHandle_t tagQueue = nullptr;
+QueueHandle_t outQueue = nullptr;
+
+SchedRate senseRate = schedRateHz("sense", SENSE_HZ);
+SchedRate renderRate = schedRateHz("render", RENDER_HZ);
+SchedRate netRate = schedRateHz("net", NET_HZ);
+
+uint32_t droppedOut = 0;  // outbound requests lost: queue full, or a publish that didn't go out
+
+// display hand-over: displayFlush() copies into framePending, the display task swaps it with
+// frameFlushing under frameMutex (a pointer swap, so the render side never waits on the bus)
+TaskHandle_t displayTaskHandle = nullptr;
+SemaphoreHandle_t frameMutex = nullptr;
+uint8_t* framePending = nullptr;
+uint8_t* frameFlushing = nullptr;
+size_t frameBytes = 0;
+bool pendingFull = false;
+int64_t pendingUs = 0;  // when framePending was presented
+DisplayStats displayStats = {};  // under frameMutex: written by the render and display tasks
+
+static void copyStr(char* dst, size_t dstLen, const char* src) {
+  if (!src) src = "";
+  strncpy(dst, src, dstLen - 1);
+  dst[dstLen - 1] = '\0';
+}
+
+static bool postNetRequest(NetOp op, uint8_t owner, const char* topic, const char* payload) {
+  if (!outQueue || !topic) return false;
+  NetRequest req;
+  req.op = op;
+  req.owner = owner;
+  copyStr(req.topic, sizeof(req.topic), topic);
+  copyStr(req.payload, sizeof(req.payload), payload);
+  if (xQueueSend(outQueue, &req, 0) != pdTRUE) {
+    ++droppedOut;
+    LOGD("outbound queue full, dropped op=%d topic=%s", op, topic);
+    return false;
+  }
+  return true;
+}
+
+// ---- sense: sample the encoder ----
+static bool senseBusLock() {
+  if (!i2cMutex) return true;
+  senseWantsBus = true;
+  if (xSemaphoreTake(i2cMutex, SENSE_BUS_WAIT) != pdTRUE) return false;
+  senseWantsBus = false;
+  return true;
+}
+
+static void senseTask(void*) {
+  sched_bindTimer(senseRate);
+  for (;;) {
+    // the PWM source needs no bus, so display flushes don't hold it up
+    if (!ENCODER_SOURCE_USES_I2C || senseBusLock()) {
+      uint16_t raw = 0;
+      uint8_t status = 0;
+      bool ok;
+      {
+        PERF_SCOPE(PERF_ENCODER);
+        ok = encoder_sourceRead(raw, status);
+      }
+      if (ENCODER_SOURCE_USES_I2C) i2cUnlock();
+      if (ok) encoder_sample(raw, status, esp_timer_get_time());
+    }
+    sched_wait(senseRate);
+  }
+}
+
+// ---- rfid: wait for tag events (rfid.cpp paces itself) and forward them ----
+static void rfidTask(void*) {
+  rfid_bindCurrentTask();
+  for (;;) {
+    RfidEvent ev;
+    if (rfid_waitEvent(ev)) {
+      if (xQueueSend(tagQueue, &ev, 0) != pdTRUE) LOGD("tag queue full, event dropped");
+    }
+  }
+}
+
+// ---- display: send presented frames to the panel ----
+static void displayTask(void*) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    bool have = pendingFull;
+    int64_t presentedUs = pendingUs;
+    if (have) {
+      uint8_t* t = framePending;
+      framePending = frameFlushing;
+      frameFlushing = t;
+      pendingFull = false;
+    }
+    xSemaphoreGive(frameMutex);
+    if (!have) continue;
+
+    {
+      PERF_SCOPE(PERF_FLUSH);
+      oled_flush(frameFlushing);
+    }
+    uint32_t latency = uint32_t(esp_timer_get_time() - presentedUs);
+    // displayStats is shared with displayFlush() and tasks_displayStats(): all under frameMutex
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    displayStats.flushed++;
+    displayStats.lastLatencyUs = latency;
+    if (latency > displayStats.maxLatencyUs) displayStats.maxLatencyUs = latency;
+    xSemaphoreGive(frameMutex);
+  }
+}
+
+// ---- net: own the MQTT client ----
+static void drainOutbound() {
+  NetRequest req;
+  while (xQueueReceive(outQueue, &req, 0) == pdTRUE) {
+    switch (req.op) {
+      case NET_PUBLISH:
+        // offline or a failed write: publishes are dropped (and counted), not replayed
+        if (!net_online() || !mqttClient.publish(req.topic, req.payload)) {
+          ++droppedOut;
+          LOGD("publish to %s dropped", req.topic);
+        }
+        break;
+      case NET_SUBSCRIBE:
+        // the connection manager owns the subscription and (re)subscribes when it can
+        net_addSubscription(req.topic, req.owner);
+        break;
+      case NET_UNSUBSCRIBE:
+        net_removeSubscription(req.topic, req.owner);
+        break;
+      case NET_RELEASE:
+        net_releaseOwner(req.owner);
+        break;
+    }
+  }
+}
+
+static void netTask(void*) {
+  for (;;) {
+    {
+      PERF_SCOPE(PERF_NET);
+      net_tick(millis());
+    }
+    drainOutbound();
+    perf_report(millis());
+    sched_wait(netRate);
+  }
+}
+
+} // namespace
+
+// ---- lifecycle ----
+void tasks_init() {
+  if (!i2cMutex) i2cMutex = xSemaphoreCreateMutex();
+  if (!tagQueue) tagQueue = xQueueCreate(TAG_QUEUE_LEN, sizeof(RfidEvent));
+  if (!outQueue) outQueue = xQueueCreate(OUT_QUEUE_LEN, sizeof(NetRequest));
+  if (!frameMutex) frameMutex = xSemaphoreCreateMutex();
+  if (!framePending) {
+    frameBytes = size_t(display.width()) * ((display.height() + 7) / 8);
+    framePending = (uint8_t*)malloc(frameBytes);
+    frameFlushing = (uint8_t*)malloc(frameBytes);
+    if (!framePending || !frameFlushing) {
+      LOGW("no memory for frame buffers, flushing on the render task");
+      free(framePending);
+      free(frameFlushing);
+      framePending = frameFlushing = nullptr;
+    }
+  }
+
+  sched_register(senseRate);
+  sched_register(renderRate);
+  sched_register(netRate);
+  perf_begin();
+
+  // prime the encoder service so module setup() sees a real angle
+  uint16_t raw = 0;
+  uint8_t status = 0;
+  encoder_sourceRead(raw, status);
+  encoder_begin(raw, status, esp_timer_get_time());
+}
+
+void tasks_start(bool withNet) {
+  sched_begin();
+  xTaskCreatePinnedToCore(senseTask, "sense", SENSE_STACK, nullptr, SENSE_PRIO, nullptr, SENSE_CORE);
+  xTaskCreatePinnedToCore(rfidTask, "rfid", RFID_STACK, nullptr, RFID_PRIO, nullptr, RFID_CORE);
+  if (withNet) xTaskCreatePinnedToCore(netTask, "net", NET_STACK, nullptr, NET_PRIO, nullptr, NET_CORE);
+  if (framePending) {
+    xTaskCreatePinnedToCore(displayTask, "display", DISPLAY_STACK, nullptr, DISPLAY_PRIO,
+                            &displayTaskHandle, DISPLAY_CORE);
+  }
+  LOGI("%s", withNet ? "sense/rfid/net/display started" : "sense/rfid/display started (no net)");
+}
+
+// ---- render side ----
+void tasks_endFrame() {
+  sched_wait(renderRate);
+}
+
+bool tasks_nextTag(RfidEvent& out) {
+  return tagQueue && xQueueReceive(tagQueue, &out, 0) == pdTRUE;
+}
+
+DisplayStats tasks_displayStats() {
+  if (!frameMutex) return displayStats;  // before tasks_begin(): nothing else touches it yet
+  xSemaphoreTake(frameMutex, portMAX_DELAY);
+  DisplayStats copy = displayStats;  // one consistent snapshot, not torn across the counters
+  xSemaphoreGive(frameMutex);
+  return copy;
+}
+
+// ---- shared.h API ----
+bool publishJson(const char* topic, const char* payload) {
+  if (!net_online()) return false;
+  return postNetRequest(NET_PUBLISH, 0, topic, payload);
+}
+
+bool mqttSubscribe(uint8_t owner, const char* topic) {
+  return postNetRequest(NET_SUBSCRIBE, owner, topic, nullptr);
+}
+
+bool mqttUnsubscribe(uint8_t owner, const char* topic) {
+  return postNetRequest(NET_UNSUBSCRIBE, owner, topic, nullptr);
+}
+
+bool mqttReleaseAll(uint8_t owner) {
+  return postNetRequest(NET_RELEASE, owner, "", nullptr);
+}
+
+bool mqttIsConnected() {
+  return net_online();
+}
+
+uint32_t mqttSession() {
+  return net_session();
+}
+
+void displayFlush() {
+  PERF_SCOPE(PERF_DISPLAY);
+  if (!displayTaskHandle) {  // setup(), or no memory for the hand-over
+    oled_flush(display.getBuffer());
+    return;
+  }
+  xSemaphoreTake(frameMutex, portMAX_DELAY);
+  if (pendingFull) displayStats.dropped++;  // the previous frame never made it out: latest wins
+  memcpy(framePending, display.getBuffer(), frameBytes);
+  pendingFull = true;
+  pendingUs = esp_timer_get_time();
+  displayStats.presented++;
+  xSemaphoreGive(frameMutex);
+  xTaskNotifyGive(displayTaskHandle);
+}
+
+void ledShow() {
+  PERF_SCOPE(PERF_LED);
+  FastLED.show();
+}
+
+bool i2cLock(TickType_t waitTicks) {
+  if (!i2cMutex) return true;  // before tasks_init(): single-threaded
+  // let a waiting sample go first (it takes the mutex, and we block on it below)
+  int64_t until = esp_timer_get_time() + SENSE_BUS_YIELD_US;
+  while (senseWantsBus && esp_timer_get_time() < until) taskYIELD();
+  return xSemaphoreTake(i2cMutex, waitTicks) == pdTRUE;
+}
+
+void i2cUnlock() {
+  if (i2cMutex) xSemaphoreGive(i2cMutex);
+}
@@ -0,0 +1,47 @@
+// tasks.h
+// FreeRTOS task graph for Spinner V2.
+//
+//   sense  (core 1, high prio)  AS5600 sampling (1 kHz, timer released) into the encoder service
+//   rfid   (core 0)             MFRC522 IRQ/poll presence detection -> tag queue
+//   net    (core 0)             net_tick() connection manager (20 Hz), drains the outbound queue,
+//                               runs mqtt_router handlers for inbound messages
+//   display (core 0)            streams presented frames to the OLED (displayFlush() hands over)
+//   loop() (core 1, Arduino)    render/control at 60 Hz: tag switching, active module loop
+//
+// Rates are declared in tasks.cpp and kept by scheduler.h; module loops must not sleep.
+//
+// Tasks only talk through the bounded queues below. Nothing outside the net task may touch
+// mqttClient directly; use publishJson()/mqttSubscribe()/mqttUnsubscribe() from shared.h.
+#pragma once
+
+#include <Arduino.h>
+#include "rfid.h"
+
+// sizes of the fixed queue slots (messages that do not fit are truncated / dropped)
+const size_t TASK_TOPIC_MAX = 96;
+const size_t TASK_OUT_PAYLOAD_MAX = 192;
+
+// Call once after Wire/AS5600/display are up and before any module setup().
+void tasks_init();
+// Spawns sense/rfid (and net) tasks. Call at the end of setup().
+void tasks_start(bool withNet = true);
+
+// render side: non-blocking queue reads (return false when empty)
+bool tasks_nextTag(RfidEvent& out);
+// render side: end of a loop() frame, sleeps until the next one is due
+void tasks_endFrame();
+
+// displayFlush() hand-over counters
+struct DisplayStats {
+  uint32_t presented;     // displayFlush() calls
+  uint32_t flushed;       // frames sent to the panel
+  uint32_t dropped;       // frames replaced before the display task got to them
+  uint32_t lastLatencyUs; // displayFlush() -> frame on the panel
+  uint32_t maxLatencyUs;  // since boot
+};
+DisplayStats tasks_displayStats();  // any task: a consistent snapshot
+
+// I2C bus lock shared by the encoder sampler and display flushes. A sample waiting for the bus
+// goes before the next i2cLock() caller, so a flush holds the sampler off one transfer at a time.
+bool i2cLock(TickType_t waitTicks = portMAX_DELAY);
+void i2cUnlock();
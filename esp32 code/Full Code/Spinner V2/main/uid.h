@@ -0,0 +1,144 @@
+// uid.h
+// RFID UID value type, packed UID keys and a compile-time perfect hash over them.
+//
+// Uid is what the tag path carries end to end (rfid task -> queue -> loop() -> modules): a
+// fixed-size, trivially copyable value, so reading and switching tags never touches the heap.
+// Hex text is only produced for logging.
+//
+// A UID (4, 7 or 10 bytes on ISO14443A) is packed big-endian into an integer pair: the last
+// eight bytes go into `lo`, anything before that into `hi`. The length is part of the key, so
+// a 4-byte tag never aliases a 7-byte tag that happens to have leading zero bytes.
+//
+// Needs C++17 (arduino-esp32 3.x) for the constexpr loops.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+
+struct UidKey {
+  uint8_t len;   // 0 = no UID
+  uint16_t hi;   // bytes [0, len-8) for 10-byte UIDs
+  uint64_t lo;   // last min(len, 8) bytes
+
+  constexpr bool operator==(const UidKey& o) const { return len == o.len && hi == o.hi && lo == o.lo; }
+  constexpr bool operator!=(const UidKey& o) const { return !(*this == o); }
+};
+
+constexpr int uidHexNibble(char c) {
+  return (c >= '0' && c <= '9') ? c - '0'
+       : (c >= 'A' && c <= 'F') ? c - 'A' + 10
+       : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+       : -1;
+}
+
+// Append one byte to a packed key (used both at compile time and per tag read).
+constexpr void uidKeyPush(UidKey& k, uint8_t b) {
+  k.hi = uint16_t((k.hi << 8) | uint8_t(k.lo >> 56));
+  k.lo = (k.lo << 8) | b;
+  ++k.len;
+}
+
+// "1D0B1CBB8A0000" -> {7, 0, 0x1D0B1CBB8A0000}. Malformed or odd-length strings give len 0.
+constexpr UidKey uidKeyFromHex(const char* hex) {
+  UidKey k{0, 0, 0};
+  if (!hex) return k;
+  size_t i = 0;
+  for (; hex[i] && hex[i + 1]; i += 2) {
+    int h = uidHexNibble(hex[i]), l = uidHexNibble(hex[i + 1]);
+    if (h < 0 || l < 0 || k.len >= 10) return UidKey{0, 0, 0};
+    uidKeyPush(k, uint8_t((h << 4) | l));
+  }
+  if (hex[i]) return UidKey{0, 0, 0};  // odd length
+  return k;
+}
+
+inline UidKey uidKeyFromBytes(const uint8_t* bytes, uint8_t len) {
+  UidKey k{0, 0, 0};
+  for (uint8_t i = 0; i < len && i < 10; ++i) uidKeyPush(k, bytes[i]);
+  return k;
+}
+
+const uint8_t UID_MAX_BYTES = 10;
+const size_t UID_HEX_LEN = 2 * UID_MAX_BYTES + 1;  // buffer size for uidFormat()
+
+struct Uid {
+  uint8_t len;  // 0 = none
+  uint8_t bytes[UID_MAX_BYTES];
+
+  bool empty() const { return len == 0; }
+  void clear() { len = 0; }
+  UidKey key() const { return uidKeyFromBytes(bytes, len); }
+
+  bool operator==(const Uid& o) const {
+    if (len != o.len) return false;
+    for (uint8_t i = 0; i < len; ++i) if (bytes[i] != o.bytes[i]) return false;
+    return true;
+  }
+  bool operator!=(const Uid& o) const { return !(*this == o); }
+};
+
+inline Uid uidFromBytes(const uint8_t* bytes, uint8_t len) {
+  Uid u;
+  u.len = len < UID_MAX_BYTES ? len : UID_MAX_BYTES;
+  for (uint8_t i = 0; i < u.len; ++i) u.bytes[i] = bytes[i];
+  return u;
+}
+
+// Uppercase hex without separators (the format tags.h uses). For logging only.
+inline const char* uidFormat(const Uid& uid, char* out, size_t outLen) {
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+  size_t pos = 0;
+  for (uint8_t i = 0; i < uid.len && pos + 2 < outLen; ++i) {
+    out[pos++] = HEX_DIGITS[uid.bytes[i] >> 4];
+    out[pos++] = HEX_DIGITS[uid.bytes[i] & 0x0F];
+  }
+  if (outLen) out[pos] = '\0';
+  return out;
+}
+
+// 64-bit finaliser (murmur3 fmix64) over the packed key, salted with `seed`
+constexpr uint32_t uidHash(const UidKey& k, uint32_t seed) {
+  uint64_t x = k.lo ^ (uint64_t(k.hi) << 40) ^ (uint64_t(k.len) << 58) ^ (uint64_t(seed) * 0x9E3779B97F4A7C15ULL);
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return uint32_t(x);
+}
+
+constexpr size_t uidHashSlots(size_t n) {
+  size_t s = 1;
+  while (s < 2 * n) s <<= 1;
+  return s;
+}
+
+// Slot -> entry index, collision free for the keys it was built from.
+template <size_t N>
+struct UidPerfectHash {
+  static constexpr size_t SLOTS = uidHashSlots(N);
+  uint32_t seed;           // 0 = build failed (duplicate keys)
+  int8_t slot[SLOTS];
+
+  constexpr int find(const UidKey& k) const { return slot[uidHash(k, seed) & (SLOTS - 1)]; }
+};
+
+// Searches salts until every key lands in its own slot. `Entry` needs a `key` member.
+template <typename Entry, size_t N>
+constexpr UidPerfectHash<N> uidBuildPerfectHash(const std::array<Entry, N>& entries) {
+  static_assert(N < 128, "slot indices are int8_t");
+  for (uint32_t seed = 1; seed < 10000; ++seed) {
+    UidPerfectHash<N> t{};
+    t.seed = seed;
+    for (size_t s = 0; s < t.SLOTS; ++s) t.slot[s] = -1;
+    bool ok = true;
+    for (size_t i = 0; i < N && ok; ++i) {
+      size_t s = uidHash(entries[i].key, seed) & (t.SLOTS - 1);
+      if (t.slot[s] >= 0) ok = false;
+      else t.slot[s] = int8_t(i);
+    }
+    if (ok) return t;
+  }
+  return UidPerfectHash<N>{};
+}
@@ -0,0 +1,48 @@
+// check.h
+// Minimal host test framework: TEST(name) registers a case, CHECK* record failures without
+// stopping the case. test_main.cpp runs every case of the executable and sets the exit code.
+#pragma once
+
+#include <stdio.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct TestCase {
+  const char* name;
+  void (*fn)();
+};
+
+std::vector<TestCase>& testCases();
+void checkFailed(const char* file, int line, const std::string& what);
+
+inline bool registerTest(const char* name, void (*fn)()) {
+  testCases().push_back(TestCase{ name, fn });
+  return true;
+}
+
+#define TEST(name)                                           \
+  static void name();                                        \
+  static const bool name##_registered = registerTest(#name, name); \
+  static void name()
+
+#define CHECK(cond) \
+  do { if (!(cond)) checkFailed(__FILE__, __LINE__, #cond); } while (0)
+
+#define CHECK_OP_(a, op, b)                                                  \
+  do {                                                                       \
+    auto checkA_ = (a);                                                      \
+    auto checkB_ = (b);                                                      \
+    if (!(checkA_ op checkB_)) {                                             \
+      std::ostringstream checkMsg_;                                          \
+      checkMsg_ << #a " " #op " " #b " (" << +checkA_ << " vs " << +checkB_ << ")"; \
+      checkFailed(__FILE__, __LINE__, checkMsg_.str());                      \
+    }                                                                        \
+  } while (0)
+
+#define CHECK_EQ(a, b) CHECK_OP_(a, ==, b)
+#define CHECK_NE(a, b) CHECK_OP_(a, !=, b)
+#define CHECK_LT(a, b) CHECK_OP_(a, <, b)
+#define CHECK_LE(a, b) CHECK_OP_(a, <=, b)
+#define CHECK_GT(a, b) CHECK_OP_(a, >, b)
+#define CHECK_GE(a, b) CHECK_OP_(a, >=, b)
@@ -0,0 +1,16 @@
+// AS5600.h (host shim) - the sketch only reads the sensor through encoder_source
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+class AS5600 {
+ public:
+  explicit AS5600(TwoWire* w = &Wire) { (void)w; }
+  bool begin(int = 255) { return true; }
+  bool isConnected() { return true; }
+  uint16_t rawAngle() { return raw; }
+  uint16_t readAngle() { return raw; }
+  uint8_t readStatus() { return 0x20; }
+  uint16_t raw = 0;
+};
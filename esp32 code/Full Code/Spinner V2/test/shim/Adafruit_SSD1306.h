@@ -0,0 +1,62 @@
+// Adafruit_SSD1306.h (host shim)
+// Framebuffer in the controller's page layout (one byte = 8 vertical pixels, a row of bytes
+// per page), as getBuffer() returns it on the device. display() only counts full pushes.
+#pragma once
+
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define BLACK SSD1306_BLACK
+#define WHITE SSD1306_WHITE
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_EXTERNALVCC 0x01
+#define SSD1306_MEMORYMODE 0x20
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_SEGREMAP 0xA0
+#define SSD1306_COMSCANDEC 0xC8
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+ public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst = -1)
+      : Adafruit_GFX(w, h), wire(twi), buffer(new uint8_t[size_t(w) * ((h + 7) / 8)]()) {
+    (void)rst;
+  }
+  ~Adafruit_SSD1306() { delete[] buffer; }
+
+  bool begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t addr = 0x3C, bool reset = true, bool periphBegin = true) {
+    (void)vcs; (void)addr; (void)reset; (void)periphBegin;
+    return true;
+  }
+  void display() { ++fullPushes; }
+  void clearDisplay() { memset(buffer, 0, bufferBytes()); }
+  void invertDisplay(bool) {}
+  void dim(bool) {}
+  void ssd1306_command(uint8_t) {}
+  uint8_t* getBuffer() { return buffer; }
+  size_t bufferBytes() const { return size_t(WIDTH) * ((HEIGHT + 7) / 8); }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return;
+    uint8_t& b = buffer[x + (y / 8) * WIDTH];
+    uint8_t m = uint8_t(1 << (y & 7));
+    if (color == SSD1306_WHITE) b |= m;
+    else if (color == SSD1306_BLACK) b &= uint8_t(~m);
+    else if (color == SSD1306_INVERSE) b ^= m;
+  }
+  bool getPixel(int16_t x, int16_t y) const {
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return false;
+    return buffer[x + (y / 8) * WIDTH] & (1 << (y & 7));
+  }
+
+  uint32_t fullPushes = 0;
+
+ private:
+  TwoWire* wire;
+  uint8_t* buffer;
+};
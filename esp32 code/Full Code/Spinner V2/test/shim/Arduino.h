@@ -0,0 +1,201 @@
+// Arduino.h (host shim)
+// Just enough of the Arduino-ESP32 core to build the sketch's portable sources on a PC:
+// String, Print/Serial, the time functions and a few ESP helpers. FreeRTOS comes from the
+// pthread shim next to this file.
+//
+// Time: millis()/micros()/esp_timer_get_time() read the real monotonic clock, unless a test
+// switches to the manual clock (shim_clockManual()), which only moves through shim_advanceUs()
+// or delay().
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+#include <algorithm>
+#include <string>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define IRAM_ATTR
+#define DEC 10
+#define HEX 16
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define FALLING 2
+#define digitalPinToInterrupt(p) (p)
+#define pgm_read_byte(a) (*(const uint8_t*)(a))
+#define pgm_read_word(a) (*(const uint16_t*)(a))
+#define pgm_read_dword(a) (*(const uint32_t*)(a))
+#define pgm_read_ptr(a) (*(void* const*)(a))
+
+class String {
+ public:
+  String(const char* s = "") : s_(s ? s : "") {}
+  String(const std::string& s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  String(int v, int base = DEC) : s_(fmt(long(v), base)) {}
+  String(long v, int base = DEC) : s_(fmt(v, base)) {}
+  String(unsigned v, int base = DEC) : s_(fmtU((unsigned long)v, base)) {}
+  String(unsigned long v, int base = DEC) : s_(fmtU(v, base)) {}
+
+  const char* c_str() const { return s_.c_str(); }
+  unsigned length() const { return unsigned(s_.size()); }
+  char charAt(unsigned i) const { return i < s_.size() ? s_[i] : 0; }
+  char operator[](unsigned i) const { return charAt(i); }
+
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  String& operator+=(const char* o) { s_ += o ? o : ""; return *this; }
+  String& operator+=(char c) { s_ += c; return *this; }
+  String& operator+=(int v) { s_ += fmt(v, DEC); return *this; }
+
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator==(const char* o) const { return s_ == (o ? o : ""); }
+  bool operator!=(const String& o) const { return s_ != o.s_; }
+  bool operator!=(const char* o) const { return !(*this == o); }
+  bool equalsIgnoreCase(const String& o) const { return strcasecmp(s_.c_str(), o.s_.c_str()) == 0; }
+
+  bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  bool endsWith(const String& p) const {
+    return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+  }
+  int indexOf(char c, unsigned from = 0) const {
+    size_t i = s_.find(c, from);
+    return i == std::string::npos ? -1 : int(i);
+  }
+  String substring(unsigned from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned from, unsigned to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s_.size()) return String();
+    return String(s_.substr(from, std::min<size_t>(to, s_.size()) - from));
+  }
+  long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(s_.c_str(), nullptr); }
+  void trim() {
+    size_t a = s_.find_first_not_of(" \t\r\n");
+    size_t b = s_.find_last_not_of(" \t\r\n");
+    s_ = a == std::string::npos ? std::string() : s_.substr(a, b - a + 1);
+  }
+  void toUpperCase() { for (char& c : s_) c = char(toupper((unsigned char)c)); }
+  void toLowerCase() { for (char& c : s_) c = char(tolower((unsigned char)c)); }
+
+ private:
+  static std::string fmt(long v, int base) {
+    if (v < 0 && base == DEC) return "-" + fmtU((unsigned long)(-v), base);
+    return fmtU((unsigned long)v, base);
+  }
+  static std::string fmtU(unsigned long v, int base) {
+    char buf[72];
+    char* p = buf + sizeof(buf) - 1;
+    *p = '\0';
+    do { *--p = "0123456789ABCDEF"[v % base]; v /= base; } while (v);
+    return p;
+  }
+  std::string s_;
+};
+
+inline String operator+(const String& a, const String& b) { String r = a; r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r = a; r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r = a; r += b; return r; }
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) { return 1; }
+  virtual size_t write(const uint8_t* b, size_t n) {
+    size_t out = 0;
+    while (n--) out += write(*b++);
+    return out;
+  }
+  size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write(uint8_t(c)); }
+  size_t print(int v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned v, int base = DEC) { return print(String(v, base)); }
+  size_t print(long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(long long v, int base = DEC) { return print(String(long(v), base)); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  template <typename T>
+  size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  size_t println() { return write("\r\n"); }
+  size_t printf(const char* f, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list ap;
+    va_start(ap, f);
+    int n = vsnprintf(buf, sizeof(buf), f, ap);
+    va_end(ap);
+    return n > 0 ? write((const uint8_t*)buf, std::min<size_t>(size_t(n), sizeof(buf) - 1)) : 0;
+  }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  String readStringUntil(char) { return String(); }
+};
+
+// Serial output is discarded unless SPINNER_SHIM_SERIAL is set in the environment.
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long) {}
+  operator bool() const { return true; }
+  size_t write(uint8_t c) override;
+  using Print::write;
+};
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+int analogRead(uint8_t pin);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t v);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+
+uint32_t esp_random();
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+uint32_t getCpuFrequencyMhz();
+
+struct EspClass {
+  uint64_t getEfuseMac() { return 0x0000A1B2C3D4E5F6ULL; }
+  uint32_t getCycleCount();  // 240 "cycles" per microsecond, like the S3 at full speed
+  uint32_t getFreeHeap() { return 200000; }
+};
+extern EspClass ESP;
+
+// ---- host-only test controls ----
+void shim_clockManual(bool manual);  // manual: time only moves via shim_advanceUs()/delay()
+void shim_advanceUs(uint64_t us);
+void shim_setUs(uint64_t us);
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
@@ -0,0 +1,129 @@
+// ArduinoJson.h (host shim)
+// The slice of ArduinoJson 6 the sketch uses on inbound messages: deserializeJson() of one flat
+// object, containsKey(), and `doc["key"] | default` for numbers and strings. Nested values are
+// skipped over and read as missing.
+#pragma once
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+
+class DeserializationError {
+ public:
+  enum Code { Ok, InvalidInput };
+  DeserializationError(Code c = Ok) : code(c) {}
+  explicit operator bool() const { return code != Ok; }
+  const char* c_str() const { return code == Ok ? "Ok" : "InvalidInput"; }
+
+ private:
+  Code code;
+};
+
+class JsonVariantConst {
+ public:
+  JsonVariantConst(const std::string* value, bool isString) : v(value), str(isString) {}
+  int operator|(int fallback) const { return v && !str ? int(strtol(v->c_str(), nullptr, 10)) : fallback; }
+  long operator|(long fallback) const { return v && !str ? strtol(v->c_str(), nullptr, 10) : fallback; }
+  float operator|(float fallback) const { return v && !str ? strtof(v->c_str(), nullptr) : fallback; }
+  const char* operator|(const char* fallback) const { return v && str ? v->c_str() : fallback; }
+
+ private:
+  const std::string* v;
+  bool str;
+};
+
+class JsonDocument {
+ public:
+  bool containsKey(const char* key) const { return members.count(key) != 0; }
+  JsonVariantConst operator[](const char* key) const {
+    auto it = members.find(key);
+    if (it == members.end()) return JsonVariantConst(nullptr, false);
+    return JsonVariantConst(&it->second.text, it->second.isString);
+  }
+  void clear() { members.clear(); }
+
+  struct Value {
+    std::string text;
+    bool isString;
+  };
+  std::map<std::string, Value> members;
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument {};
+
+namespace shim_json {
+
+inline void skipWs(const char*& p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+}
+
+inline bool parseString(const char*& p, const char* end, std::string& out) {
+  if (p >= end || *p != '"') return false;
+  ++p;
+  while (p < end && *p != '"') {
+    if (*p == '\\' && p + 1 < end) ++p;
+    out += *p++;
+  }
+  if (p >= end) return false;
+  ++p;
+  return true;
+}
+
+// skip one nested object/array (strings inside may contain brackets)
+inline bool skipNested(const char*& p, const char* end) {
+  int depth = 0;
+  while (p < end) {
+    if (*p == '"') {
+      std::string ignored;
+      if (!parseString(p, end, ignored)) return false;
+      continue;
+    }
+    if (*p == '{' || *p == '[') ++depth;
+    if (*p == '}' || *p == ']') --depth;
+    ++p;
+    if (depth == 0) return true;
+  }
+  return false;
+}
+
+} // namespace shim_json
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* json, size_t len) {
+  using namespace shim_json;
+  doc.clear();
+  const char* p = json;
+  const char* end = json + len;
+  skipWs(p, end);
+  if (p >= end || *p != '{') return DeserializationError::InvalidInput;
+  ++p;
+  for (;;) {
+    skipWs(p, end);
+    if (p < end && *p == '}') return DeserializationError::Ok;
+    std::string key;
+    if (!parseString(p, end, key)) return DeserializationError::InvalidInput;
+    skipWs(p, end);
+    if (p >= end || *p++ != ':') return DeserializationError::InvalidInput;
+    skipWs(p, end);
+    if (p >= end) return DeserializationError::InvalidInput;
+    if (*p == '"') {
+      JsonDocument::Value v{ std::string(), true };
+      if (!parseString(p, end, v.text)) return DeserializationError::InvalidInput;
+      doc.members[key] = v;
+    } else if (*p == '{' || *p == '[') {
+      if (!skipNested(p, end)) return DeserializationError::InvalidInput;
+    } else {
+      const char* start = p;
+      while (p < end && *p != ',' && *p != '}' && *p != ' ') ++p;
+      doc.members[key] = JsonDocument::Value{ std::string(start, p), false };
+    }
+    skipWs(p, end);
+    if (p < end && *p == ',') { ++p; continue; }
+    if (p < end && *p == '}') return DeserializationError::Ok;
+    return DeserializationError::InvalidInput;
+  }
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* json) {
+  return deserializeJson(doc, json, strlen(json));
+}
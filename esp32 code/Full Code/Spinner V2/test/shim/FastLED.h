@@ -0,0 +1,38 @@
+// FastLED.h (host shim) - colour types and a show() counter
+#pragma once
+
+#include <Arduino.h>
+
+struct CRGB {
+  uint8_t r = 0, g = 0, b = 0;
+
+  enum HTMLColorCode : uint32_t {
+    Black = 0x000000, White = 0xFFFFFF, Grey = 0x808080, Red = 0xFF0000, Orange = 0xFFA500,
+    Yellow = 0xFFFF00, Green = 0x008000, Lime = 0x00FF00, Cyan = 0x00FFFF, Blue = 0x0000FF,
+    Purple = 0x800080, Magenta = 0xFF00FF, Pink = 0xFFC0CB, Brown = 0xA52A2A,
+  };
+
+  CRGB() = default;
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(HTMLColorCode c) : r(uint8_t(c >> 16)), g(uint8_t(c >> 8)), b(uint8_t(c)) {}
+  bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+  bool operator!=(const CRGB& o) const { return !(*this == o); }
+};
+
+struct CHSV {
+  uint8_t h, s, v;
+  CHSV(uint8_t ih, uint8_t is, uint8_t iv) : h(ih), s(is), v(iv) {}
+  operator CRGB() const { return CRGB(v, v, v); }  // brightness only; hue is not modelled
+};
+
+enum EOrder { RGB, GRB };
+enum ESPIChipsets { WS2812B, NEOPIXEL };
+
+struct CFastLED {
+  template <ESPIChipsets CHIPSET, uint8_t PIN, EOrder ORDER = GRB>
+  void addLeds(CRGB*, int) {}
+  void setBrightness(uint8_t) {}
+  void show() { ++shows; }
+  uint32_t shows = 0;
+};
+extern CFastLED FastLED;
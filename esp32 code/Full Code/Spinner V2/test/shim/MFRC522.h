@@ -0,0 +1,54 @@
+// MFRC522.h (host shim)
+// The calls rfid.cpp makes, against one simulated card: a test puts a card in the field
+// (`card`, `cardPresent`) and the reader answers WUPA / anticollision with it.
+#pragma once
+
+#include <Arduino.h>
+
+class MFRC522 {
+ public:
+  enum PCD_Register : byte {
+    CommandReg = 0x01 << 1,
+    ComIEnReg = 0x02 << 1,
+    DivIEnReg = 0x03 << 1,
+    ComIrqReg = 0x04 << 1,
+    FIFODataReg = 0x09 << 1,
+    FIFOLevelReg = 0x0A << 1,
+    BitFramingReg = 0x0D << 1,
+  };
+  enum PCD_Command : byte { PCD_Idle = 0x00, PCD_Transceive = 0x0C };
+  enum PICC_Command : byte { PICC_CMD_WUPA = 0x52 };
+  enum StatusCode : byte { STATUS_OK, STATUS_ERROR, STATUS_COLLISION, STATUS_TIMEOUT };
+
+  struct Uid {
+    byte size;
+    byte uidByte[10];
+    byte sak;
+  };
+  Uid uid = {};
+
+  void PCD_WriteRegister(PCD_Register, byte) { ++registerWrites; }
+
+  StatusCode PICC_WakeupA(byte* atqa, byte* size) {
+    if (!cardPresent) return STATUS_TIMEOUT;
+    if (atqa && size && *size >= 2) {
+      atqa[0] = 0x44;
+      atqa[1] = 0x00;
+      *size = 2;
+    }
+    return STATUS_OK;
+  }
+
+  bool PICC_ReadCardSerial() {
+    if (!cardPresent) return false;
+    uid = card;
+    return true;
+  }
+
+  StatusCode PICC_HaltA() { return STATUS_OK; }
+
+  // ---- host-only test controls ----
+  Uid card = {};
+  bool cardPresent = false;
+  uint32_t registerWrites = 0;
+};
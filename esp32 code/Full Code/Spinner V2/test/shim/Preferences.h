@@ -0,0 +1,32 @@
+// Preferences.h (host shim) - an in-memory NVS namespace per process
+#pragma once
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+ public:
+  bool begin(const char* ns, bool = false) { name = ns; return true; }
+  void end() {}
+  size_t getBytes(const char* key, void* out, size_t len) {
+    auto& v = store()[name + "/" + key];
+    size_t n = v.size() < len ? v.size() : len;
+    memcpy(out, v.data(), n);
+    return n;
+  }
+  size_t putBytes(const char* key, const void* in, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(in);
+    store()[name + "/" + key].assign(p, p + len);
+    return len;
+  }
+  size_t getBytesLength(const char* key) { return store()[name + "/" + key].size(); }
+
+ private:
+  static std::map<std::string, std::vector<uint8_t>>& store() {
+    static std::map<std::string, std::vector<uint8_t>> s;
+    return s;
+  }
+  std::string name;
+};
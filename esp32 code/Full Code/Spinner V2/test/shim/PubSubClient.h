@@ -0,0 +1,59 @@
+// PubSubClient.h (host shim)
+// A broker stand-in: connect/subscribe/publish results are set by the test and every call
+// is recorded.
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string>
+#include <vector>
+
+#define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
+
+class PubSubClient {
+ public:
+  explicit PubSubClient(WiFiClient&) {}
+  PubSubClient& setServer(const char*, uint16_t) { return *this; }
+  PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) { cb = callback; return *this; }
+  PubSubClient& setSocketTimeout(uint16_t) { return *this; }
+  bool setBufferSize(uint16_t) { return true; }
+
+  // as the library: a client whose socket still looks open reports success without a CONNECT
+  bool connect(const char*) {
+    if (isConnected) return true;
+    ++connects;
+    isConnected = acceptConnect;
+    return isConnected;
+  }
+  bool connected() { return isConnected; }
+  bool loop() { return isConnected; }
+  int state() { return isConnected ? 0 : -2; }
+  void disconnect() { isConnected = false; }
+
+  bool publish(const char* topic, const char* payload) {
+    if (!isConnected || !acceptPublish) return false;
+    published.push_back({topic, payload});
+    return true;
+  }
+  bool subscribe(const char* topic, uint8_t = 0) {
+    subscribeCalls.push_back(topic);
+    if (!isConnected) return false;
+    for (const std::string& t : refuse) if (t == topic) return false;
+    return true;
+  }
+  bool unsubscribe(const char* topic) {
+    unsubscribed.push_back(topic);
+    return isConnected;
+  }
+
+  // test controls and records
+  bool acceptConnect = true;
+  bool acceptPublish = true;
+  bool isConnected = false;
+  std::vector<std::string> refuse;  // topics whose SUBSCRIBE fails
+  uint32_t connects = 0;
+  std::vector<std::pair<std::string, std::string>> published;
+  std::vector<std::string> subscribeCalls;
+  std::vector<std::string> unsubscribed;
+  void (*cb)(char*, uint8_t*, unsigned int) = nullptr;
+};
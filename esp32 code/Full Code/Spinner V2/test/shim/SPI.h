@@ -0,0 +1,4 @@
+// SPI.h (host shim) - the RC522 is reached through the MFRC522 shim only
+#pragma once
+
+#include <Arduino.h>
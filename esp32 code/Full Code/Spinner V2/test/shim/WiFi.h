@@ -0,0 +1,22 @@
+// WiFi.h (host shim) - link state is set by the test
+#pragma once
+
+#include <Arduino.h>
+
+typedef enum { WL_IDLE_STATUS = 0, WL_DISCONNECTED = 6, WL_CONNECTED = 3 } wl_status_t;
+typedef enum { WIFI_OFF, WIFI_STA } wifi_mode_t;
+
+class WiFiClass {
+ public:
+  wl_status_t status() { return linkUp ? WL_CONNECTED : WL_DISCONNECTED; }
+  void mode(wifi_mode_t) {}
+  void setAutoReconnect(bool) {}
+  void begin(const char*, const char*) { ++begins; }
+  void disconnect() {}
+
+  bool linkUp = false;
+  uint32_t begins = 0;
+};
+extern WiFiClass WiFi;
+
+class WiFiClient {};
@@ -0,0 +1,10 @@
+// WiFiUdp.h (host shim)
+#pragma once
+
+#include <Arduino.h>
+
+class WiFiUDP : public Print {
+ public:
+  int beginPacket(const char*, uint16_t) { return 1; }
+  int endPacket() { return 1; }
+};
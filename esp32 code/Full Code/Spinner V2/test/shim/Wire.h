@@ -0,0 +1,43 @@
+// Wire.h (host shim)
+// An I2C master that hands every finished write transaction to a test hook (a device model),
+// takes read data from a second hook, and can charge a fixed bus time per byte, like the
+// 400 kHz bus on the board.
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+class TwoWire : public Stream {
+ public:
+  // (address, bytes) -> endTransmission() result; 0 = ACK
+  using Device = std::function<uint8_t(uint8_t, const std::vector<uint8_t>&)>;
+  // (address, length) -> the bytes the device returns; fewer than asked = NACK
+  using Reader = std::function<std::vector<uint8_t>(uint8_t, uint8_t)>;
+
+  bool begin(int sda = -1, int scl = -1, uint32_t freq = 0);
+  void setClock(uint32_t hz) { clockHz = hz; }
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* b, size_t n) override;
+  uint8_t endTransmission(bool stop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t len);
+  int available() override { return int(rx.size() - rxPos); }
+  int read() override { return rxPos < rx.size() ? rx[rxPos++] : -1; }
+
+  // test controls
+  Device device;          // nullptr: everything ACKs
+  Reader reader;          // nullptr: reads get nothing
+  uint32_t byteTimeUs = 0;  // bus time charged per byte (address byte included)
+  uint32_t transactions = 0;
+  uint32_t bytes = 0;
+
+ private:
+  uint32_t clockHz = 100000;
+  uint8_t txAddress = 0;
+  std::vector<uint8_t> tx;
+  std::vector<uint8_t> rx;
+  size_t rxPos = 0;
+};
+
+extern TwoWire Wire;
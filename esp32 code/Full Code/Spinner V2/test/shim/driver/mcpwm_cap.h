@@ -0,0 +1,82 @@
+// driver/mcpwm_cap.h (host shim)
+// The MCPWM capture API encoder_source.cpp uses. There is no timer: a test plays a waveform by
+// handing edges (capture timer value, edge) to shim_mcpwmEdge(), which runs the registered
+// callback as the capture ISR would. shim_mcpwmOnStart runs when the timer starts, so a test can
+// have frames arrive while encoder_sourceBegin() waits for them.
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+typedef struct ShimCapTimer* mcpwm_cap_timer_handle_t;
+typedef struct ShimCapChannel* mcpwm_cap_channel_handle_t;
+
+typedef enum { MCPWM_CAPTURE_CLK_SRC_DEFAULT } mcpwm_capture_clock_source_t;
+typedef enum { MCPWM_CAP_EDGE_POS, MCPWM_CAP_EDGE_NEG } mcpwm_capture_edge_t;
+
+struct mcpwm_capture_timer_config_t {
+  int group_id;
+  mcpwm_capture_clock_source_t clk_src;
+  uint32_t resolution_hz;
+};
+
+struct mcpwm_capture_channel_config_t {
+  int gpio_num;
+  uint32_t prescale;
+  struct {
+    uint32_t pos_edge : 1;
+    uint32_t neg_edge : 1;
+    uint32_t pull_up : 1;
+    uint32_t pull_down : 1;
+  } flags;
+};
+
+struct mcpwm_capture_event_data_t {
+  uint32_t cap_value;
+  mcpwm_capture_edge_t cap_edge;
+};
+
+typedef bool (*mcpwm_capture_event_cb_t)(mcpwm_cap_channel_handle_t, const mcpwm_capture_event_data_t*, void*);
+
+struct mcpwm_capture_event_callbacks_t {
+  mcpwm_capture_event_cb_t on_cap;
+};
+
+// ---- host-only test controls ----
+const uint32_t SHIM_MCPWM_CAPTURE_HZ = 80000000;  // APB clock, the default capture source
+inline mcpwm_capture_event_cb_t shimMcpwmCallback = nullptr;
+inline void* shimMcpwmContext = nullptr;
+inline std::function<void()> shim_mcpwmOnStart;
+
+// one captured edge at capture timer value `tick`
+inline void shim_mcpwmEdge(uint32_t tick, bool rising) {
+  mcpwm_capture_event_data_t e = { tick, rising ? MCPWM_CAP_EDGE_POS : MCPWM_CAP_EDGE_NEG };
+  if (shimMcpwmCallback) shimMcpwmCallback(nullptr, &e, shimMcpwmContext);
+}
+
+inline esp_err_t mcpwm_new_capture_timer(const mcpwm_capture_timer_config_t*, mcpwm_cap_timer_handle_t* out) {
+  *out = reinterpret_cast<mcpwm_cap_timer_handle_t>(1);
+  return ESP_OK;
+}
+
+inline esp_err_t mcpwm_new_capture_channel(mcpwm_cap_timer_handle_t, const mcpwm_capture_channel_config_t*,
+                                           mcpwm_cap_channel_handle_t* out) {
+  *out = reinterpret_cast<mcpwm_cap_channel_handle_t>(1);
+  return ESP_OK;
+}
+
+inline esp_err_t mcpwm_capture_channel_register_event_callbacks(mcpwm_cap_channel_handle_t,
+                                                                const mcpwm_capture_event_callbacks_t* cbs,
+                                                                void* ctx) {
+  shimMcpwmCallback = cbs->on_cap;
+  shimMcpwmContext = ctx;
+  return ESP_OK;
+}
+
+inline esp_err_t mcpwm_capture_channel_enable(mcpwm_cap_channel_handle_t) { return ESP_OK; }
+inline esp_err_t mcpwm_capture_timer_enable(mcpwm_cap_timer_handle_t) { return ESP_OK; }
+
+inline esp_err_t mcpwm_capture_timer_start(mcpwm_cap_timer_handle_t) {
+  if (shim_mcpwmOnStart) shim_mcpwmOnStart();
+  return ESP_OK;
+}
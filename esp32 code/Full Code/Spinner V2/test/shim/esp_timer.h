@@ -0,0 +1,23 @@
+// esp_timer.h (host shim)
+// Periodic timers run their callback on a thread of their own, on the real clock.
+#pragma once
+
+#include <stdint.h>
+
+typedef struct ShimTimer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+
+typedef enum { ESP_TIMER_TASK, ESP_TIMER_ISR } esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void* arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char* name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+int64_t esp_timer_get_time();
+int esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out);
+int esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs);
+int esp_timer_stop(esp_timer_handle_t timer);
@@ -0,0 +1,14 @@
+// freertos/semphr.h (host shim)
+// Mutexes and binary semaphores are both a counting semaphore capped at 1 (no priority
+// inheritance, no owner check).
+#pragma once
+
+#include "queue.h"
+
+typedef struct ShimQueue* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t* woken);
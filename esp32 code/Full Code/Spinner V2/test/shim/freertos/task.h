@@ -0,0 +1,29 @@
+// freertos/task.h (host shim)
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef struct ShimTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Starts a detached thread. Tasks never return, so a test ends with shim_exit().
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t prio, TaskHandle_t* out, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                       UBaseType_t prio, TaskHandle_t* out);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xPortGetCoreID();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+
+#define taskYIELD() shim_yield()
+void shim_yield();
+
+// Leave the process without joining the task threads.
+[[noreturn]] void shim_exit(int code);
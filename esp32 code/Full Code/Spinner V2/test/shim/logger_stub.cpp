@@ -0,0 +1,20 @@
+// logger_stub.cpp
+// Host stand-in for logger.cpp: same API, records are discarded (and counted).
+#include "logger.h"
+
+namespace {
+uint32_t lines = 0;
+}
+
+void logger_begin() {}
+
+LoggerStats logger_stats() {
+  return LoggerStats{ lines, 0 };
+}
+
+uint8_t* log_begin(uint8_t, const char*, const char*, uint8_t, size_t) {
+  ++lines;
+  return nullptr;
+}
+
+void log_commit(uint8_t*) {}
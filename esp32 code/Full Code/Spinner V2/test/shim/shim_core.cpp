@@ -0,0 +1,289 @@
+// shim_core.cpp
+// Host implementations behind Arduino.h, freertos/*.h and esp_timer.h.
+#include <Arduino.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ---- clock ----
+namespace {
+
+using Clock = std::chrono::steady_clock;
+const Clock::time_point epoch = Clock::now();
+std::atomic<bool> manualClock{false};
+std::atomic<uint64_t> manualUs{0};
+std::mt19937 rng(12345);
+
+uint64_t realUs() {
+  return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - epoch).count());
+}
+
+uint64_t nowUs() {
+  return manualClock ? manualUs.load() : realUs();
+}
+
+// sleep (real clock) or jump ahead (manual clock)
+void sleepUs(uint64_t us) {
+  if (manualClock) manualUs += us;
+  else std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// deadline for a timed wait; the manual clock never waits
+Clock::time_point waitUntil(TickType_t ticks) {
+  if (ticks == portMAX_DELAY) return Clock::time_point::max();
+  return Clock::now() + std::chrono::milliseconds(manualClock ? 0 : ticks);
+}
+
+template <typename Pred>
+bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t ticks, Pred pred) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(lock, pred);
+    return true;
+  }
+  return cv.wait_until(lock, waitUntil(ticks), pred);
+}
+
+} // namespace
+
+void shim_clockManual(bool manual) {
+  manualUs = realUs();
+  manualClock = manual;
+}
+
+void shim_advanceUs(uint64_t us) {
+  manualUs += us;
+}
+
+void shim_setUs(uint64_t us) {
+  manualUs = us;
+}
+
+unsigned long millis() { return (unsigned long)(nowUs() / 1000); }
+unsigned long micros() { return (unsigned long)nowUs(); }
+int64_t esp_timer_get_time() { return int64_t(nowUs()); }
+void delay(unsigned long ms) { sleepUs(uint64_t(ms) * 1000); }
+void delayMicroseconds(unsigned us) { sleepUs(us); }
+void yield() { std::this_thread::yield(); }
+uint32_t EspClass::getCycleCount() { return uint32_t(nowUs() * 240); }
+uint32_t getCpuFrequencyMhz() { return 240; }
+
+size_t HardwareSerial::write(uint8_t c) {
+  static const bool on = getenv("SPINNER_SHIM_SERIAL") != nullptr;
+  if (on) fputc(c, stdout);
+  return 1;
+}
+
+long random(long hi) { return hi > 0 ? long(rng() % uint32_t(hi)) : 0; }
+long random(long lo, long hi) { return hi > lo ? lo + random(hi - lo) : lo; }
+void randomSeed(unsigned long seed) { rng.seed(uint32_t(seed)); }
+uint32_t esp_random() { return rng(); }
+int analogRead(uint8_t) { return 0; }
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return 0; }
+void attachInterrupt(uint8_t, void (*)(), int) {}
+
+// ---- critical sections ----
+namespace {
+std::recursive_mutex criticalLock;
+}
+
+void portENTER_CRITICAL(portMUX_TYPE*) { criticalLock.lock(); }
+void portEXIT_CRITICAL(portMUX_TYPE*) { criticalLock.unlock(); }
+
+// ---- tasks ----
+struct ShimTask {
+  const char* name;
+  BaseType_t core;
+  std::mutex lock;
+  std::condition_variable cv;
+  uint32_t notify = 0;
+};
+
+namespace {
+thread_local ShimTask* currentTask = nullptr;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t, void* arg,
+                                   UBaseType_t, TaskHandle_t* out, BaseType_t core) {
+  ShimTask* t = new ShimTask();
+  t->name = name;
+  t->core = core;
+  if (out) *out = t;
+  std::thread([t, fn, arg] {
+    currentTask = t;
+    fn(arg);
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                       UBaseType_t prio, TaskHandle_t* out) {
+  return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t) {
+  // the calling thread just parks: host tasks are never torn down
+  for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+}
+
+void vTaskDelay(TickType_t ticks) { sleepUs(uint64_t(ticks) * 1000); }
+TickType_t xTaskGetTickCount() { return TickType_t(nowUs() / 1000); }
+void shim_yield() { std::this_thread::yield(); }
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 1024; }
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  if (!currentTask) {
+    currentTask = new ShimTask();  // main thread (the Arduino loop task)
+    currentTask->name = "loop";
+    currentTask->core = 1;
+  }
+  return currentTask;
+}
+
+BaseType_t xPortGetCoreID() {
+  TaskHandle_t t = xTaskGetCurrentTaskHandle();
+  return t->core == tskNO_AFFINITY ? 0 : t->core;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t t) {
+  {
+    std::lock_guard<std::mutex> g(t->lock);
+    ++t->notify;
+  }
+  t->cv.notify_all();
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t*) { xTaskNotifyGive(t); }
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  ShimTask* t = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(t->lock);
+  waitFor(t->cv, lock, ticks, [t] { return t->notify > 0; });
+  uint32_t value = t->notify;
+  if (value) t->notify = clearOnExit ? 0 : value - 1;
+  return value;
+}
+
+void shim_exit(int code) {
+  fflush(stdout);
+  fflush(stderr);
+  _Exit(code);
+}
+
+// ---- queues and semaphores ----
+struct ShimQueue {
+  size_t length;
+  size_t itemSize;
+  std::mutex lock;
+  std::condition_variable cv;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  ShimQueue* q = new ShimQueue();
+  q->length = length;
+  q->itemSize = itemSize;
+  return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(q->lock);
+  if (!waitFor(q->cv, lock, ticks, [q] { return q->items.size() < q->length; })) return pdFALSE;
+  const uint8_t* p = static_cast<const uint8_t*>(item);
+  q->items.emplace_back(p, p + q->itemSize);
+  lock.unlock();
+  q->cv.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void* item) {
+  std::unique_lock<std::mutex> lock(q->lock);
+  q->items.clear();
+  const uint8_t* p = static_cast<const uint8_t*>(item);
+  q->items.emplace_back(p, p + q->itemSize);
+  lock.unlock();
+  q->cv.notify_all();
+  return pdTRUE;
+}
+
+static BaseType_t takeItem(QueueHandle_t q, void* item, TickType_t ticks, bool remove) {
+  std::unique_lock<std::mutex> lock(q->lock);
+  if (!waitFor(q->cv, lock, ticks, [q] { return !q->items.empty(); })) return pdFALSE;
+  if (item && q->itemSize) memcpy(item, q->items.front().data(), q->itemSize);
+  if (remove) q->items.pop_front();
+  lock.unlock();
+  q->cv.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks) { return takeItem(q, item, ticks, true); }
+BaseType_t xQueuePeek(QueueHandle_t q, void* item, TickType_t ticks) { return takeItem(q, item, ticks, false); }
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+  std::lock_guard<std::mutex> g(q->lock);
+  q->items.clear();
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  std::lock_guard<std::mutex> g(q->lock);
+  return UBaseType_t(q->items.size());
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return xQueueCreate(1, 0); }
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  SemaphoreHandle_t s = xSemaphoreCreateBinary();
+  xSemaphoreGive(s);
+  return s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) { return xQueueReceive(s, nullptr, ticks); }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) { return xQueueSend(s, nullptr, 0); }
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t*) { return xSemaphoreGive(s); }
+
+// ---- esp_timer ----
+struct ShimTimer {
+  esp_timer_create_args_t args;
+  std::atomic<bool> running{false};
+};
+
+int esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+  ShimTimer* t = new ShimTimer();
+  t->args = *args;
+  *out = t;
+  return ESP_OK;
+}
+
+int esp_timer_start_periodic(esp_timer_handle_t t, uint64_t periodUs) {
+  t->running = true;
+  std::thread([t, periodUs] {
+    Clock::time_point next = Clock::now();
+    while (t->running) {
+      next += std::chrono::microseconds(periodUs);
+      std::this_thread::sleep_until(next);
+      // like skip_unhandled_events: a late timer fires once and rejoins the grid
+      Clock::time_point now = Clock::now();
+      while (next + std::chrono::microseconds(periodUs) <= now) next += std::chrono::microseconds(periodUs);
+      if (t->running) t->args.callback(t->args.arg);
+    }
+  }).detach();
+  return ESP_OK;
+}
+
+int esp_timer_stop(esp_timer_handle_t t) {
+  t->running = false;
+  return ESP_OK;
+}
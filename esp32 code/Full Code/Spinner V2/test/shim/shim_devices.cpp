@@ -0,0 +1,6 @@
+// shim_devices.cpp
+#include <FastLED.h>
+#include <WiFi.h>
+
+CFastLED FastLED;
+WiFiClass WiFi;
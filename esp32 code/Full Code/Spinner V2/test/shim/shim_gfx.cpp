@@ -0,0 +1,154 @@
+// shim_gfx.cpp
+// Text rendering as in Adafruit GFX (Adafruit_GFX.cpp, custom font paths).
+#include <Adafruit_GFX.h>
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < h; ++i) drawPixel(x, y + i, color);
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  for (int16_t i = 0; i < w; ++i) drawPixel(x + i, y, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t i = x; i < x + w; ++i) drawFastVLine(i, y, h, color);
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  int16_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int16_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int16_t err = dx + dy;
+  for (;;) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    int16_t e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+void Adafruit_GFX::setFont(const GFXfont* f) {
+  // the library moves the cursor between the classic (top-left) and custom (baseline) origins
+  if (f && !gfxFont) cursor_y += 6;
+  else if (!f && gfxFont) cursor_y -= 6;
+  gfxFont = f;
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t, uint8_t sx, uint8_t sy) {
+  if (!gfxFont) return;  // classic font: no glyph table in the shim
+  c -= uint8_t(gfxFont->first);
+  const GFXglyph* glyph = gfxFont->glyph + c;
+  const uint8_t* bitmap = gfxFont->bitmap;
+  uint16_t bo = glyph->bitmapOffset;
+  uint8_t w = glyph->width, h = glyph->height;
+  int8_t xo = glyph->xOffset, yo = glyph->yOffset;
+  uint8_t bits = 0, bit = 0;
+  for (uint8_t yy = 0; yy < h; ++yy) {
+    for (uint8_t xx = 0; xx < w; ++xx) {
+      if (!(bit++ & 7)) bits = bitmap[bo++];
+      if (bits & 0x80) {
+        if (sx == 1 && sy == 1) drawPixel(x + xo + xx, y + yo + yy, color);
+        else fillRect(x + (xo + xx) * sx, y + (yo + yy) * sy, sx, sy, color);
+      }
+      bits <<= 1;
+    }
+  }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (!gfxFont) {
+    if (c == '\n') {
+      cursor_x = 0;
+      cursor_y += textsize_y * 8;
+    } else if (c != '\r') {
+      if (wrap && cursor_x + textsize_x * 6 > _width) {
+        cursor_x = 0;
+        cursor_y += textsize_y * 8;
+      }
+      cursor_x += textsize_x * 6;
+    }
+    return 1;
+  }
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += int16_t(textsize_y) * gfxFont->yAdvance;
+  } else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last) {
+    const GFXglyph* glyph = gfxFont->glyph + (c - gfxFont->first);
+    uint8_t w = glyph->width, h = glyph->height;
+    if (w > 0 && h > 0) {
+      int16_t xo = glyph->xOffset;
+      if (wrap && cursor_x + textsize_x * (xo + w) > _width) {
+        cursor_x = 0;
+        cursor_y += int16_t(textsize_y) * gfxFont->yAdvance;
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+    }
+    cursor_x += glyph->xAdvance * int16_t(textsize_x);
+  }
+  return 1;
+}
+
+void Adafruit_GFX::charBounds(unsigned char c, int16_t* x, int16_t* y, int16_t* minx, int16_t* miny,
+                              int16_t* maxx, int16_t* maxy) {
+  if (gfxFont) {
+    if (c == '\n') {
+      *x = 0;
+      *y += textsize_y * gfxFont->yAdvance;
+    } else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last) {
+      const GFXglyph* glyph = gfxFont->glyph + (c - gfxFont->first);
+      uint8_t gw = glyph->width, gh = glyph->height, xa = glyph->xAdvance;
+      int8_t xo = glyph->xOffset, yo = glyph->yOffset;
+      if (wrap && *x + (int16_t(xo) + gw) * textsize_x > _width) {
+        *x = 0;
+        *y += textsize_y * gfxFont->yAdvance;
+      }
+      int16_t x1 = *x + xo * textsize_x, y1 = *y + yo * textsize_y;
+      int16_t x2 = x1 + gw * textsize_x - 1, y2 = y1 + gh * textsize_y - 1;
+      if (x1 < *minx) *minx = x1;
+      if (y1 < *miny) *miny = y1;
+      if (x2 > *maxx) *maxx = x2;
+      if (y2 > *maxy) *maxy = y2;
+      *x += xa * textsize_x;
+    }
+    return;
+  }
+  if (c == '\n') {
+    *x = 0;
+    *y += textsize_y * 8;
+  } else if (c != '\r') {
+    if (wrap && *x + textsize_x * 6 > _width) {
+      *x = 0;
+      *y += textsize_y * 8;
+    }
+    int16_t x2 = *x + textsize_x * 6 - 1, y2 = *y + textsize_y * 8 - 1;
+    if (x2 > *maxx) *maxx = x2;
+    if (y2 > *maxy) *maxy = y2;
+    if (*x < *minx) *minx = *x;
+    if (*y < *miny) *miny = *y;
+    *x += textsize_x * 6;
+  }
+}
+
+void Adafruit_GFX::getTextBounds(const char* s, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+  *x1 = x;
+  *y1 = y;
+  *w = *h = 0;
+  int16_t minx = 0x7FFF, miny = 0x7FFF, maxx = -1, maxy = -1;
+  uint8_t c;
+  while ((c = uint8_t(*s++))) charBounds(c, &x, &y, &minx, &miny, &maxx, &maxy);
+  if (maxx >= minx) {
+    *x1 = minx;
+    *w = uint16_t(maxx - minx + 1);
+  }
+  if (maxy >= miny) {
+    *y1 = miny;
+    *h = uint16_t(maxy - miny + 1);
+  }
+}
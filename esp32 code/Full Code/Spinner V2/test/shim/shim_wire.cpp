@@ -0,0 +1,43 @@
+// shim_wire.cpp
+#include <Wire.h>
+
+TwoWire Wire;
+
+bool TwoWire::begin(int, int, uint32_t freq) {
+  if (freq) clockHz = freq;
+  return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  txAddress = address;
+  tx.clear();
+}
+
+size_t TwoWire::write(uint8_t b) {
+  if (tx.size() >= 128) return 0;  // the ESP32 Wire buffer
+  tx.push_back(b);
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* b, size_t n) {
+  size_t out = 0;
+  while (n-- && write(*b++)) ++out;
+  return out;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  ++transactions;
+  bytes += uint32_t(tx.size()) + 1;
+  if (byteTimeUs) delayMicroseconds(byteTimeUs * (uint32_t(tx.size()) + 1));
+  return device ? device(txAddress, tx) : 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t len) {
+  ++transactions;
+  bytes += uint32_t(len) + 1;
+  rx = reader ? reader(address, len) : std::vector<uint8_t>();
+  if (rx.size() > len) rx.resize(len);
+  rxPos = 0;
+  if (byteTimeUs) delayMicroseconds(byteTimeUs * (uint32_t(rx.size()) + 1));
+  return uint8_t(rx.size());
+}
@@ -0,0 +1,250 @@
+// test_album_nav.cpp
+// module_album's navigation replayed on the host: a wheel trace (slow turns, fast turns,
+// flicks that coast, reversals) goes through the encoder estimator at 1 kHz and the module runs
+// every 16 ms frame, while publishJson() refuses some commands and the broker drops out for a
+// while. However the commands get split up by the debounce and the refusals, the photos they
+// add up to must equal the motion: the steps fling.h produced from the same frames. Also the
+// photo hand-off from the net task: nothing from before a deactivate() is drawn after it.
+#include "check.h"
+
+#include "../main/module_album.cpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+// ---- sketch globals and services module_album.cpp links against ----
+const uint16_t SCREEN_W = 128;
+const uint16_t SCREEN_H = 64;
+const uint16_t NUM_PIXELS = 1;
+CRGB ledBuffer[1];
+CRGB* leds = ledBuffer;
+Adafruit_SSD1306 display(SCREEN_W, SCREEN_H, &Wire, -1);
+AS5600 as5600;
+Uid currentActiveUid = {};
+
+const TagEntry* tagLookup(const UidKey&) { return nullptr; }  // DEFAULT_ALBUM
+bool mqttSubscribe(uint8_t, const char*) { return true; }
+bool mqttUnsubscribe(uint8_t, const char*) { return true; }
+uint32_t mqttSession() { return 1; }
+void displayFlush() {}
+void ledShow() {}
+
+namespace {
+
+std::mt19937 rng(19);
+bool online = true;
+int refusePercent = 0;  // publishJson() refuses this share of commands (queue full)
+
+struct Sent {
+  int32_t relative = 0;  // sum of next/prev steps
+  int commands = 0;
+  int gotos = 0;
+  int32_t lastGoto = -1;
+  int refused = 0;
+};
+Sent sent;
+
+// what the module's own frames add up to
+Fling reference = makeFling(FLING);
+int64_t refCount = 0;
+unsigned long refMs = 0;
+bool refBaseline = false;
+int32_t motion = 0;
+
+double wheelPos = 0;
+
+int payloadInt(const std::string& p, const char* key) {
+  size_t at = p.find(key);
+  return at == std::string::npos ? 0 : atoi(p.c_str() + at + strlen(key));
+}
+
+void frame() {
+  module_album_loop();
+
+  // the same inputs the module just used
+  EncoderState enc = encoder_read();
+  unsigned long now = millis();
+  if (!refBaseline) {
+    refBaseline = true;
+    refCount = enc.count;
+    refMs = now;
+    return;
+  }
+  int delta = int(enc.count - refCount);
+  refCount = enc.count;
+  uint32_t dtMs = now - refMs;
+  refMs = now;
+  if (delta != 0 || fling_isCoasting(reference)) {
+    motion += fling_update(reference, delta, enc.velocity, enc.confidence, dtMs);
+  }
+}
+
+// one millisecond at `velocity` counts/s: a sample, and a frame every 16th
+void tick(double velocity) {
+  static uint32_t ms = 0;
+  wheelPos += velocity / 1000;
+  uint16_t raw = uint16_t(int64_t(llround(wheelPos)) & (ENCODER_COUNTS - 1));
+  encoder_sample(raw, ENCODER_MAGNET_DETECTED, uint64_t(esp_timer_get_time()));
+  delay(1);
+  if (++ms % 16 == 0) frame();
+}
+
+void hold(double velocity, int ms) {
+  for (int i = 0; i < ms; ++i) tick(velocity);
+}
+
+// a flick: up to `peak` in 60 ms, then let go (the wheel spins down in ~150 ms)
+void flick(double peak) {
+  for (int i = 0; i < 60; ++i) tick(peak * i / 60);
+  for (int i = 0; i < 300; ++i) tick(peak * exp(-i / 50.0));
+}
+
+void start() {
+  shim_clockManual(true);
+  sent = Sent();
+  online = true;
+  refusePercent = 0;
+  reference = makeFling(FLING);
+  refBaseline = false;
+  motion = 0;
+  wheelPos = 0;
+  encoder_begin(0, ENCODER_MAGNET_DETECTED, uint64_t(esp_timer_get_time()));
+  module_album_setup();
+  module_album_activate();
+  frame();  // the encoder baseline
+}
+
+void finish() {
+  module_album_deactivate();
+  shim_clockManual(false);
+}
+
+// the server reports the photo it shows, as it would after a GET
+void serverShows(int index, int count) {
+  char topic[64];
+  char payload[96];
+  snprintf(topic, sizeof(topic), "spinner/album/%s/photo", DEFAULT_ALBUM);
+  snprintf(payload, sizeof(payload), "{\"index\":%d,\"photosCount\":%d,\"date\":\"x\",\"age\":\"y\"}",
+           index, count);
+  mqtt_dispatch(topic, (byte*)payload, unsigned(strlen(payload)));
+}
+
+// turns of every kind, with refusals and a two-second outage in the middle
+void replay() {
+  std::uniform_real_distribution<double> slow(300, 2000), fast(3000, 9000), peak(6000, 20000);
+  for (int round = 0; round < 40; ++round) {
+    double dir = (rng() & 1) ? 1 : -1;
+    switch (rng() % 4) {
+      case 0: hold(dir * slow(rng), 200 + int(rng() % 1500)); break;
+      case 1: hold(dir * fast(rng), 100 + int(rng() % 400)); break;
+      case 2: flick(dir * peak(rng)); break;
+      case 3: flick(dir * peak(rng)); hold(-dir * slow(rng), 150); break;  // caught and turned back
+    }
+    hold(0, int(rng() % 400));
+    if (round == 20) online = false;
+    if (round == 24) online = true;
+  }
+  // let the list coast out and every pending step go out
+  refusePercent = 0;
+  hold(0, 3000);
+}
+
+} // namespace
+
+bool mqttIsConnected() { return online; }
+
+bool publishJson(const char*, const char* payload) {
+  if (!online) return false;
+  std::string p(payload);
+  if (p.find("\"get\"") != std::string::npos) return true;
+  if (int(rng() % 100) < refusePercent) {
+    ++sent.refused;
+    return false;
+  }
+  ++sent.commands;
+  if (p.find("\"goto\"") != std::string::npos) {
+    ++sent.gotos;
+    sent.lastGoto = payloadInt(p, "\"index\":");
+  } else if (p.find("\"next\"") != std::string::npos) {
+    sent.relative += payloadInt(p, "\"steps\":");
+  } else if (p.find("\"prev\"") != std::string::npos) {
+    sent.relative -= payloadInt(p, "\"steps\":");
+  }
+  return true;
+}
+
+TEST(slow_turn_publishes_one_photo_per_600_counts) {
+  start();
+  hold(1000, 6000);  // 6000 counts, below the boost velocity
+  hold(0, 1000);
+  CHECK_EQ(sent.relative, 10);
+  CHECK_EQ(motion, 10);
+  CHECK_EQ(pendingSteps, 0);
+  finish();
+}
+
+TEST(relative_steps_add_up_to_the_motion) {
+  start();
+  refusePercent = 30;
+  replay();
+  printf("  relative: %d photos of motion in %d commands, %d refused\n", int(motion), sent.commands,
+         sent.refused);
+  CHECK_NE(motion, 0);
+  CHECK_GT(sent.refused, 0);
+  CHECK_EQ(sent.gotos, 0);  // the server never reported an index
+  CHECK_EQ(sent.relative, motion);
+  CHECK_EQ(pendingSteps, 0);
+  CHECK(!fling_isCoasting(fling));
+  finish();
+}
+
+TEST(goto_lands_on_the_start_index_plus_the_motion) {
+  const int COUNT = 257;
+  const int START = 100;
+  start();
+  hold(0, NAV_SETTLE_MS);  // nothing published for a while: the server's index is adopted
+  serverShows(START, COUNT);
+  hold(0, 100);  // the reply is picked up in the next frame
+  CHECK(haveIndex);
+  CHECK_EQ(targetIndex, START);
+
+  refusePercent = 30;
+  replay();
+  int32_t expected = int32_t(((START + motion) % COUNT + COUNT) % COUNT);
+  printf("  goto: %d photos of motion in %d commands, %d refused\n", int(motion), sent.commands,
+         sent.refused);
+  CHECK_NE(motion, 0);
+  CHECK_EQ(sent.relative, 0);
+  CHECK_EQ(sent.gotos, sent.commands);
+  CHECK_EQ(sent.lastGoto, expected);
+  CHECK_EQ(targetIndex, expected);
+  CHECK_EQ(pendingSteps, 0);
+  finish();
+}
+
+TEST(a_reply_from_before_deactivate_is_not_shown_on_reactivate) {
+  start();
+  serverShows(5, 40);
+  hold(0, 100);
+  CHECK_EQ(totalPhotos, 40);
+  module_album_deactivate();
+  CHECK(!active);
+  serverShows(6, 40);  // after deactivate: dropped by onPhoto()
+  CHECK_EQ(uxQueueMessagesWaiting(photoBox), 0u);
+
+  // one that passed the check just before deactivate() and landed after its reset
+  PhotoUpdate late = {};
+  strcpy(late.albumId, DEFAULT_ALBUM);
+  late.index = 7;
+  late.photosCount = 41;
+  xQueueOverwrite(photoBox, &late);
+
+  module_album_activate();  // the same album again
+  hold(0, 100);
+  CHECK_EQ(totalPhotos, 0);  // nothing until the reply to this activation's GET
+  serverShows(8, 42);
+  hold(0, 100);
+  CHECK_EQ(totalPhotos, 42);
+  finish();
+}
@@ -0,0 +1,153 @@
+// test_encoder_pwm.cpp
+// The PWM encoder source (SPINNER_ENCODER_SOURCE=ENCODER_SOURCE_PWM) on a simulated AS5600 OUT
+// waveform: 128 clocks high + angle, 4095 data clocks, 128 low, captured by an 80 MHz MCPWM
+// timer. encoderPwmDecode() must return every angle exactly whatever the chip's clock does
+// (the frame is measured, not assumed), and encoder_sourceBegin()/Read() must switch the chip
+// to PWM over I2C and hand out one angle per frame, across the capture timer's wraparound.
+// The CONF profiles are checked on the same register model.
+#include "check.h"
+
+#include "encoder.h"
+#include "encoder_source.h"
+
+#include <driver/mcpwm_cap.h>
+#include <Wire.h>
+#include <random>
+
+namespace {
+
+static_assert(SPINNER_ENCODER_SOURCE == ENCODER_SOURCE_PWM, "build this test with the PWM source");
+
+const double PWM_HZ = 920;  // nominal, PWMF = 11
+
+// AS5600 register file on the bus (only what encoder_source.cpp touches)
+struct As5600 {
+  uint8_t regs[256] = {};
+  uint8_t pointer = 0;
+};
+As5600 chip;
+
+void attachChip() {
+  Wire.device = [](uint8_t addr, const std::vector<uint8_t>& t) -> uint8_t {
+    if (addr != 0x36) return 2;
+    if (t.empty()) return 0;
+    chip.pointer = t[0];
+    for (size_t i = 1; i < t.size(); ++i) chip.regs[uint8_t(chip.pointer + i - 1)] = t[i];
+    return 0;
+  };
+  Wire.reader = [](uint8_t addr, uint8_t len) {
+    std::vector<uint8_t> out;
+    if (addr != 0x36) return out;
+    for (uint8_t i = 0; i < len; ++i) out.push_back(chip.regs[uint8_t(chip.pointer + i)]);
+    return out;
+  };
+}
+
+// OUT pin as the capture unit sees it: ticks per PWM clock follow the chip's actual frequency
+struct Waveform {
+  double ticksPerClock;
+  double t;  // capture timer, unwrapped
+  std::mt19937 rng{13};
+  int jitter = 0;  // +- capture ticks per edge
+
+  explicit Waveform(double hz, double start = 0)
+      : ticksPerClock(SHIM_MCPWM_CAPTURE_HZ / (hz * AS5600_PWM_FRAME)), t(start) {}
+
+  uint32_t tick(double at) {
+    int j = jitter ? int(rng() % (2 * jitter + 1)) - jitter : 0;
+    return uint32_t(uint64_t(llround(at) + j));  // the 32-bit capture register wraps
+  }
+
+  // one frame carrying `angle`: rising edge, falling edge after the high part
+  void frame(uint16_t angle) {
+    shim_mcpwmEdge(tick(t), true);
+    shim_mcpwmEdge(tick(t + (AS5600_PWM_LEAD + angle) * ticksPerClock), false);
+    t += AS5600_PWM_FRAME * ticksPerClock;
+  }
+};
+
+} // namespace
+
+TEST(decode_returns_every_angle_at_any_chip_clock) {
+  // the AS5600's oscillator is only trimmed to a few percent; the decode divides by the period
+  const double scales[] = { 0.90, 0.95, 1.0, 1.05, 1.10 };
+  int wrong = 0;
+  for (double s : scales) {
+    double ticksPerClock = SHIM_MCPWM_CAPTURE_HZ / (PWM_HZ * s * AS5600_PWM_FRAME);
+    uint32_t period = uint32_t(llround(AS5600_PWM_FRAME * ticksPerClock));
+    for (uint32_t angle = 0; angle < ENCODER_COUNTS; ++angle) {
+      uint32_t high = uint32_t(llround((AS5600_PWM_LEAD + angle) * ticksPerClock));
+      // and with the edges a capture tick early or late
+      for (int j = -1; j <= 1; ++j) {
+        if (encoderPwmDecode(high + j, period - j) != angle) ++wrong;
+      }
+    }
+  }
+  CHECK_EQ(wrong, 0);
+
+  // no frame yet, or a glitch shorter than the lead: angle 0, never garbage
+  CHECK_EQ(encoderPwmDecode(100, 0), 0);
+  CHECK_EQ(encoderPwmDecode(10, 86960), 0);
+  CHECK_EQ(encoderPwmDecode(86960, 86960), 4095);
+}
+
+TEST(source_switches_the_chip_to_pwm_and_reads_one_angle_per_frame) {
+  attachChip();
+  chip.regs[0x08] = 0x0F;  // CONF low: analog output, 115 Hz, hysteresis/power bits set
+  // start a few frames before the 32-bit capture timer wraps
+  Waveform w(PWM_HZ * 1.03, 4294967296.0 - 5 * 86960);
+  w.jitter = 1;
+  shim_mcpwmOnStart = [&w] {
+    w.frame(1000);
+    w.frame(1001);
+    w.frame(1002);
+  };
+  CHECK(encoder_sourceBegin(4));
+  CHECK_EQ(chip.regs[0x08] & 0x30, 0x20);  // OUTS = PWM
+  CHECK_EQ(chip.regs[0x08] & 0xC0, 0xC0);  // PWMF = 920 Hz
+  CHECK_EQ(chip.regs[0x08] & 0x0F, 0x0F);  // the rest left alone
+
+  uint16_t raw = 0;
+  uint8_t status = 0;
+  CHECK(encoder_sourceRead(raw, status));
+  CHECK_EQ(raw, 1001);  // the last complete frame
+  CHECK_EQ(status, ENCODER_MAGNET_DETECTED);
+  CHECK(!encoder_sourceRead(raw, status));  // nothing new
+
+  // the wheel at 3 rev/s for two seconds: every frame's angle, in order, through the wrap
+  double angle = 1002;
+  uint16_t sent = 1002;
+  int wrong = 0, reads = 0;
+  for (int f = 0; f < 1840; ++f) {
+    angle += 3.0 * ENCODER_COUNTS / (PWM_HZ * 1.03);
+    uint16_t next = uint16_t(int64_t(angle) & (ENCODER_COUNTS - 1));
+    w.frame(next);  // completes the frame carrying `sent`
+    uint16_t expected = sent;
+    sent = next;
+    if (f % 7 == 3) continue;  // the sense task missed a frame: the next read gets the latest
+    if (!encoder_sourceRead(raw, status) || raw != expected) ++wrong;
+    ++reads;
+  }
+  CHECK_EQ(wrong, 0);
+  CHECK_GT(reads, 1500);
+  CHECK_LT(w.t, 4294967296.0 * 2);
+  CHECK_GT(w.t, 4294967296.0);  // the capture timer did wrap
+}
+
+TEST(profiles_own_the_watchdog_and_keep_the_reserved_and_output_bits) {
+  attachChip();
+  chip.regs[0x07] = 0xC0 | 0x20;  // reserved bits 7:6 set, WD left on by someone else
+  chip.regs[0x08] = 0xE0;         // PWM at 920 Hz, as begin() leaves it
+
+  CHECK(encoder_sourceSetProfile(ENCODER_PROFILE_FAST));
+  CHECK_EQ(chip.regs[0x07], 0xC0 | 0x04 | 0x03);  // WD off, FTH 6 LSB, SF 2x; reserved kept
+  CHECK_EQ(chip.regs[0x08], 0xE0);                // no hysteresis, PM NOM; output untouched
+
+  CHECK(encoder_sourceSetProfile(ENCODER_PROFILE_IDLE));
+  CHECK_EQ(chip.regs[0x07], 0xC0 | 0x20);  // WD on, SF 16x
+  CHECK_EQ(chip.regs[0x08], 0xE0 | 0x03);  // LPM3
+
+  CHECK(encoder_sourceSetProfile(ENCODER_PROFILE_LOW_NOISE));
+  CHECK_EQ(chip.regs[0x07], 0xC0 | 0x04);  // WD off again
+  CHECK_EQ(chip.regs[0x08], 0xE0 | 0x08);  // HYST 2 LSB, PM NOM
+}
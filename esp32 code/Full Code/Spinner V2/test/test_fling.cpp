@@ -0,0 +1,129 @@
+// test_fling.cpp
+// fling.h with the album's configuration: slow turns map 1:1, the gain is capped, a flick
+// coasts and decays to a stop, a reverse turn cancels it and an untrusted estimate changes
+// nothing.
+#include "check.h"
+
+#include "fling.h"
+
+namespace {
+
+// module_album.cpp FLING
+const FlingConfig ALBUM = { 600, 2048, 8, 4096, 512, 400, 128 };
+const uint32_t FRAME_MS = 16;
+
+// turn at a constant `velocity` for `frames` frames; returns the steps
+int32_t turn(Fling& f, int32_t velocity, int frames, uint8_t confidence = 255) {
+  int32_t steps = 0;
+  int64_t moved = 0;
+  for (int i = 1; i <= frames; ++i) {
+    // whole counts per frame, without losing the remainder
+    int64_t target = int64_t(velocity) * FRAME_MS * i / 1000;
+    int32_t delta = int32_t(target - moved);
+    moved = target;
+    steps += fling_update(f, delta, velocity, confidence, FRAME_MS);
+  }
+  return steps;
+}
+
+} // namespace
+
+TEST(slow_turns_step_every_600_counts) {
+  Fling f = makeFling(ALBUM);
+  // 1000 counts/s is below boostVelocity: 1:1
+  int32_t steps = 0;
+  for (int i = 0; i < 120; ++i) steps += fling_update(f, 50, 1000, 255, 50);
+  CHECK_EQ(steps, 10);  // 6000 counts
+  CHECK(!fling_isCoasting(f));
+
+  steps = 0;
+  for (int i = 0; i < 120; ++i) steps += fling_update(f, -50, -1000, 255, 50);
+  CHECK_EQ(steps, -10);
+
+  // a single step needs the whole 600 counts
+  fling_reset(f);
+  CHECK_EQ(fling_update(f, 599, 1000, 255, 16), 0);
+  CHECK_EQ(fling_update(f, 1, 1000, 255, 16), 1);
+}
+
+TEST(gain_is_proportional_and_capped_at_8x) {
+  // twice boostVelocity: twice the steps
+  Fling f = makeFling(ALBUM);
+  int32_t steps = turn(f, 4096, 100);
+  int64_t counts = int64_t(4096) * FRAME_MS * 100 / 1000;
+  CHECK_LE(std::abs(steps - int32_t(counts * 2 / 600)), 1);
+
+  // 40000 counts/s would be ~19.5x: capped at 8
+  f = makeFling(ALBUM);
+  steps = turn(f, 40000, 100);
+  counts = int64_t(40000) * FRAME_MS * 100 / 1000;
+  CHECK_LE(std::abs(steps - int32_t(counts * 8 / 600)), 1);
+}
+
+TEST(coasting_decays_and_stops_below_stop_velocity) {
+  Fling f = makeFling(ALBUM);
+  turn(f, 8192, 10);  // a 2 rev/s flick
+  CHECK(fling_isCoasting(f));
+  CHECK_EQ(f.momentum, 8192);
+
+  // let go: the wheel stands still, the estimate says so with full confidence
+  int32_t coasted = 0;
+  int32_t lastMomentum = f.momentum;
+  int frames = 0;
+  while (fling_isCoasting(f) && frames < 500) {
+    coasted += fling_update(f, 0, 0, 255, FRAME_MS);
+    CHECK_LE(f.momentum, lastMomentum);  // only ever decays
+    CHECK(f.momentum == 0 || f.momentum >= ALBUM.stopVelocity);
+    lastMomentum = f.momentum;
+    ++frames;
+  }
+  CHECK(!fling_isCoasting(f));
+  CHECK_GT(coasted, 0);
+  // 8192 -> 512 with a 400 ms time constant: ln(16) * 400 ms ~ 1.1 s
+  CHECK_GE(frames * FRAME_MS, 900u);
+  CHECK_LE(frames * FRAME_MS, 1300u);
+
+  // and nothing more once it stopped
+  CHECK_EQ(fling_update(f, 0, 0, 255, FRAME_MS), 0);
+}
+
+TEST(reverse_turn_cancels_momentum) {
+  Fling f = makeFling(ALBUM);
+  turn(f, 8192, 10);
+  fling_update(f, 0, 0, 255, FRAME_MS);
+  CHECK(fling_isCoasting(f));
+
+  // a slow turn back (above stopVelocity) stops the list at once
+  int32_t steps = fling_update(f, -16, -1000, 255, FRAME_MS);
+  CHECK(!fling_isCoasting(f));
+  CHECK_LE(steps, 0);
+
+  // below stopVelocity it is just noise and the list coasts on
+  turn(f, 8192, 10);
+  fling_update(f, 0, 0, 255, FRAME_MS);
+  fling_update(f, -4, -256, 255, FRAME_MS);
+  CHECK(fling_isCoasting(f));
+}
+
+TEST(low_confidence_neither_starts_nor_cancels_momentum) {
+  // a fast but untrusted estimate: no momentum and no gain
+  Fling f = makeFling(ALBUM);
+  int32_t steps = turn(f, 20000, 50, 64);
+  int64_t counts = int64_t(20000) * FRAME_MS * 50 / 1000;
+  CHECK(!fling_isCoasting(f));
+  CHECK_EQ(steps, int32_t(counts / 600));
+
+  // coasting, then an untrusted reverse reading (the wheel caught hard): momentum survives
+  f = makeFling(ALBUM);
+  turn(f, 8192, 10);
+  fling_update(f, 0, 0, 255, FRAME_MS);
+  int32_t before = f.momentum;
+  fling_update(f, -40, -8000, 64, FRAME_MS);
+  CHECK(fling_isCoasting(f));
+  CHECK_GT(f.momentum, 0);
+  CHECK_LE(f.momentum, before);  // decay only
+
+  // the same reading trusted cancels it
+  fling_update(f, -40, -8000, 255, FRAME_MS);
+  CHECK(f.momentum <= 0);
+}
@@ -0,0 +1,108 @@
+// test_font_metrics.cpp
+// font_metrics against Adafruit GFX itself, for the fonts the modules measure with it: ink
+// bounds equal display.getTextBounds(s, 0, 0, ...) and the advance equals where print() leaves
+// the cursor, for every single character, blanks, characters outside the font and random lines.
+#include "check.h"
+
+#include "font_metrics.h"
+
+#include <Adafruit_SSD1306.h>
+#include <Fonts/FreeSans12pt7b.h>
+#include <Fonts/FreeSans9pt7b.h>
+#include <Fonts/Roboto_Condensed_Medium9pt7b.h>
+#include <Fonts/Roboto_Regular_NEW16pt7b.h>
+#include <random>
+#include <string>
+
+namespace {
+
+Adafruit_SSD1306 screen(128, 64, &Wire, -1);
+
+struct Font {
+  const char* name;
+  const GFXfont* font;
+};
+
+// module_days, module_timeline / module_distance status, module_distance marquee
+const Font FONTS[] = {
+  { "FreeSans12pt7b", &FreeSans12pt7b },
+  { "FreeSans9pt7b", &FreeSans9pt7b },
+  { "Roboto_Condensed_Medium9pt7b", &Roboto_Condensed_Medium9pt7b },
+  { "Roboto_Regular_NEW16pt7b", &Roboto_Regular_NEW16pt7b },
+};
+
+// 0 when both agree, else prints the string and both answers
+int mismatch(const Font& f, const char* s) {
+  screen.setFont(f.font);
+  screen.setTextSize(1);
+  screen.setTextWrap(false);
+  int16_t x1, y1;
+  uint16_t w, h;
+  screen.getTextBounds(s, 0, 0, &x1, &y1, &w, &h);
+  screen.setCursor(0, 0);
+  screen.print(s);
+  int16_t advance = screen.getCursorX();
+
+  TextBounds b = font_textBounds(f.font, s);
+  if (b.x == x1 && b.y == y1 && b.w == w && b.h == h && font_textAdvance(f.font, s) == uint16_t(advance)) {
+    return 0;
+  }
+  printf("  %s \"%s\": gfx (%d,%d %ux%u, adv %d), font_metrics (%d,%d %ux%u, adv %u)\n", f.name, s, x1, y1,
+         w, h, advance, b.x, b.y, b.w, b.h, font_textAdvance(f.font, s));
+  return 1;
+}
+
+} // namespace
+
+TEST(every_character_matches_gfx) {
+  for (const Font& f : FONTS) {
+    int wrong = 0;
+    for (int c = 1; c < 256; ++c) {
+      if (c == '\n') continue;  // a line break in getTextBounds; font_metrics is single line
+      const char s[2] = { char(c), '\0' };
+      wrong += mismatch(f, s);
+      const GFXglyph* g = font_glyph(f.font, char(c));
+      uint16_t w = font_textBounds(f.font, s).w;
+      if (font_charWidth(f.font, char(c)) != w || font_charAdvance(f.font, char(c)) != (g ? g->xAdvance : 0)) {
+        ++wrong;
+      }
+    }
+    CHECK_EQ(wrong, 0);
+  }
+}
+
+TEST(blanks_and_strings_the_modules_draw) {
+  const char* lines[] = {
+    "", " ", "   ", " A ", "TODAY", "2 SLEEPS", "AGO", "12,345 km", "Loading...", "offline",
+    "jgpqy", "\x01\x7F", "caf\xE9", "__", "_ _",
+  };
+  for (const Font& f : FONTS) {
+    int wrong = 0;
+    for (const char* s : lines) wrong += mismatch(f, s);
+    CHECK_EQ(wrong, 0);
+  }
+  // a lone blank has no ink; GFX folds the blanks' empty boxes into a run's width
+  TextBounds blank = font_textBounds(&FreeSans12pt7b, " ");
+  CHECK_EQ(blank.w, 0);
+  CHECK_EQ(blank.h, 0);
+  CHECK_EQ(font_textBounds(&FreeSans12pt7b, "   ").w, 2 * font_charAdvance(&FreeSans12pt7b, ' '));
+}
+
+TEST(random_lines_match_gfx) {
+  std::mt19937 rng(23);
+  for (const Font& f : FONTS) {
+    int wrong = 0;
+    for (int i = 0; i < 5000; ++i) {
+      std::string s;
+      int len = 1 + int(rng() % 24);
+      for (int k = 0; k < len; ++k) {
+        // mostly printable, some control and high characters the font doesn't have
+        char c = rng() % 8 ? char(0x20 + rng() % 0x5F) : char(1 + rng() % 255);
+        if (c == '\n') c = ' ';
+        s += c;
+      }
+      wrong += mismatch(f, s.c_str());
+    }
+    CHECK_EQ(wrong, 0);
+  }
+}
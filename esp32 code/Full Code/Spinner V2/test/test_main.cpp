@@ -0,0 +1,35 @@
+// test_main.cpp
+// Runs the TEST cases linked into the executable. Exits through shim_exit() so task threads
+// left running by a case don't race static destructors.
+#include "check.h"
+
+#include <Arduino.h>
+
+namespace {
+int failures = 0;
+}
+
+std::vector<TestCase>& testCases() {
+  static std::vector<TestCase> cases;
+  return cases;
+}
+
+void checkFailed(const char* file, int line, const std::string& what) {
+  ++failures;
+  printf("  FAILED %s:%d: %s\n", file, line, what.c_str());
+}
+
+int main() {
+  int failedCases = 0;
+  for (const TestCase& t : testCases()) {
+    int before = failures;
+    printf("[ RUN  ] %s\n", t.name);
+    fflush(stdout);
+    t.fn();
+    bool ok = failures == before;
+    if (!ok) ++failedCases;
+    printf("[ %s ] %s\n", ok ? " OK " : "FAIL", t.name);
+  }
+  printf("%d case(s), %d failed\n", int(testCases().size()), failedCases);
+  shim_exit(failedCases ? 1 : 0);
+}
@@ -0,0 +1,135 @@
+// test_marquee.cpp
+// module_distance's pre-rendered strip against drawing the marquee glyph by glyph into the
+// display: every window of the strip must match drawMarquee(display, scrollX, ...) to the
+// pixel, at every scroll offset. Also times both, and the renderer the strip replaced.
+#include "check.h"
+
+#include "../main/module_distance.cpp"
+
+#include <chrono>
+#include <vector>
+
+// ---- sketch globals (main.ino / tasks.cpp) ----
+const uint16_t SCREEN_W = 128;
+const uint16_t SCREEN_H = 64;
+const uint16_t NUM_PIXELS = 1;
+CRGB ledBuffer[1];
+CRGB* leds = ledBuffer;
+Adafruit_SSD1306 display(SCREEN_W, SCREEN_H, &Wire, -1);
+
+bool publishJson(const char*, const char*) { return true; }
+bool mqttIsConnected() { return false; }
+void displayFlush() {}
+void ledShow() {}
+
+namespace {
+
+// the renderer before the strip: glyph by glyph with getTextBounds() for widths and symbol
+// placement, culled by layout slot
+void drawMarqueeOld(int scrollX) {
+  display.setFont(MARQUEE_FONT);
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  int totalChars = (int)baseMarquee.length();
+  int px = 0;
+  for (int i = 0; i < totalChars; ++i) {
+    char buf[2] = {baseMarquee.charAt(i), 0};
+    int16_t rx, ry;
+    uint16_t rw, rh;
+    display.getTextBounds(buf, 0, 0, &rx, &ry, &rw, &rh);
+    int w = (int)rw + MARQUEE_LETTER_SPACING;
+    int drawX = px - scrollX;
+    if (!(drawX + w <= 0 || drawX >= SCREEN_W)) {
+      display.setCursor(drawX, charY);
+      display.print(buf);
+    }
+    px += w;
+  }
+  for (int s = 0; s < symbolPlacementCount; ++s) {
+    int ord = symbolPlacements[s].underscoreOrdinal;
+    int leftPx = underscorePixelPos[ord];
+    int rightPx = (ord + 1 < underscoreCount) ? underscorePixelPos[ord + 1] : (leftPx + charW);
+    int mid = (leftPx + rightPx) / 2;
+    char bufSym[2] = {symbolPlacements[s].sym, 0};
+    int16_t bx, by;
+    uint16_t bw, bh;
+    display.getTextBounds(bufSym, 0, 0, &bx, &by, &bw, &bh);
+    int drawX = mid - ((int)bw / 2) - scrollX;
+    if (!(drawX + (int)bw <= 0 || drawX >= SCREEN_W)) {
+      display.setCursor(drawX, charY);
+      display.print(bufSym);
+    }
+  }
+}
+
+std::vector<uint8_t> frame() {
+  const uint8_t* fb = display.getBuffer();
+  return std::vector<uint8_t>(fb, fb + display.bufferBytes());
+}
+
+void activate() {
+  randomSeed(7);
+  display.setTextWrap(false);
+  module_distance_setup();
+  module_distance_activate();
+}
+
+template <typename F>
+double usPerFrame(int maxScroll, F render) {
+  auto t0 = std::chrono::steady_clock::now();
+  int frames = 0;
+  for (int x = 0; x < maxScroll; x += 7, ++frames) {
+    display.clearDisplay();
+    render(x);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(t1 - t0).count() / frames;
+}
+
+} // namespace
+
+TEST(strip_matches_glyph_drawing_at_every_offset) {
+  activate();
+  CHECK(strip != nullptr);
+  if (!strip) return;
+
+  int maxScroll = stripW - SCREEN_W;
+  int mismatches = 0;
+  int firstBad = -1;
+  int inked = 0;
+  for (int x = 0; x <= maxScroll; ++x) {
+    display.clearDisplay();
+    blitStrip(x);
+    std::vector<uint8_t> fromStrip = frame();
+    display.clearDisplay();
+    drawMarquee(display, x, SCREEN_W);
+    if (fromStrip != frame()) {
+      if (firstBad < 0) firstBad = x;
+      ++mismatches;
+    }
+    for (uint8_t b : fromStrip) {
+      if (b) { ++inked; break; }
+    }
+  }
+  CHECK_EQ(mismatches, 0);
+  CHECK_EQ(firstBad, -1);
+  CHECK_GT(inked, maxScroll / 2);  // the comparison wasn't between two blank screens
+  module_distance_deactivate();
+}
+
+TEST(benchmark_strip_against_glyph_rendering) {
+  activate();
+  if (!strip) return;
+  int maxScroll = stripW - SCREEN_W;
+
+  double oldUs = usPerFrame(maxScroll, [](int x) { drawMarqueeOld(x); });
+  double glyphUs = usPerFrame(maxScroll, [](int x) { drawMarquee(display, x, SCREEN_W); });
+  double stripUs = usPerFrame(maxScroll, [](int x) { blitStrip(x); });
+  printf("  marquee per frame (host): old %.1f us, glyph %.1f us, strip %.2f us (%d px route)\n",
+         oldUs, glyphUs, stripUs, stripW);
+
+  // the strip is three memcpy()s; the glyph paths walk the whole route every frame
+  CHECK_LT(stripUs * 10, oldUs);
+  CHECK_LT(stripUs * 10, glyphUs);
+  module_distance_deactivate();
+}
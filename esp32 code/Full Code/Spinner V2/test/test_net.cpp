@@ -0,0 +1,228 @@
+// test_net.cpp
+// net.cpp's connection manager against the WiFi/PubSubClient shims, one net_tick() per
+// millisecond: nothing blocks while the network is down, failed broker connects back off
+// exponentially with +/-25% jitter up to the cap, a topic the broker refuses is retried with
+// doubling gaps and given up on after SUB_MAX_FAILURES without holding the connection offline,
+// every reconnect restores the subscriptions by itself, and a WiFi drop never leaves a stale
+// broker socket for the next connect() to reuse.
+#include "check.h"
+
+#include "../main/net.cpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// ---- sketch globals net.cpp links against (main.ino) ----
+WiFiClient wifiClient;
+PubSubClient mqttClient(wifiClient);
+
+namespace {
+
+const uint8_t OWNER_A = 3;
+const uint8_t OWNER_B = 7;
+
+// millis() at every broker connect attempt
+std::vector<unsigned long> connectTimes;
+
+void run(unsigned long ms) {
+  for (unsigned long i = 0; i < ms; ++i) {
+    delay(1);
+    uint32_t before = mqttClient.connects;
+    net_tick(millis());
+    if (mqttClient.connects != before) connectTimes.push_back(millis());
+  }
+}
+
+int subscribeCount(const char* topic) {
+  return int(std::count(mqttClient.subscribeCalls.begin(), mqttClient.subscribeCalls.end(), topic));
+}
+
+// a fresh manager and broker, WiFi and broker reachable unless the test says otherwise
+void start() {
+  shim_clockManual(true);
+  mqttClient = PubSubClient(wifiClient);
+  WiFi.linkUp = true;
+  WiFi.begins = 0;
+  for (Subscription& sub : subs) sub = Subscription();
+  stats = NetStats();
+  failures = 0;
+  session = 0;
+  connectTimes.clear();
+  net_begin("ssid", "pwd", "broker", 1883);
+}
+
+void finish() {
+  shim_clockManual(false);
+}
+
+} // namespace
+
+TEST(waits_for_wifi_without_blocking_and_retries_begin) {
+  start();
+  WiFi.linkUp = false;
+  CHECK_EQ(WiFi.begins, 1u);
+  run(WIFI_CONNECT_TIMEOUT_MS - 10);
+  CHECK_EQ(int(net_state()), int(NET_WIFI_CONNECTING));
+  CHECK(!net_online());
+
+  // timed out: back off, then WiFi.begin() again
+  run(20);
+  CHECK_EQ(int(net_state()), int(NET_BACKOFF));
+  run(BACKOFF_BASE_MS * 5 / 4 + 2);
+  CHECK_EQ(WiFi.begins, 2u);
+  CHECK_EQ(int(net_state()), int(NET_WIFI_CONNECTING));
+
+  WiFi.linkUp = true;
+  run(3);
+  CHECK(net_online());
+  CHECK_EQ(net_session(), 1u);
+  CHECK_EQ(mqttClient.connects, 1u);
+  finish();
+}
+
+TEST(broker_connects_back_off_exponentially_with_jitter) {
+  start();
+  mqttClient.acceptConnect = false;
+  run(5 * 60 * 1000);
+  CHECK(!net_online());
+  CHECK_GT(connectTimes.size(), size_t(12));
+
+  // the gap after the n-th failure: 500 << n, capped, within +/-25%; one tick to act on it
+  int outside = 0;
+  for (size_t n = 1; n < connectTimes.size(); ++n) {
+    unsigned long nominal = std::min(BACKOFF_BASE_MS << std::min<size_t>(n - 1, 6), BACKOFF_MAX_MS);
+    unsigned long gap = connectTimes[n] - connectTimes[n - 1];
+    if (gap < nominal * 3 / 4 || gap > nominal * 5 / 4 + 2) ++outside;
+  }
+  CHECK_EQ(outside, 0);
+  CHECK_EQ(net_stats().mqttFailures, uint32_t(connectTimes.size()));
+
+  // the broker comes back: connected on the next attempt, and the backoff starts over
+  mqttClient.acceptConnect = true;
+  run(BACKOFF_MAX_MS * 5 / 4 + 2);
+  CHECK(net_online());
+  CHECK_EQ(failures, 0);
+  finish();
+}
+
+TEST(a_refused_topic_is_retried_then_given_up_while_online) {
+  start();
+  mqttClient.refuse.push_back("spinner/bad");
+  run(3);
+  CHECK(net_online());
+  CHECK(net_addSubscription("spinner/good", OWNER_A));
+  CHECK(net_addSubscription("spinner/bad", OWNER_A));
+  CHECK(net_online());  // the refusal doesn't take the connection down
+  CHECK(!net_subscribed());
+  CHECK(mqttClient.publish("spinner/out", "{}"));  // and publishing still works
+
+  // retries at 500, 1000, 2000, 4000 ms, then nothing for the rest of the session
+  run(20000);
+  CHECK_EQ(subscribeCount("spinner/good"), 1);
+  CHECK_EQ(subscribeCount("spinner/bad"), int(SUB_MAX_FAILURES));
+  CHECK_EQ(net_stats().subscribeFailures, uint32_t(SUB_MAX_FAILURES));
+  CHECK_EQ(net_stats().subscribeGiveUps, 1u);
+  CHECK(net_online());
+  CHECK(!net_subscribed());
+
+  // another module asking for it gets a fresh set of retries; this time the broker takes it
+  mqttClient.refuse.clear();
+  CHECK(net_addSubscription("spinner/bad", OWNER_B));
+  CHECK_EQ(subscribeCount("spinner/bad"), int(SUB_MAX_FAILURES) + 1);
+  CHECK(net_subscribed());
+  finish();
+}
+
+TEST(subscribe_retry_gaps_double) {
+  start();
+  mqttClient.refuse.push_back("spinner/bad");
+  run(3);
+  net_addSubscription("spinner/bad", OWNER_A);
+  std::vector<unsigned long> at = { millis() };
+  size_t seen = mqttClient.subscribeCalls.size();
+  for (int ms = 0; ms < 20000; ++ms) {
+    run(1);
+    if (mqttClient.subscribeCalls.size() != seen) {
+      seen = mqttClient.subscribeCalls.size();
+      at.push_back(millis());
+    }
+  }
+  CHECK_EQ(at.size(), size_t(SUB_MAX_FAILURES));
+  for (size_t n = 1; n < at.size(); ++n) {
+    unsigned long nominal = SUB_RETRY_BASE_MS << (n - 1);
+    CHECK_GE(at[n] - at[n - 1], nominal);
+    CHECK_LE(at[n] - at[n - 1], nominal + 1);
+  }
+  finish();
+}
+
+TEST(reconnects_restore_subscriptions_without_the_modules) {
+  start();
+  run(3);
+  net_addSubscription("spinner/shared", OWNER_A);
+  net_addSubscription("spinner/shared", OWNER_B);  // one broker subscription for both
+  net_addSubscription("spinner/only-a", OWNER_A);
+  net_addSubscription("spinner/gone", OWNER_B);
+  net_removeSubscription("spinner/gone", OWNER_B);
+  CHECK_EQ(subscribeCount("spinner/shared"), 1);
+  CHECK_EQ(mqttClient.unsubscribed.size(), size_t(1));
+  CHECK(net_subscribed());
+
+  // the broker drops the connection: back off, reconnect, resubscribe what is still wanted
+  mqttClient.isConnected = false;
+  run(1);
+  CHECK(!net_online());
+  CHECK(!net_subscribed());
+  run(BACKOFF_BASE_MS * 5 / 4 + 2);
+  CHECK(net_online());
+  CHECK_EQ(net_session(), 2u);
+  CHECK(net_subscribed());
+  CHECK_EQ(subscribeCount("spinner/shared"), 2);
+  CHECK_EQ(subscribeCount("spinner/only-a"), 2);
+  CHECK_EQ(subscribeCount("spinner/gone"), 1);
+
+  // WiFi goes: counted as a drop, and the topics come back with the link
+  WiFi.linkUp = false;
+  run(1);
+  CHECK_EQ(int(net_state()), int(NET_WIFI_CONNECTING));
+  CHECK_EQ(net_stats().wifiDrops, 1u);
+  WiFi.linkUp = true;
+  run(3);
+  CHECK(net_subscribed());
+  CHECK_EQ(net_session(), 3u);
+  CHECK_EQ(subscribeCount("spinner/shared"), 3);
+
+  // the last owner of a shared topic releasing it is what unsubscribes it
+  net_releaseOwner(OWNER_A);
+  CHECK_EQ(mqttClient.unsubscribed.size(), size_t(2));
+  CHECK(mqttClient.unsubscribed.back() == "spinner/only-a");
+  net_releaseOwner(OWNER_B);
+  CHECK_EQ(mqttClient.unsubscribed.size(), size_t(3));
+  CHECK(mqttClient.unsubscribed.back() == "spinner/shared");
+  finish();
+}
+
+TEST(a_wifi_drop_closes_the_stale_broker_socket) {
+  start();
+  run(3);
+  net_addSubscription("spinner/topic", OWNER_A);
+  CHECK(net_online());
+  CHECK_EQ(mqttClient.connects, 1u);
+
+  // the link goes without the TCP connection noticing: the client still reports connected
+  WiFi.linkUp = false;
+  run(1);
+  CHECK(!net_online());
+  CHECK(!mqttClient.connected());
+  WiFi.linkUp = true;
+  run(3);
+
+  // a real CONNECT went out for the new session, and the topic was restored on it
+  CHECK(net_online());
+  CHECK_EQ(mqttClient.connects, 2u);
+  CHECK_EQ(net_stats().mqttConnects, 2u);
+  CHECK_EQ(net_session(), 2u);
+  CHECK_EQ(subscribeCount("spinner/topic"), 2);
+  finish();
+}
@@ -0,0 +1,224 @@
+// test_oled.cpp
+// oled_flush() against a model of the SSD1306's GDDRAM fed from the Wire transactions
+// (page/column address windows, horizontal addressing, data): after every flush the panel
+// must hold exactly the framebuffer, while only the changed spans go over the bus.
+#include "check.h"
+
+#include "oled.h"
+#include "tasks.h"
+
+#include <vector>
+
+// oled.cpp takes the bus lock per page; there is no other bus user here
+bool i2cLock(TickType_t) { return true; }
+void i2cUnlock() {}
+
+namespace {
+
+const uint8_t ADDR = 0x3D;
+const int W = 128;
+const int PAGES = 8;
+
+// GDDRAM model, as the panel sees the transfers
+struct Panel {
+  uint8_t ram[W * PAGES];
+  int p0 = 0, p1 = PAGES - 1, c0 = 0, c1 = W - 1, page = 0, col = 0;
+  uint32_t scrolls = 0;
+  uint32_t failData = 0;  // NACK the n-th data transfer from now (0 = never)
+
+  uint8_t transfer(uint8_t addr, const std::vector<uint8_t>& t) {
+    if (addr != ADDR || t.empty()) return 2;
+    if (t[0] == 0x40) {
+      if (failData && --failData == 0) return 3;
+      for (size_t i = 1; i < t.size(); ++i) {
+        ram[page * W + col] = t[i];
+        if (++col > c1) {
+          col = c0;
+          if (++page > p1) page = p0;
+        }
+      }
+      return 0;
+    }
+    if (t[0] != 0x00) return 4;
+    if (t.size() >= 9 && (t[1] == 0x2C || t[1] == 0x2D)) {
+      // one-column content scroll of pages t[3]..t[5], columns t[7]..t[8]
+      // (SPINNER_OLED_SCROLL_RIGHT_RAISES_COLUMN: 2Ch moves RAM towards higher columns)
+      bool up = t[1] == 0x2C;
+      for (int p = t[3]; p <= t[5]; ++p) {
+        uint8_t* r = ram + p * W + t[7];
+        int n = t[8] - t[7] + 1;
+        if (up) memmove(r + 1, r, size_t(n - 1));
+        else memmove(r, r + 1, size_t(n - 1));
+      }
+      ++scrolls;
+      return 0;
+    }
+    for (size_t i = 1; i < t.size();) {
+      if (t[i] == SSD1306_PAGEADDR && i + 2 < t.size()) {
+        p0 = page = t[i + 1];
+        p1 = t[i + 2];
+        i += 3;
+      } else if (t[i] == SSD1306_COLUMNADDR && i + 2 < t.size()) {
+        c0 = col = t[i + 1];
+        c1 = t[i + 2];
+        i += 3;
+      } else {
+        return 5;  // a command the flush shouldn't send
+      }
+    }
+    return 0;
+  }
+};
+
+Panel panel;
+Adafruit_SSD1306 display(W, PAGES * 8, &Wire, -1);
+uint32_t rngState = 1;
+
+uint32_t rnd() {
+  rngState = rngState * 1664525u + 1013904223u;
+  return rngState >> 8;
+}
+
+uint8_t* fb() {
+  return display.getBuffer();
+}
+
+bool panelMatches() {
+  return memcmp(panel.ram, fb(), sizeof(panel.ram)) == 0;
+}
+
+void setUp() {
+  static bool begun = false;
+  if (!begun) {
+    Wire.device = [](uint8_t a, const std::vector<uint8_t>& t) { return panel.transfer(a, t); };
+    oled_begin(display, Wire, ADDR);
+    begun = true;
+  }
+  // the panel powers up with garbage; the first flush after an invalidate is a full one
+  for (auto& b : panel.ram) b = uint8_t(rnd());
+  panel.failData = 0;
+  oled_invalidate();
+}
+
+} // namespace
+
+TEST(first_flush_is_full_then_nothing_unchanged_is_sent) {
+  setUp();
+  for (size_t i = 0; i < display.bufferBytes(); ++i) fb()[i] = uint8_t(rnd());
+  CHECK_EQ(oled_flush(fb()), W * PAGES);
+  CHECK(panelMatches());
+
+  uint32_t before = Wire.transactions;
+  CHECK_EQ(oled_flush(fb()), 0);
+  CHECK_EQ(Wire.transactions, before);
+}
+
+TEST(only_the_changed_span_of_a_page_is_sent) {
+  setUp();
+  memset(fb(), 0, display.bufferBytes());
+  oled_flush(fb());
+
+  fb()[3 * W + 40] = 0xFF;
+  fb()[3 * W + 50] = 0x0F;
+  fb()[6 * W + 127] = 0x80;
+  CHECK_EQ(oled_flush(fb()), 11 + 1);
+  CHECK(panelMatches());
+}
+
+TEST(panel_follows_random_edits) {
+  setUp();
+  for (size_t i = 0; i < display.bufferBytes(); ++i) fb()[i] = uint8_t(rnd());
+  oled_flush(fb());
+  OledStats before = oled_stats();
+  bool ok = true;
+  for (int frame = 0; frame < 2000 && ok; ++frame) {
+    int edits = int(rnd() % 6);
+    for (int j = 0; j < edits; ++j) fb()[rnd() % display.bufferBytes()] ^= uint8_t(1 << (rnd() % 8));
+    if (frame % 500 == 250) oled_invalidate();  // someone else wrote the panel
+    oled_flush(fb());
+    ok = panelMatches();
+  }
+  CHECK(ok);
+  OledStats after = oled_stats();
+  // a few glyph-sized edits per frame: a small fraction of full flushes
+  CHECK_LT((after.bytes - before.bytes) * 10, after.fullBytes - before.fullBytes);
+}
+
+TEST(failed_transfer_forces_a_full_flush) {
+  setUp();
+  memset(fb(), 0, display.bufferBytes());
+  oled_flush(fb());
+
+  memset(fb() + 2 * W, 0x3C, W * 3);
+  panel.failData = 2;  // the second page's data is lost
+  oled_flush(fb());
+  CHECK(!panelMatches());
+
+  // nothing changed since, but the panel state is unknown: everything goes out again
+  CHECK_EQ(oled_flush(fb()), W * PAGES);
+  CHECK(panelMatches());
+}
+
+#if SPINNER_OLED_CONTENT_SCROLL
+
+// A marquee in pages 1..3 (blank pages around it) and a status byte that changes every frame:
+// one-column moves go through the controller's content scroll, larger jumps through the diff.
+TEST(marquee_scrolls_in_the_controller_and_stays_in_sync) {
+  setUp();
+  shim_clockManual(true);  // the 25 ms settle after each scroll step costs no real time
+  static uint8_t strip[3][700];
+  for (auto& row : strip) {
+    for (auto& b : row) b = uint8_t(rnd());
+  }
+  memset(fb(), 0, display.bufferBytes());
+  oled_flush(fb());
+
+  OledStats before = oled_stats();
+  uint32_t scrollsBefore = panel.scrolls;
+  uint32_t onePixelBytes = 0;
+  int onePixelFrames = 0;
+  int x = 0;
+  bool ok = true;
+  for (int frame = 0; frame < 600 && ok; ++frame) {
+    int dx = frame < 300 ? 1 : frame < 400 ? -1 : int(rnd() % 5) - 2;
+    x = std::max(0, std::min(x + dx, 700 - W));
+    for (int p = 0; p < 3; ++p) memcpy(fb() + (p + 1) * W, strip[p] + x, W);
+    fb()[6 * W + frame % W] = uint8_t(frame | 1);
+
+    uint16_t sent = oled_flush(fb());
+    if (frame < 400 && frame > 0) {
+      onePixelBytes += sent;
+      ++onePixelFrames;
+    }
+    ok = panelMatches();
+  }
+  shim_clockManual(false);
+  CHECK(ok);
+
+  OledStats after = oled_stats();
+  CHECK_GE(after.scrolls - before.scrolls, 399u);
+  CHECK_EQ(after.scrolls - before.scrolls, panel.scrolls - scrollsBefore);
+  // a one-pixel step sends the exposed column of each marquee page plus the status byte
+  CHECK_LE(onePixelBytes / onePixelFrames, 4u);
+}
+
+TEST(failed_scroll_falls_back_to_a_full_flush) {
+  setUp();
+  shim_clockManual(true);
+  for (int c = 0; c < W; ++c) fb()[2 * W + c] = uint8_t(c * 7 + 1);
+  oled_flush(fb());
+  memmove(fb() + 2 * W, fb() + 2 * W + 1, W - 1);
+  fb()[2 * W + W - 1] = 0x99;
+
+  // the scroll command is NACKed: the panel state is unknown, so the same flush sends it all
+  Wire.device = [](uint8_t a, const std::vector<uint8_t>& t) -> uint8_t {
+    if (t.size() >= 2 && t[0] == 0x00 && (t[1] == 0x2C || t[1] == 0x2D)) return 3;
+    return panel.transfer(a, t);
+  };
+  CHECK_EQ(oled_flush(fb()), W * PAGES);
+  CHECK(panelMatches());
+  Wire.device = [](uint8_t a, const std::vector<uint8_t>& t) { return panel.transfer(a, t); };
+  shim_clockManual(false);
+}
+
+#endif
@@ -0,0 +1,71 @@
+// test_scheduler.cpp
+// schedAdvance()/schedReleased() on synthetic timestamps: the grid doesn't drift with body
+// time, an overrun runs once and skips the missed periods with the phase kept, and the
+// bookkeeping (ticks, overruns, worst busy/late) adds up. Then sched_wait() on the host clock.
+#include "check.h"
+
+#include "scheduler.h"
+
+TEST(grid_does_not_drift_with_body_time) {
+  SchedRate r = schedRateHz("t", 100);  // 10 ms
+  uint64_t now = 1000000;
+  uint32_t sleep = schedAdvance(r, now);  // first tick starts the grid
+  CHECK_EQ(sleep, 10000u);
+  for (int i = 0; i < 50; ++i) {
+    now += sleep;
+    schedReleased(r, now);
+    // bodies of 1..7 ms: the next release stays on the 10 ms grid
+    now += 1000 + uint64_t(i % 7) * 1000;
+    sleep = schedAdvance(r, now);
+    CHECK_EQ((now + sleep - 1000000) % 10000, 0u);
+  }
+  CHECK_EQ(r.ticks, 51u);
+  CHECK_EQ(r.overruns, 0u);
+  CHECK_EQ(r.worstBusyUs, 7000u);
+}
+
+TEST(overrun_runs_at_once_and_skips_missed_periods) {
+  SchedRate r = schedRateHz("t", 1000);  // 1 ms
+  uint64_t now = 5000;
+  uint32_t sleep = schedAdvance(r, now);
+  now += sleep;  // 6000
+  schedReleased(r, now);
+
+  // a 3.5 ms body: the release at 7000 is missed, 8000 and 9000 are skipped
+  now += 3500;  // 9500
+  CHECK_EQ(schedAdvance(r, now), 0u);
+  CHECK_EQ(r.overruns, 1u);
+  CHECK_EQ(r.skipped, 2u);
+  CHECK_EQ(r.deadlineUs, 9000u);  // the late release, still on the grid
+  schedReleased(r, now);
+  CHECK_EQ(r.worstLateUs, 500u);
+
+  // back on the grid: next release at 10000
+  now += 100;
+  CHECK_EQ(schedAdvance(r, now), 10000u - now);
+  CHECK_EQ(r.overruns, 1u);
+}
+
+TEST(overrun_exactly_on_the_next_deadline) {
+  SchedRate r = schedRateHz("t", 1000);
+  schedAdvance(r, 0);
+  schedReleased(r, 1000);
+  CHECK_EQ(schedAdvance(r, 2000), 0u);
+  CHECK_EQ(r.overruns, 1u);
+  CHECK_EQ(r.skipped, 0u);
+}
+
+TEST(sched_wait_keeps_the_rate_on_the_host_clock) {
+  SchedRate r = schedRateHz("host", 200);  // 5 ms, tick delays
+  int64_t t0 = esp_timer_get_time();
+  sched_wait(r);  // starts the grid
+  for (int i = 0; i < 40; ++i) {
+    delayMicroseconds(1500);  // the body
+    sched_wait(r);
+  }
+  int64_t elapsed = esp_timer_get_time() - t0;
+  // 41 ticks, 40 periods; releases jitter by a tick but the grid doesn't drift
+  CHECK_GE(elapsed, 195000);
+  CHECK_LE(elapsed, 230000);
+  CHECK_EQ(r.ticks, 41u);
+}
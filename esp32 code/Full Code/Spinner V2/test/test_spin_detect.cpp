@@ -0,0 +1,324 @@
+// test_spin_detect.cpp
+// module_date's spin detection on synthetic wheel traces, run through the real encoder
+// estimator at the 1 kHz sense rate and read at the 60 Hz render rate, against the rule it
+// replaced (>= 120 counts between two loop passes).
+//
+// Traces (deterministic, seeded):
+//   browse   month steps of 1-3 slices, minimum-jerk moves, a month per 120-400 ms
+//   tremor   a hand resting on the wheel: 6-10 Hz, 5-20 counts
+//   glitch   wheel at rest, a single bad reading (100-800 counts off) about once a second
+//   knock    wheel bumped (tag put down, device handled): 12-25 Hz ringing, 30-120 counts
+//   flick    ramp to the peak speed in 50-90 ms, then coasting (300-600 ms time constant)
+// Every trace carries +-1 count of sensor noise.
+//
+// The old rule ran once per loop pass. With a tag halted on the reader every pass waited for
+// the RC522's 25 ms REQA timeout, so passes were ~27 ms apart; 5 and 16.7 ms are shown too.
+#include "check.h"
+
+#include "../main/module_date.cpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// ---- sketch globals and services module_date.cpp links against ----
+const uint16_t SCREEN_W = 128;
+const uint16_t SCREEN_H = 64;
+const uint16_t NUM_PIXELS = 1;
+CRGB ledBuffer[1];
+CRGB* leds = ledBuffer;
+Adafruit_SSD1306 display(SCREEN_W, SCREEN_H, &Wire, -1);
+
+bool publishJson(const char*, const char*) { return true; }
+void displayFlush() {}
+void ledShow() {}
+ModuleCalibration calib_load(ModuleId, const ModuleCalibration& defaults) { return defaults; }
+bool calib_get(ModuleId, ModuleCalibration&) { return false; }
+void calib_set(ModuleId, const ModuleCalibration&) {}
+
+namespace {
+
+const double SLICE = 4096.0 / 12;
+const uint32_t COOLDOWN_MS = FUTURE_STEP_COOLDOWN_MS;  // detections closer than this are one
+const double RENDER_FRAME_MS = 1000.0 / 60;
+
+struct Trace {
+  std::vector<double> pos;   // sensor reading per ms (counts, unwrapped)
+  std::vector<int> onsets;   // flick starts (ms); empty for traces that must not trigger
+};
+
+// what the render loop sees each frame, and the count at every sample (for the old rule)
+struct Run {
+  std::vector<uint32_t> frameMs;
+  std::vector<EncoderState> frames;
+  std::vector<int64_t> counts;
+};
+
+std::mt19937 rng(2024);
+
+double uniform(double lo, double hi) {
+  return std::uniform_real_distribution<double>(lo, hi)(rng);
+}
+
+void still(Trace& t, int ms) {
+  double p = t.pos.empty() ? 0 : t.pos.back();
+  for (int i = 0; i < ms; ++i) t.pos.push_back(p);
+}
+
+// minimum-jerk move by `dist` counts in `ms`
+void move(Trace& t, double dist, int ms) {
+  double p0 = t.pos.empty() ? 0 : t.pos.back();
+  for (int i = 1; i <= ms; ++i) {
+    double s = double(i) / ms;
+    t.pos.push_back(p0 + dist * (10 * s * s * s - 15 * s * s * s * s + 6 * s * s * s * s * s));
+  }
+}
+
+Trace browse(int seconds) {
+  Trace t;
+  still(t, 300);
+  while (int(t.pos.size()) < seconds * 1000) {
+    int k = std::uniform_int_distribution<int>(1, 3)(rng);
+    double ms = k == 1 ? uniform(120, 400) : k == 2 ? uniform(220, 600) : uniform(300, 800);
+    move(t, (rng() & 1 ? 1 : -1) * k * SLICE, int(ms));
+    still(t, int(uniform(200, 800)));
+  }
+  return t;
+}
+
+Trace tremor(int seconds) {
+  Trace t;
+  double a = 0, f = 0, drift = 0, phase = 0, base = 0;
+  for (int i = 0; i < seconds * 1000; ++i) {
+    if (i % 2000 == 0) { a = uniform(5, 20); f = uniform(6, 10); drift = uniform(-20, 20); }
+    phase += 2 * M_PI * f / 1000;
+    base += drift / 1000;
+    t.pos.push_back(base + a * sin(phase));
+  }
+  return t;
+}
+
+Trace glitch(int seconds) {
+  Trace t;
+  still(t, seconds * 1000);
+  for (size_t i = 500; i < t.pos.size(); i += size_t(uniform(500, 1500))) {
+    t.pos[i] += (rng() & 1 ? 1 : -1) * uniform(100, 800);
+  }
+  return t;
+}
+
+Trace knock(int seconds) {
+  Trace t;
+  still(t, seconds * 1000);
+  for (size_t i = 300; i + 300 < t.pos.size(); i += size_t(uniform(1000, 2000))) {
+    double a = uniform(30, 120), f = uniform(12, 25);
+    for (int k = 0; k < 300; ++k) {
+      t.pos[i + k] += a * exp(-k / 40.0) * sin(2 * M_PI * f * k / 1000.0);
+    }
+  }
+  return t;
+}
+
+// `count` cw flicks peaking at `peak` counts/s
+Trace flicks(double peak, int count) {
+  Trace t;
+  still(t, 500);
+  for (int n = 0; n < count; ++n) {
+    t.onsets.push_back(int(t.pos.size()));
+    double p = t.pos.back();
+    double ramp = uniform(50, 90), tau = uniform(300, 600);
+    double v = 0;
+    for (int i = 0; v > 300 || i < ramp; ++i) {
+      v = i < ramp ? peak * i / ramp : peak * exp(-(i - ramp) / tau);
+      p += v / 1000;
+      t.pos.push_back(p);
+    }
+    still(t, int(uniform(500, 900)));
+  }
+  return t;
+}
+
+// Sense at 1 kHz (+-30 us release jitter, +-1 count noise), render frames at 60 Hz.
+Run simulate(const Trace& t) {
+  Run r;
+  auto reading = [&](size_t i) {
+    double noisy = t.pos[i] + uniform(-1, 1);
+    return uint16_t(int64_t(llround(noisy)) & (ENCODER_COUNTS - 1));
+  };
+  uint64_t t0 = 1000000;
+  encoder_begin(reading(0), ENCODER_MAGNET_DETECTED, t0);
+  r.counts.push_back(encoder_read().count);
+  double nextFrame = RENDER_FRAME_MS;
+  for (size_t i = 1; i < t.pos.size(); ++i) {
+    uint64_t us = t0 + i * 1000 + uint64_t(uniform(0, 60)) - 30;
+    encoder_sample(reading(i), ENCODER_MAGNET_DETECTED, us);
+    r.counts.push_back(encoder_read().count);
+    if (i >= nextFrame) {
+      r.frameMs.push_back(uint32_t(i));
+      r.frames.push_back(encoder_read());
+      nextFrame += RENDER_FRAME_MS;
+    }
+  }
+  return r;
+}
+
+struct Score {
+  int falseEvents = 0;     // detections outside any flick
+  int detected = 0;        // flicks detected within 1 s of their onset
+  int flicks = 0;
+  std::vector<uint32_t> latencyMs;
+
+  uint32_t latencyPct(int pct) const {
+    if (latencyMs.empty()) return 0;
+    std::vector<uint32_t> l = latencyMs;
+    std::sort(l.begin(), l.end());
+    return l[std::min(l.size() - 1, l.size() * size_t(pct) / 100)];
+  }
+};
+
+// fold detection times into events (cooldown) and match them against the flick onsets
+void score(const Trace& t, const std::vector<uint32_t>& hits, Score& s) {
+  uint32_t lastEvent = 0;
+  bool any = false;
+  std::vector<bool> seen(t.onsets.size(), false);
+  s.flicks += int(t.onsets.size());
+  for (uint32_t ms : hits) {
+    if (any && ms - lastEvent < COOLDOWN_MS) continue;
+    any = true;
+    lastEvent = ms;
+    bool matched = false;
+    for (size_t k = 0; k < t.onsets.size(); ++k) {
+      if (ms >= uint32_t(t.onsets[k]) && ms < uint32_t(t.onsets[k]) + 1000) {
+        if (!seen[k]) {
+          seen[k] = true;
+          ++s.detected;
+          s.latencyMs.push_back(ms - uint32_t(t.onsets[k]));
+        }
+        matched = true;
+      }
+    }
+    if (!matched) ++s.falseEvents;
+  }
+}
+
+// the estimator rule: |velocity| >= v with confidence >= c, read once per render frame
+std::vector<uint32_t> estimatorHits(const Run& r, int32_t v, uint8_t c) {
+  std::vector<uint32_t> hits;
+  for (size_t i = 0; i < r.frames.size(); ++i) {
+    if (abs(r.frames[i].velocity) >= v && r.frames[i].confidence >= c) hits.push_back(r.frameMs[i]);
+  }
+  return hits;
+}
+
+// module_date's own decision
+std::vector<uint32_t> moduleHits(const Run& r) {
+  std::vector<uint32_t> hits;
+  for (size_t i = 0; i < r.frames.size(); ++i) {
+    if (spinSteps(r.frames[i]) != 0) hits.push_back(r.frameMs[i]);
+  }
+  return hits;
+}
+
+// the old rule: |latest - previous pass| >= 120 counts (the velocity floor of 1600 counts/s is
+// implied at these pass lengths), passes every `passMs` +-1 ms
+std::vector<uint32_t> oldRuleHits(const Run& r, double passMs) {
+  std::vector<uint32_t> hits;
+  double next = passMs;
+  size_t last = 0;
+  while (next < r.counts.size()) {
+    size_t i = size_t(next);
+    if (std::llabs(r.counts[i] - r.counts[last]) >= 120) hits.push_back(uint32_t(i));
+    last = i;
+    next += passMs + uniform(-1, 1);
+  }
+  return hits;
+}
+
+struct Corpus {
+  std::vector<Trace> quiet;  // must not trigger
+  std::vector<const char*> quietNames;
+  std::vector<double> speeds;  // counts/s
+  std::vector<Trace> spins;
+  std::vector<Run> quietRuns, spinRuns;
+};
+
+const Corpus& corpus() {
+  static Corpus c;
+  if (!c.quiet.empty()) return c;
+  c.quiet = { browse(300), tremor(120), glitch(120), knock(120) };
+  c.quietNames = { "browse", "tremor", "glitch", "knock" };
+  c.speeds = { 1.5 * 4096, 2 * 4096, 3 * 4096, 5 * 4096 };
+  for (double s : c.speeds) c.spins.push_back(flicks(s, 60));
+  for (const Trace& t : c.quiet) c.quietRuns.push_back(simulate(t));
+  for (const Trace& t : c.spins) c.spinRuns.push_back(simulate(t));
+  return c;
+}
+
+template <typename Hits>
+void report(const char* name, Hits hits, Score* quiet, Score* spins) {
+  const Corpus& c = corpus();
+  printf("  %-18s", name);
+  for (size_t i = 0; i < c.quiet.size(); ++i) {
+    Score s;
+    score(c.quiet[i], hits(c.quietRuns[i]), s);
+    quiet[i] = s;
+    printf(" %6d", s.falseEvents);
+  }
+  printf("  |");
+  for (size_t i = 0; i < c.spins.size(); ++i) {
+    Score s;
+    score(c.spins[i], hits(c.spinRuns[i]), s);
+    spins[i] = s;
+    printf(" %3d%% %3u/%3u", 100 * s.detected / s.flicks, s.latencyPct(50), s.latencyPct(95));
+  }
+  printf("\n");
+}
+
+void header() {
+  printf("  %-18s %6s %6s %6s %6s  | %-12s %-12s %-12s %-12s\n", "false events:", "browse",
+         "tremor", "glitch", "knock", "1.5 rev/s", "2 rev/s", "3 rev/s", "5 rev/s");
+  printf("  %-18s %6s %6s %6s %6s  | %-12s %-12s %-12s %-12s\n", "", "5 min", "2 min", "2 min",
+         "2 min", "hit p50/p95", "ms", "", "");
+}
+
+} // namespace
+
+TEST(spin_rule_against_the_old_heuristic) {
+  header();
+  Score oldQuiet[4], oldSpins[4], newQuiet[4], newSpins[4], tmpQ[4], tmpS[4];
+  report("old, 5 ms pass", [](const Run& r) { return oldRuleHits(r, 5); }, tmpQ, tmpS);
+  report("old, 16.7 ms pass", [](const Run& r) { return oldRuleHits(r, 16.7); }, tmpQ, tmpS);
+  report("old, 27 ms pass", [](const Run& r) { return oldRuleHits(r, 27); }, oldQuiet, oldSpins);
+  report("module_date", moduleHits, newQuiet, newSpins);
+
+  // nothing that isn't a spin triggers it, unlike the old rule
+  int oldFalse = 0;
+  for (int i = 0; i < 4; ++i) {
+    CHECK_EQ(newQuiet[i].falseEvents, 0);
+    oldFalse += oldQuiet[i].falseEvents;
+  }
+  CHECK_GT(oldFalse, 0);
+
+  // every flick from 2 rev/s up is caught within six frames, at most two frames behind the old
+  // rule (whose threshold was ~40% lower at this pass time)
+  for (int i = 1; i < 4; ++i) {
+    CHECK_EQ(newSpins[i].detected, newSpins[i].flicks);
+    CHECK_LE(newSpins[i].latencyPct(95), 6 * RENDER_FRAME_MS);
+    CHECK_LE(newSpins[i].latencyPct(50), oldSpins[i].latencyPct(50) + 2 * RENDER_FRAME_MS);
+  }
+}
+
+TEST(threshold_sweep) {
+  // not a check: the table module_date's constants were picked from
+  header();
+  const int32_t speeds[] = { 4096, 5120, 6144, 7200, 8192 };
+  const uint8_t confidences[] = { 0, 64, 128, 192 };
+  for (int32_t v : speeds) {
+    for (uint8_t c : confidences) {
+      char name[32];
+      snprintf(name, sizeof(name), "v>=%d c>=%u", int(v), unsigned(c));
+      Score q[4], s[4];
+      report(name, [v, c](const Run& r) { return estimatorHits(r, v, c); }, q, s);
+    }
+  }
+}
@@ -0,0 +1,212 @@
+// test_tags.cpp
+// The module registry's tag table (modules.h) and its compile-time perfect hash: every declared
+// tag resolves to its module and album, whatever its UID length; near misses, other lengths and
+// random UIDs resolve to nothing. Then the lookup against the path it replaced (hex String per
+// read, String per table entry, linear scan, and a second equalsIgnoreCase scan for the album).
+#include "check.h"
+
+#include "modules.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+// as main.ino
+const TagEntry* tagLookup(const UidKey& key) {
+  int i = TAG_HASH.find(key);
+  if (i < 0 || TAGS[i].key != key) return nullptr;
+  return &TAGS[i];
+}
+
+namespace {
+
+// resolved at compile time too
+static_assert(TAG_HASH.find(uidKeyFromHex("1D0B1CBB8A0000")) >= 0, "");
+static_assert(TAGS[TAG_HASH.find(uidKeyFromHex("1D0B1CBB8A0000"))].module == MOD_DISTANCE, "");
+
+struct Expected {
+  const char* hex;
+  ModuleId module;
+  const char* album;
+};
+
+// the full profile's tags, as the serial log prints them
+const Expected EXPECTED[] = {
+  { "F16B8949", MOD_FRIEND, nullptr },
+  { "91798949", MOD_FAMILY, nullptr },
+  { "A1778949", MOD_DATE, nullptr },
+  { "C19D8949", MOD_DAYS, nullptr },
+  { "1D0B1CBB8A0000", MOD_DISTANCE, nullptr },
+  { "D19B8949", MOD_COUSINS, nullptr },
+  { "E1998949", MOD_AFAMILY, nullptr },
+  { "81AD8949", MOD_THEMES, nullptr },
+  { "C1A18949", MOD_ALBUM, "at3k2ggmwen1awna" },
+  { "41AF8949", MOD_ALBUM, "at3k2guo8gcj8w5m" },
+};
+const size_t EXPECTED_COUNT = sizeof(EXPECTED) / sizeof(EXPECTED[0]);
+
+Uid uidFromHex(const char* hex) {
+  UidKey k = uidKeyFromHex(hex);
+  uint8_t bytes[UID_MAX_BYTES];
+  for (uint8_t i = 0; i < k.len; ++i) {
+    int shift = 8 * (k.len - 1 - i);
+    bytes[i] = shift >= 64 ? uint8_t(k.hi >> (shift - 64)) : uint8_t(k.lo >> shift);
+  }
+  return uidFromBytes(bytes, k.len);
+}
+
+// ---- the lookup before the registry (main.ino / module_album.cpp) ----
+struct OldEntry {
+  const char* uid;
+  const char* name;
+};
+const OldEntry OLD_MODULES[] = {
+  { "F16B8949", "friend" }, { "91798949", "family" }, { "A1778949", "date" },
+  { "C19D8949", "days" }, { "1D0B1CBB8A0000", "distance" }, { "", "timeline" },
+  { "D19B8949", "cousins" }, { "E1998949", "afamily" }, { "81AD8949", "themes" },
+  { "C1A18949", "album" }, { "41AF8949", "album" }, { nullptr, nullptr },
+};
+const OldEntry OLD_ALBUMS[] = {
+  { "C1A18949", "at3k2ggmwen1awna" },
+  { "41AF8949", "at3k2guo8gcj8w5m" },
+};
+
+String oldUidString(const Uid& uid) {
+  String s = "";
+  for (uint8_t i = 0; i < uid.len; i++) {
+    if (uid.bytes[i] < 0x10) s += "0";
+    s += String(uid.bytes[i], HEX);
+  }
+  s.toUpperCase();
+  return s;
+}
+
+int oldFindModule(const String& uid) {
+  for (int i = 0; OLD_MODULES[i].uid != nullptr; ++i) {
+    if (uid == String(OLD_MODULES[i].uid)) return i;
+  }
+  return -1;
+}
+
+const char* oldAlbumFor(const String& uid) {
+  for (const OldEntry& e : OLD_ALBUMS) {
+    if (uid.equalsIgnoreCase(String(e.uid))) return e.name;
+  }
+  return "at3k2ggmwen1awna";
+}
+
+} // namespace
+
+TEST(every_registered_tag_resolves_to_its_module) {
+  CHECK_EQ(TAGS.size(), EXPECTED_COUNT);
+  for (const Expected& e : EXPECTED) {
+    Uid uid = uidFromHex(e.hex);
+    CHECK_EQ(size_t(uid.len) * 2, strlen(e.hex));
+    const TagEntry* tag = tagLookup(uid.key());
+    CHECK(tag != nullptr);
+    if (!tag) continue;
+    CHECK_EQ(int(tag->module), int(e.module));
+    CHECK(tag->album == e.album || (tag->album && e.album && strcmp(tag->album, e.album) == 0));
+  }
+}
+
+TEST(keys_from_hex_and_from_bytes_agree) {
+  const uint8_t seven[] = { 0x1D, 0x0B, 0x1C, 0xBB, 0x8A, 0x00, 0x00 };
+  CHECK(uidKeyFromBytes(seven, 7) == uidKeyFromHex("1D0B1CBB8A0000"));
+  CHECK(uidKeyFromHex("1d0b1cbb8a0000") == uidKeyFromHex("1D0B1CBB8A0000"));
+
+  const uint8_t ten[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A };
+  UidKey k = uidKeyFromBytes(ten, 10);
+  CHECK(k == uidKeyFromHex("0102030405060708090A"));
+  CHECK_EQ(k.hi, 0x0102);
+  CHECK_EQ(k.lo, 0x030405060708090AULL);
+
+  // malformed hex gives no key at all
+  CHECK_EQ(uidKeyFromHex("1D0B1").len, 0);
+  CHECK_EQ(uidKeyFromHex("1D0G").len, 0);
+  CHECK_EQ(uidKeyFromHex("0102030405060708090A0B").len, 0);
+}
+
+TEST(near_misses_and_other_lengths_resolve_to_nothing) {
+  for (const Expected& e : EXPECTED) {
+    Uid uid = uidFromHex(e.hex);
+
+    // any single flipped bit
+    for (uint8_t i = 0; i < uid.len; ++i) {
+      for (int bit = 0; bit < 8; ++bit) {
+        Uid near = uid;
+        near.bytes[i] ^= uint8_t(1 << bit);
+        CHECK(tagLookup(near.key()) == nullptr);
+      }
+    }
+
+    // the same bytes with leading zeros (a 4-byte tag read as 7) or cut short
+    uint8_t padded[UID_MAX_BYTES] = {};
+    const uint8_t pad = 3;
+    if (uid.len + pad <= UID_MAX_BYTES) {
+      memcpy(padded + pad, uid.bytes, uid.len);
+      CHECK(tagLookup(uidKeyFromBytes(padded, uint8_t(uid.len + pad))) == nullptr);
+    }
+    CHECK(tagLookup(uidKeyFromBytes(uid.bytes, uint8_t(uid.len - 1))) == nullptr);
+  }
+  CHECK(tagLookup(UidKey{ 0, 0, 0 }) == nullptr);
+}
+
+TEST(random_uids_resolve_to_nothing) {
+  std::mt19937 rng(3);
+  const uint8_t lengths[] = { 4, 7, 10 };
+  int hits = 0;
+  for (int i = 0; i < 200000; ++i) {
+    uint8_t bytes[UID_MAX_BYTES];
+    uint8_t len = lengths[i % 3];
+    for (uint8_t b = 0; b < len; ++b) bytes[b] = uint8_t(rng());
+    if (tagLookup(uidKeyFromBytes(bytes, len))) ++hits;
+  }
+  CHECK_EQ(hits, 0);
+}
+
+TEST(benchmark_lookup_against_string_scan) {
+  // every tag plus as many unknown reads, in the order a session might see them
+  std::vector<Uid> reads;
+  for (const Expected& e : EXPECTED) reads.push_back(uidFromHex(e.hex));
+  for (size_t i = 0; i < EXPECTED_COUNT; ++i) {
+    Uid u = reads[i];
+    u.bytes[0] ^= 0x5A;
+    reads.push_back(u);
+  }
+  const int ROUNDS = 20000;
+
+  // both answer the same
+  for (const Uid& u : reads) {
+    const TagEntry* tag = tagLookup(u.key());
+    int old = oldFindModule(oldUidString(u));
+    CHECK_EQ(tag != nullptr, old >= 0);
+    if (tag && tag->module == MOD_ALBUM) CHECK(strcmp(tag->album, oldAlbumFor(oldUidString(u))) == 0);
+  }
+
+  volatile uintptr_t sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; ++r) {
+    for (const Uid& u : reads) {
+      String s = oldUidString(u);
+      int idx = oldFindModule(s);
+      sink = sink + uintptr_t(idx);
+      if (idx >= 0 && strcmp(OLD_MODULES[idx].name, "album") == 0) sink = sink + uintptr_t(oldAlbumFor(s));
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < ROUNDS; ++r) {
+    for (const Uid& u : reads) {
+      const TagEntry* tag = tagLookup(u.key());
+      sink = sink + uintptr_t(tag);
+      if (tag && tag->album) sink = sink + uintptr_t(tag->album);
+    }
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  double lookups = double(ROUNDS) * reads.size();
+  double oldNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / lookups;
+  double newNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / lookups;
+  printf("  per tag read (host): String scan %.0f ns, perfect hash %.1f ns\n", oldNs, newNs);
+  CHECK_LT(newNs * 10, oldNs);
+}
@@ -0,0 +1,218 @@
+// test_tasks.cpp
+// The task graph from tasks.cpp on host threads, with fake net/rfid/encoder sources: the sense
+// rate holds while the net task blocks, tags reach the render loop within a couple of frames,
+// displayFlush() never waits for the bus and publishes go out through the net task.
+#include "check.h"
+
+#include "tasks.h"
+#include "shared.h"
+#include "net.h"
+#include "rfid.h"
+#include "encoder.h"
+#include "encoder_source.h"
+#include "oled.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// ---- sketch globals (main.ino) ----
+const uint16_t SCREEN_W = 128;
+const uint16_t SCREEN_H = 64;
+AS5600 as5600;
+CRGB* leds = nullptr;
+Adafruit_SSD1306 display(SCREEN_W, SCREEN_H, &Wire, -1);
+WiFiClient wifiClient;
+PubSubClient mqttClient(wifiClient);
+
+// ---- fakes ----
+namespace {
+
+std::atomic<uint32_t> netBlockMs{0};  // how long each net_tick() hangs (a blocking connect)
+std::atomic<bool> online{false};
+std::atomic<uint32_t> netTicks{0};
+
+std::atomic<uint32_t> sourceReads{0};
+
+std::mutex rfidLock;
+std::condition_variable rfidCv;
+std::deque<RfidEvent> rfidPending;
+
+uint64_t nowUs() {
+  return uint64_t(esp_timer_get_time());
+}
+
+void injectTag(uint8_t id) {
+  RfidEvent ev = {};
+  ev.type = RFID_TAG_PRESENT;
+  ev.uid.len = 4;
+  ev.uid.bytes[0] = id;
+  {
+    std::lock_guard<std::mutex> g(rfidLock);
+    rfidPending.push_back(ev);
+  }
+  rfidCv.notify_all();
+}
+
+} // namespace
+
+void net_tick(unsigned long) {
+  ++netTicks;
+  if (netBlockMs) std::this_thread::sleep_for(std::chrono::milliseconds(netBlockMs.load()));
+}
+bool net_online() { return online; }
+uint32_t net_session() { return 1; }
+bool net_addSubscription(const char*, uint8_t) { return true; }
+void net_removeSubscription(const char*, uint8_t) {}
+void net_releaseOwner(uint8_t) {}
+
+void rfid_bindCurrentTask() {}
+
+// like the polling fallback: wake at least every 20 ms
+bool rfid_waitEvent(RfidEvent& ev) {
+  std::unique_lock<std::mutex> lock(rfidLock);
+  rfidCv.wait_for(lock, std::chrono::milliseconds(20), [] { return !rfidPending.empty(); });
+  if (rfidPending.empty()) return false;
+  ev = rfidPending.front();
+  rfidPending.pop_front();
+  return true;
+}
+
+// a wheel turning slowly: 3 counts per read
+bool encoder_sourceRead(uint16_t& raw, uint8_t& status) {
+  uint32_t n = sourceReads++;
+  raw = uint16_t((n * 3) & (ENCODER_COUNTS - 1));
+  status = ENCODER_MAGNET_DETECTED;
+  return true;
+}
+
+namespace {
+
+void startOnce() {
+  static bool started = false;
+  if (started) return;
+  started = true;
+  oled_begin(display, Wire, 0x3D);
+  tasks_init();
+  tasks_start(true);
+  // let the sense timer settle
+  for (int i = 0; i < 6; ++i) tasks_endFrame();
+}
+
+} // namespace
+
+TEST(sense_keeps_its_rate_while_net_blocks) {
+  startOnce();
+  netBlockMs = 300;
+  uint32_t ticksBefore = netTicks;
+  uint32_t samplesBefore = encoder_read().samples;
+  uint64_t t0 = nowUs();
+  for (int i = 0; i < 60; ++i) tasks_endFrame();
+  uint64_t elapsedMs = (nowUs() - t0) / 1000;
+  uint32_t samples = encoder_read().samples - samplesBefore;
+
+  // 60 frames at 60 Hz, and ~1000 samples in that second although net_tick() hangs
+  CHECK_GE(elapsedMs, 950u);
+  CHECK_LE(elapsedMs, 1150u);
+  CHECK_GE(samples * 1000 / elapsedMs, 900u);
+  CHECK_LE(samples * 1000 / elapsedMs, 1050u);
+  CHECK_GE(netTicks - ticksBefore, 2u);
+  netBlockMs = 0;
+}
+
+TEST(tags_reach_the_render_loop_within_two_frames) {
+  startOnce();
+  netBlockMs = 300;
+  RfidEvent ev;
+  while (tasks_nextTag(ev)) {}
+
+  uint64_t worstUs = 0;
+  for (uint8_t id = 1; id <= 8; ++id) {
+    uint64_t injected = nowUs();
+    injectTag(id);
+    bool got = false;
+    for (int frame = 0; frame < 30 && !got; ++frame) {
+      tasks_endFrame();
+      got = tasks_nextTag(ev);
+    }
+    CHECK(got);
+    if (!got) break;
+    CHECK_EQ(ev.uid.bytes[0], id);
+    worstUs = std::max(worstUs, nowUs() - injected);
+    for (int frame = 0; frame < 3; ++frame) tasks_endFrame();
+  }
+  CHECK_LE(worstUs, 2 * 16667u + 5000u);
+  netBlockMs = 0;
+}
+
+TEST(display_flush_hands_over_without_waiting_for_the_bus) {
+  const uint32_t LONG_GAP_US = 12000;
+  startOnce();
+  // ~400 kHz: a full 1 KB frame takes ~27 ms, longer than a render frame
+  Wire.byteTimeUs = 25;
+  DisplayStats before = tasks_displayStats();
+  uint32_t cursor = encoder_cursor();
+  EncoderSample ring[ENCODER_RING];
+  uint32_t lastUs = 0;
+  uint32_t worstGapUs = 0;
+  uint32_t longGaps = 0;  // a sample lost to more than a page of flushing
+  uint64_t worstCallUs = 0;
+
+  for (int frame = 0; frame < 60; ++frame) {
+    // every frame changes every byte, so every flush is a full one
+    memset(display.getBuffer(), (frame & 1) ? 0xAA : 0x55, display.bufferBytes());
+    uint64_t t = nowUs();
+    displayFlush();
+    worstCallUs = std::max(worstCallUs, nowUs() - t);
+    tasks_endFrame();
+
+    size_t n = encoder_samples(cursor, ring, ENCODER_RING);
+    for (size_t i = 0; i < n; ++i) {
+      if (lastUs) {
+        worstGapUs = std::max(worstGapUs, ring[i].us - lastUs);
+        if (ring[i].us - lastUs > LONG_GAP_US) ++longGaps;
+      }
+      lastUs = ring[i].us;
+    }
+  }
+  for (int frame = 0; frame < 6; ++frame) tasks_endFrame();  // drain the last frame
+  Wire.byteTimeUs = 0;
+
+  DisplayStats after = tasks_displayStats();
+  uint32_t presented = after.presented - before.presented;
+  uint32_t flushed = after.flushed - before.flushed;
+  uint32_t dropped = after.dropped - before.dropped;
+  CHECK_EQ(presented, 60u);
+  CHECK_EQ(flushed + dropped, presented);
+  CHECK_GT(dropped, 0u);  // the bus can't keep up: latest frame wins
+  CHECK_LE(worstCallUs, 2000u);
+  // the flush takes the bus per page (~3.5 ms here) and lets a waiting sample in between, so
+  // the sampler loses about a page, not the whole ~27 ms frame. Holding the bus for a frame
+  // made a long gap on every flush; on a loaded single-core host a thread is still preempted
+  // now and then, so a couple are allowed for.
+  printf("  sample gaps: worst %u us, %u over %u us in %u flushes\n", unsigned(worstGapUs),
+         unsigned(longGaps), unsigned(LONG_GAP_US), unsigned(flushed));
+  CHECK_LE(longGaps, 2u);
+}
+
+TEST(publishes_go_out_through_the_net_task) {
+  startOnce();
+  mqttClient.isConnected = true;
+  online = true;
+  size_t before = mqttClient.published.size();
+  CHECK(publishJson("spinner/test", "{\"n\":1}"));
+  CHECK(publishJson("spinner/test", "{\"n\":2}"));
+  CHECK(publishJson("spinner/test", "{\"n\":3}"));
+  for (int frame = 0; frame < 12; ++frame) tasks_endFrame();
+  CHECK_EQ(mqttClient.published.size(), before + 3);
+  if (mqttClient.published.size() == before + 3) {
+    CHECK(mqttClient.published[before].second == "{\"n\":1}");
+    CHECK(mqttClient.published[before + 2].second == "{\"n\":3}");
+  }
+
+  online = false;
+  CHECK(!publishJson("spinner/test", "{\"n\":4}"));
+}
@@ -0,0 +1,169 @@
+// test_uid_alloc.cpp
+// The tag path must not touch the heap once running: rfid_waitEvent() reading cards off the
+// (simulated) RC522, and what loop() does with each event - debounce, same-tag check, lookup,
+// log line, switching the active tag. A global operator new counts allocations while a tag
+// session of 4-, 7- and 10-byte tags coming and going is replayed. The String-based path the
+// Uid replaced is counted the same way, to show the hook sees what it should.
+#include "check.h"
+
+#include "modules.h"
+#include "rfid.h"
+
+#include <MFRC522.h>
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+#define LOGGER_TAG "test"
+#define LOGGER_LEVEL LOG_LEVEL_INFO
+#include "logger.h"
+
+namespace {
+std::atomic<bool> counting{false};
+std::atomic<uint32_t> allocations{0};
+}
+
+void* operator new(size_t n) {
+  if (counting) ++allocations;
+  void* p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+MFRC522 mfrc522;
+
+// as main.ino
+const TagEntry* tagLookup(const UidKey& key) {
+  int i = TAG_HASH.find(key);
+  if (i < 0 || TAGS[i].key != key) return nullptr;
+  return &TAGS[i];
+}
+
+namespace {
+
+// events cross from the rfid task to loop() through a FreeRTOS queue: a copy into storage
+// allocated once by xQueueCreate()
+static_assert(std::is_trivially_copyable<RfidEvent>::value, "RfidEvent must copy as plain bytes");
+
+const bool DEACTIVATE_ON_TAG_REMOVED = false;
+const unsigned long TAG_DEBOUNCE_MS = 600;
+const UidKey CALIBRATION_TAG = uidKeyFromHex("0A0B0C0D");
+
+Uid currentActiveUid = {};
+unsigned long lastTagProcessedMs = 0;
+int switches = 0;
+
+// handleTagEvents() in main.ino for one event, with module activation reduced to the tag switch
+void handleTag(const RfidEvent& tag) {
+  const Uid& uid = tag.uid;
+  char hex[UID_HEX_LEN];
+  if (tag.type == RFID_TAG_REMOVED) {
+    LOGI("Card removed: %s", uidFormat(uid, hex, sizeof(hex)));
+    if (DEACTIVATE_ON_TAG_REMOVED && uid == currentActiveUid) currentActiveUid.clear();
+    return;
+  }
+  unsigned long now = millis();
+  if (now - lastTagProcessedMs < TAG_DEBOUNCE_MS) return;
+  lastTagProcessedMs = now;
+  LOGI("Card UID: %s", uidFormat(uid, hex, sizeof(hex)));
+  if (uid.key() == CALIBRATION_TAG) return;
+  if (!currentActiveUid.empty() && uid == currentActiveUid) return;
+  const TagEntry* entry = tagLookup(uid.key());
+  if (entry) {
+    currentActiveUid = uid;
+    ++switches;
+  } else {
+    currentActiveUid.clear();
+  }
+}
+
+void putCard(const char* hex) {
+  UidKey k = uidKeyFromHex(hex);
+  mfrc522.card.size = k.len;
+  for (uint8_t i = 0; i < k.len; ++i) {
+    int shift = 8 * (k.len - 1 - i);
+    mfrc522.card.uidByte[i] = shift >= 64 ? uint8_t(k.hi >> (shift - 64)) : uint8_t(k.lo >> shift);
+  }
+  mfrc522.cardPresent = true;
+}
+
+// run the rfid side for `checks` waits, handing every event to loop()'s handler
+int pump(int checks) {
+  int events = 0;
+  RfidEvent ev;
+  for (int i = 0; i < checks; ++i) {
+    if (rfid_waitEvent(ev)) {
+      handleTag(ev);
+      ++events;
+    }
+  }
+  return events;
+}
+
+// a session: distance (7 bytes), an album, an unknown 10-byte card, friend, the same friend
+void session() {
+  const char* cards[] = { "1D0B1CBB8A0000", "C1A18949", "0102030405060708090A", "F16B8949", "F16B8949" };
+  for (const char* c : cards) {
+    putCard(c);
+    pump(8);
+    mfrc522.cardPresent = false;
+    pump(6);
+  }
+}
+
+// ---- the path before Uid (main.ino tryReadRfidUid() / findModuleIndexByUid()) ----
+String oldActiveUid;
+
+void oldRead() {
+  String uidStr = "";
+  for (byte i = 0; i < mfrc522.uid.size; i++) {
+    if (mfrc522.uid.uidByte[i] < 0x10) uidStr += "0";
+    uidStr += String(mfrc522.uid.uidByte[i], HEX);
+  }
+  uidStr.toUpperCase();
+  if (uidStr == oldActiveUid) return;
+  const char* table[] = { "F16B8949", "91798949", "1D0B1CBB8A0000", "C1A18949" };
+  for (const char* t : table) {
+    if (uidStr == String(t)) {
+      oldActiveUid = uidStr;
+      return;
+    }
+  }
+}
+
+} // namespace
+
+TEST(tag_session_allocates_nothing) {
+  shim_clockManual(true);  // the rfid waits cost no real time
+  rfid_begin(-1);
+  rfid_bindCurrentTask();
+  session();  // warm-up: anything lazily set up happens here
+
+  switches = 0;
+  allocations = 0;
+  counting = true;
+  for (int i = 0; i < 50; ++i) session();
+  counting = false;
+  shim_clockManual(false);
+
+  CHECK_EQ(switches, 50 * 3);  // distance, album, friend (the second friend read is the same tag)
+  CHECK_EQ(allocations.load(), 0u);
+}
+
+TEST(the_hook_sees_the_string_path_allocate) {
+  // the host String keeps up to 15 characters inline: a 10-byte UID is what reaches the heap here
+  putCard("0102030405060708090A");
+  mfrc522.PICC_ReadCardSerial();
+  oldActiveUid = "";
+  allocations = 0;
+  counting = true;
+  oldRead();
+  counting = false;
+  printf("  String path: %u allocations for one 10-byte read\n", unsigned(allocations.load()));
+  CHECK_GT(allocations.load(), 0u);
+}